@@ -0,0 +1,60 @@
+//
+// Example PinWorld plugin
+// build it with the PinWorld project, or by hand:
+//     cc -O2 -shared -fPIC -I../src ripple.c -o ripple.so
+// PinWorld reloads ripple.so when it is rebuilt.
+//
+#include "PinWorldPlugin.h"
+
+#include <math.h>
+#include <stdlib.h>
+
+typedef struct RippleState {
+    float wavelength;
+    float speed;
+} RippleState;
+
+static void* rippleCreate(void) {
+    RippleState* state = (RippleState*)malloc(sizeof(RippleState));
+    state->wavelength = 0.15f;
+    state->speed = 2.0f;
+    return state;
+}
+
+static void rippleDestroy(void* state) {
+    free(state);
+}
+
+static float rippleValue(const RippleState* state, const PinWorldFrame* frame, float x, float y) {
+    // normalized with correct aspect [-x, -1.0] -> [+x, 1.0]
+    float nx = (x - frame->half_size_x) / frame->half_size_y;
+    float ny = (y - frame->half_size_y) / frame->half_size_y;
+    float distance = sqrtf(nx * nx + ny * ny);
+
+    float wave = sinf(distance / state->wavelength - frame->time * state->speed);
+    float fade = 1.0f / (1.0f + distance * 2.0f);
+    return wave * fade * 0.5f + 0.5f;
+}
+
+static float rippleShade(void* state, const PinWorldFrame* frame, int pin_index, float pin_x, float pin_y, float pin_value) {
+    return rippleValue((const RippleState*)state, frame, pin_x, pin_y);
+}
+
+static void rippleShadeRow(void* state, const PinWorldFrame* frame, int y, int x_begin, int x_end, float* row) {
+    for (int x = x_begin; x != x_end; ++x)
+        row[x] = rippleValue((const RippleState*)state, frame, (float)x, (float)y);
+}
+
+static const PinWorldShader shaders[] = {
+    { "Ripple", rippleCreate, rippleDestroy, rippleShade, rippleShadeRow },
+};
+
+static const PinWorldPlugin plugin = {
+    PINWORLD_PLUGIN_VERSION,
+    sizeof(shaders) / sizeof(shaders[0]),
+    shaders
+};
+
+PINWORLD_PLUGIN_EXPORT const PinWorldPlugin* pinworld_plugin(void) {
+    return &plugin;
+}
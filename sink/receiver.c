@@ -0,0 +1,120 @@
+//
+// Loopback receiver for the PinWorld UDP sink
+// build it with the PinWorld project, or by hand:
+//     cc -O2 -I../src receiver.c -o receiver
+// then run PinWorld with --sink 127.0.0.1:7777
+//
+//     receiver [port] [frames]
+//
+// Rebuilds the frames from the datagrams, prints the frames, the lost datagrams and a small preview once per second.
+// Stops after the given number of frames, or runs until it is stopped.
+//
+#include "PinWorldSink.h"
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#define MAX_PINS (4096 * 4096)
+
+static void preview(const uint8_t* pins, int width, int height) {
+    static const char shades[] = " .:-=+*#%@";
+    int step_x = width > 64 ? width / 64 : 1;
+    int step_y = step_x * 2;
+
+    for (int y = 0; y < height; y += step_y) {
+        for (int x = 0; x < width; x += step_x)
+            putchar(shades[pins[y * width + x] * 9 / 255]);
+        putchar('\n');
+    }
+}
+
+int main(int argc, char** argv) {
+    int port = argc > 1 ? atoi(argv[1]) : PINWORLD_SINK_DEFAULT_PORT;
+    long frames_wanted = argc > 2 ? atol(argv[2]) : 0;
+
+    int receiver = socket(AF_INET, SOCK_DGRAM, 0);
+    struct sockaddr_in address;
+    memset(&address, 0, sizeof(address));
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_ANY);
+    address.sin_port = htons((uint16_t)port);
+    if (receiver < 0 || bind(receiver, (struct sockaddr*)&address, sizeof(address)) != 0) {
+        fprintf(stderr, "unable to listen on port %d\n", port);
+        return 1;
+    }
+
+    int buffer_size = 1 << 20;
+    setsockopt(receiver, SOL_SOCKET, SO_RCVBUF, &buffer_size, sizeof(buffer_size));
+    printf("listening on port %d\n", port);
+
+    uint8_t* pins = (uint8_t*)calloc(MAX_PINS, 1);
+    uint8_t datagram[PINWORLD_SINK_MAX_DATAGRAM];
+    long frames = 0, keyframes = 0, lost = 0, bad = 0;
+    int width = 0, height = 0;
+    int synced = 0;                 // a keyframe arrived since the last loss
+    int have_packet = 0;
+    uint32_t next_packet = 0;
+    uint32_t last_frame = 0;
+
+    while (frames_wanted == 0 || frames < frames_wanted) {
+        ssize_t size = recv(receiver, datagram, sizeof(datagram), 0);
+        if (size < 0)
+            break;
+
+        PinWorldSinkPacket packet;
+        if (size < (ssize_t)sizeof(packet)) {
+            bad++;
+            continue;
+        }
+        memcpy(&packet, datagram, sizeof(packet));
+        if (packet.magic != PINWORLD_SINK_MAGIC || packet.version != PINWORLD_SINK_VERSION || packet.format != PINWORLD_SINK_UINT8
+            || (size_t)packet.width * packet.height > MAX_PINS || packet.row_begin + packet.row_count > packet.height
+            || (size_t)size != sizeof(packet) + (size_t)packet.row_count * packet.width) {
+            bad++;
+            continue;
+        }
+
+        // the rows of a lost datagram stay stale until the next keyframe
+        if (have_packet && packet.packet != next_packet) {
+            lost += (long)(uint32_t)(packet.packet - next_packet);
+            synced = 0;
+        }
+        have_packet = 1;
+        next_packet = packet.packet + 1;
+
+        if (packet.flags & PINWORLD_SINK_KEYFRAME) {
+            if (packet.width != width || packet.height != height)
+                memset(pins, 0, (size_t)packet.width * packet.height);
+            width = packet.width;
+            height = packet.height;
+            synced = 1;
+        }
+
+        if (packet.width == width && packet.height == height)
+            memcpy(pins + (size_t)packet.row_begin * width, datagram + sizeof(packet), (size_t)packet.row_count * width);
+
+        if (!(packet.flags & PINWORLD_SINK_END_OF_FRAME))
+            continue;
+
+        frames++;
+        if (packet.flags & PINWORLD_SINK_KEYFRAME)
+            keyframes++;
+
+        // about once per second at 60 fps
+        if (packet.frame / 60 != last_frame / 60 || frames == 1 || frames == frames_wanted) {
+            printf("frame %u %dx%d, %ld frames, %ld keyframes, %ld datagrams lost, %ld invalid%s\n",
+                packet.frame, width, height, frames, keyframes, lost, bad, synced ? "" : ", waiting for a keyframe");
+            preview(pins, width, height);
+        }
+        last_frame = packet.frame;
+    }
+
+    free(pins);
+    close(receiver);
+    return 0;
+}
@@ -0,0 +1,165 @@
+#include "AdaptiveResolution.hpp"
+#include "Text.hpp"
+
+#include "raylib.h"
+
+namespace pw {
+
+    // a finer scale is only picked when it is predicted to fit well below the budget, so the scale doesn't flip every frame
+    constexpr float RefineBudgetFactor = 0.6f;
+
+    // frames before a scale is refined after a change, the cost needs a few frames to settle. coarsening never waits
+    constexpr int HoldFrames = 30;
+
+    // weight of a new measure in the running cost
+    constexpr float CostSmoothing = 0.1f;
+
+    AdaptiveResolution::AdaptiveResolution()
+        :m_enabled(true), m_dirty(false)
+    { }
+
+    void AdaptiveResolution::setEnabled(bool enabled) {
+        m_enabled = enabled;
+    }
+
+    bool AdaptiveResolution::enabled() const {
+        return m_enabled;
+    }
+
+    void AdaptiveResolution::load(std::string const& filepath) {
+        m_filepath = filepath;
+
+        std::string text;
+        if (!readRawText(filepath, text))
+            return;
+
+        // one "<ns per pin>\t<shader name>" per line
+        for (auto line : split(text, "\n")) {
+            trim(line);
+            auto tab = line.find('\t');
+            if (tab == std::string::npos)
+                continue;
+
+            ShaderCost cost;
+            cost.ns_per_pin = lexical_cast<float>(line.substr(0, tab), 0.0f);
+            cost.samples = 1;
+
+            if (cost.ns_per_pin > 0.0f)
+                m_costs[line.substr(tab + 1)] = cost;
+        }
+
+        TraceLog(LOG_DEBUG, "Resolution > %d shader costs loaded", int(m_costs.size()));
+    }
+
+    bool AdaptiveResolution::save() {
+        if (!m_dirty || m_filepath.empty())
+            return true;
+
+        std::string text;
+        for (auto const& [shader, cost] : m_costs)
+            text += sfmt("%.3f\t%s\n", cost.ns_per_pin, shader);
+
+        if (!writeRawText(m_filepath, text)) {
+            TraceLog(LOG_WARNING, "Resolution > unable to write %s", m_filepath.c_str());
+            return false;
+        }
+
+        m_dirty = false;
+        return true;
+    }
+
+    float AdaptiveResolution::predictedMs(float ns_per_pin, int pins, int scale) const {
+        return ns_per_pin * float(pins) / float(scale * scale) / 1000000.0f;
+    }
+
+    int AdaptiveResolution::fittingScale(float ns_per_pin, int pins, float budget_ms) const {
+        int scale = 1;
+        while (scale < MaxScale && predictedMs(ns_per_pin, pins, scale) > budget_ms)
+            scale *= 2;
+        return scale;
+    }
+
+    int AdaptiveResolution::scale(Decision& decision, std::string const& shader, int pins, float budget_ms) {
+        // turning it on again starts over like a new shader
+        if (!m_enabled) {
+            decision = Decision();
+            return 1;
+        }
+
+        float ns_per_pin = cost(shader);
+
+        // a new shader starts at the scale its known cost fits in, unknown ones are measured at full resolution
+        if (shader != decision.shader) {
+            decision.shader = shader;
+            decision.scale = (ns_per_pin > 0.0f) ? fittingScale(ns_per_pin, pins, budget_ms) : 1;
+            decision.hold = HoldFrames;
+            return decision.scale;
+        }
+
+        // an overrun goes straight to the scale the cost fits in, the first measure of a new shader included
+        if (predictedMs(ns_per_pin, pins, decision.scale) > budget_ms) {
+            int fitting = fittingScale(ns_per_pin, pins, budget_ms);
+            if (fitting > decision.scale) {
+                decision.scale = fitting;
+                decision.hold = HoldFrames;
+            }
+            return decision.scale;
+        }
+
+        if (decision.hold > 0) {
+            --decision.hold;
+            return decision.scale;
+        }
+
+        if (decision.scale > 1 && predictedMs(ns_per_pin, pins, decision.scale / 2) < budget_ms * RefineBudgetFactor) {
+            decision.scale /= 2;
+            decision.hold = HoldFrames;
+        }
+
+        return decision.scale;
+    }
+
+    void AdaptiveResolution::record(std::string const& shader, int pins, int64_t microseconds) {
+        if (pins <= 0)
+            return;
+
+        float ns_per_pin = float(microseconds) * 1000.0f / float(pins);
+
+        ShaderCost& cost = m_costs[shader];
+        cost.ns_per_pin = (cost.samples == 0) ? ns_per_pin : cost.ns_per_pin + (ns_per_pin - cost.ns_per_pin) * CostSmoothing;
+        cost.samples++;
+        m_dirty = true;
+    }
+
+    float AdaptiveResolution::cost(std::string const& shader) const {
+        auto found = m_costs.find(shader);
+        return (found == m_costs.end()) ? 0.0f : found->second.ns_per_pin;
+    }
+
+    void resizePins(float const* src, int src_width, int src_height, float* dst, int dst_width, int dst_height) {
+        float const step_x = float(src_width) / float(dst_width);
+        float const step_y = float(src_height) / float(dst_height);
+
+        for (int y = 0; y != dst_height; ++y) {
+            float sy = clampTo((y + 0.5f) * step_y - 0.5f, 0.0f, float(src_height - 1));
+            int y0 = int(sy);
+            int y1 = minimum(y0 + 1, src_height - 1);
+            float fy = sy - float(y0);
+
+            float const* row0 = src + y0 * src_width;
+            float const* row1 = src + y1 * src_width;
+            float* out = dst + y * dst_width;
+
+            for (int x = 0; x != dst_width; ++x) {
+                float sx = clampTo((x + 0.5f) * step_x - 0.5f, 0.0f, float(src_width - 1));
+                int x0 = int(sx);
+                int x1 = minimum(x0 + 1, src_width - 1);
+                float fx = sx - float(x0);
+
+                float top = row0[x0] + (row0[x1] - row0[x0]) * fx;
+                float bottom = row1[x0] + (row1[x1] - row1[x0]) * fx;
+                out[x] = top + (bottom - top) * fy;
+            }
+        }
+    }
+}
@@ -0,0 +1,61 @@
+#pragma once
+
+#include "Lang.hpp"
+
+namespace pw {
+
+    //
+    // Picks the resolution the active shader is evaluated at from its measured cost per pin.
+    // The canvas is divided by scale() for the shader and the result is upsampled to every pin.
+    // Costs are kept per shader and saved, so a known expensive shader starts at the right scale.
+    //
+    class AdaptiveResolution {
+    public:
+        static constexpr int MaxScale = 4;
+
+        // part of a 60 Hz frame the shaders may take, the canvases split it
+        static constexpr float FrameBudgetMs = 8.0f;
+
+        // the scale picked for one canvas, the costs are shared by every canvas
+        struct Decision {
+            std::string shader;     // shader of the last decision
+            int scale = 1;
+            int hold = 0;           // frames left before the scale may be refined again
+        };
+
+        AdaptiveResolution();
+
+        void setEnabled(bool enabled);
+        bool enabled() const;
+
+        // costs measured in earlier sessions, a missing file is not an error
+        void load(std::string const& filepath);
+        bool save();
+
+        // scale for this frame of the shader on a canvas of pins that has budget_ms to evaluate, 1, 2 or 4. call once per frame
+        int scale(Decision& decision, std::string const& shader, int pins, float budget_ms = FrameBudgetMs);
+
+        // the shader took microseconds to evaluate pins
+        void record(std::string const& shader, int pins, int64_t microseconds);
+
+        // ns per pin, 0 when the shader was never measured
+        float cost(std::string const& shader) const;
+    private:
+        struct ShaderCost {
+            float ns_per_pin = 0.0f;
+            int samples = 0;
+        };
+
+        std::map<std::string, ShaderCost> m_costs;
+        std::string m_filepath;
+        bool m_enabled;
+        bool m_dirty;
+
+        float predictedMs(float ns_per_pin, int pins, int scale) const;
+        int fittingScale(float ns_per_pin, int pins, float budget_ms) const;
+    };
+
+    // bilinear resize of a pin field, pins are sampled at their centers and the edges are clamped.
+    // upsamples the shader output, and downsamples the pins a shader starts from when its scale changes
+    void resizePins(float const* src, int src_width, int src_height, float* dst, int dst_width, int dst_height);
+}
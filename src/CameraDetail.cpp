@@ -0,0 +1,131 @@
+#include "CameraDetail.hpp"
+
+#include "rlgl.h"
+#include "raymath.h"
+
+namespace pw {
+
+    Vector4 transformPoint(Matrix const& m, float x, float y, float z) {
+        return {
+            m.m0 * x + m.m4 * y + m.m8 * z + m.m12,
+            m.m1 * x + m.m5 * y + m.m9 * z + m.m13,
+            m.m2 * x + m.m6 * y + m.m10 * z + m.m14,
+            m.m3 * x + m.m7 * y + m.m11 * z + m.m15
+        };
+    }
+
+    // true when every corner is on the outer side of the same clip plane
+    static bool outsideFrustum(Vector4 const* corners, int count) {
+        auto outside = [corners, count](auto const& test) {
+            for (int i = 0; i != count; ++i)
+                if (!test(corners[i]))
+                    return false;
+            return true;
+        };
+
+        return outside([](Vector4 const& c) { return c.x < -c.w; }) ||
+            outside([](Vector4 const& c) { return c.x > c.w; }) ||
+            outside([](Vector4 const& c) { return c.y < -c.w; }) ||
+            outside([](Vector4 const& c) { return c.y > c.w; }) ||
+            outside([](Vector4 const& c) { return c.z < -c.w; }) ||
+            outside([](Vector4 const& c) { return c.z > c.w; });
+    }
+
+    Matrix cameraViewProjection(Camera3D const& camera, float screen_width, float screen_height) {
+        Matrix view = GetCameraMatrix(camera);
+        Matrix projection = MatrixPerspective(camera.fovy * DEG2RAD, screen_width / screen_height, RL_CULL_DISTANCE_NEAR, RL_CULL_DISTANCE_FAR);
+        return MatrixMultiply(view, projection);
+    }
+
+    bool boxOutsideFrustum(Matrix const& view_projection, Vector3 const& min, Vector3 const& max) {
+        Vector4 corners[8];
+        for (int i = 0; i != 8; ++i)
+            corners[i] = transformPoint(view_projection, (i & 1) ? max.x : min.x, (i & 2) ? max.y : min.y, (i & 4) ? max.z : min.z);
+        return outsideFrustum(corners, 8);
+    }
+
+    CameraDetail::CameraDetail()
+        :m_enabled(true), m_frame(0), m_reduced(0)
+    { }
+
+    void CameraDetail::setEnabled(bool enabled) {
+        m_enabled = enabled;
+    }
+
+    bool CameraDetail::enabled() const {
+        return m_enabled;
+    }
+
+    void CameraDetail::update(Camera3D const& camera, float screen_width, float screen_height, CanvasLayout const& layout) {
+        int const tiles_x = (layout.width + layout.tile_width - 1) / layout.tile_width;
+        int const tiles_y = (layout.height + layout.tile_height - 1) / layout.tile_height;
+        m_row_steps.assign(size_t(tiles_x) * tiles_y, 1);
+        m_reduced = 0;
+        ++m_frame;
+
+        if (screen_width <= 0.0f || screen_height <= 0.0f)
+            return;
+
+        Matrix view_projection = cameraViewProjection(camera, screen_width, screen_height);
+
+        float const s = layout.pin_size;
+        float const x_start = layout.width * s / 2.0f - s / 2.0f;
+        float const z_start = layout.height * s / 2.0f - s / 2.0f;
+
+        for (int tile = 0; tile != int(m_row_steps.size()); ++tile) {
+            int x_begin = (tile % tiles_x) * layout.tile_width;
+            int x_end = minimum(x_begin + layout.tile_width, layout.width);
+            int y_begin = (tile / tiles_x) * layout.tile_height;
+            int y_end = minimum(y_begin + layout.tile_height, layout.height);
+
+            float x0 = x_begin * s - x_start - s / 2.0f;
+            float x1 = (x_end - 1) * s - x_start + s / 2.0f;
+            float z0 = y_begin * s - z_start - s / 2.0f;
+            float z1 = (y_end - 1) * s - z_start + s / 2.0f;
+
+            // hidden tiles take turns, a few of them are refreshed at the coarsest step on every frame
+            if (boxOutsideFrustum(view_projection, { x0, layout.min_y, z0 }, { x1, layout.max_y, z1 })) {
+                m_row_steps[tile] = ((m_frame + tile) % HiddenFrames == 0) ? MaxRowStep : 0;
+                ++m_reduced;
+                continue;
+            }
+
+            int rows = y_end - y_begin;
+            if (rows < 2)
+                continue;
+
+            // screen distance between the first and last row, through the middle of the tile
+            float xm = (x0 + x1) / 2.0f;
+            Vector4 first = transformPoint(view_projection, xm, 0.0f, y_begin * s - z_start);
+            Vector4 last = transformPoint(view_projection, xm, 0.0f, (y_end - 1) * s - z_start);
+
+            // rows close to or behind the camera stay at full detail
+            if (first.w <= RL_CULL_DISTANCE_NEAR || last.w <= RL_CULL_DISTANCE_NEAR)
+                continue;
+
+            float dx = (last.x / last.w - first.x / first.w) * 0.5f * screen_width;
+            float dy = (last.y / last.w - first.y / first.w) * 0.5f * screen_height;
+            float pixels_per_row = sqrtf(dx * dx + dy * dy) / float(rows - 1);
+
+            // evaluated rows stay about a pixel apart
+            int step = 1;
+            while (step < MaxRowStep && pixels_per_row * float(step * 2) <= 1.0f)
+                step *= 2;
+
+            m_row_steps[tile] = uint8_t(step);
+            if (step > 1)
+                ++m_reduced;
+        }
+    }
+
+    int CameraDetail::rowStep(int tile) const {
+        if (tile < 0 || tile >= int(m_row_steps.size()))
+            return 1;
+        return m_row_steps[tile];
+    }
+
+    int CameraDetail::reducedTiles() const {
+        return m_reduced;
+    }
+
+}
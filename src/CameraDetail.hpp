@@ -0,0 +1,60 @@
+#pragma once
+
+#include "Lang.hpp"
+
+#include "raylib.h"
+
+namespace pw {
+
+    // how the canvas is laid out in the world, like the pin material draws it
+    struct CanvasLayout {
+        int width = 0;              // pins
+        int height = 0;
+        int tile_width = 0;
+        int tile_height = 0;
+        float pin_size = 0.0f;      // world distance between pin centers
+        float min_y = 0.0f;         // world height range a pin can cover
+        float max_y = 0.0f;
+        float travel = 0.0f;        // world height a pin rises at 1.0
+    };
+
+    // the view and projection BeginMode3D sets up for the camera
+    Matrix cameraViewProjection(Camera3D const& camera, float screen_width, float screen_height);
+
+    // true when the world box is entirely outside the frustum
+    bool boxOutsideFrustum(Matrix const& view_projection, Vector3 const& min, Vector3 const& max);
+
+    // clip space position of a world point
+    Vector4 transformPoint(Matrix const& m, float x, float y, float z);
+
+    //
+    // Picks how often the rows of each canvas tile are evaluated from their projected size.
+    // Rows that are less than a pixel apart on screen are evaluated every 2 or 4 rows and the rows in between are interpolated,
+    // tiles outside the frustum keep their pins and are only refreshed every few frames.
+    //
+    class CameraDetail {
+    public:
+        static constexpr int MaxRowStep = 4;
+        static constexpr int HiddenFrames = 8;     // frames between the updates of a tile outside the frustum
+
+        CameraDetail();
+
+        void setEnabled(bool enabled);
+        bool enabled() const;
+
+        // estimates every tile rate for the frame, call once per frame
+        void update(Camera3D const& camera, float screen_width, float screen_height, CanvasLayout const& layout);
+
+        // evaluated rows step of the tile for this frame, 0 when the tile keeps its pins
+        int rowStep(int tile) const;
+
+        // tiles below full detail on the last update
+        int reducedTiles() const;
+    private:
+        bool m_enabled;
+        int m_frame;
+        int m_reduced;
+        std::vector<uint8_t> m_row_steps;
+    };
+
+}
@@ -0,0 +1,152 @@
+#include "FileWatcher.hpp"
+#include "Trace.hpp"
+
+#if defined(__linux__)
+	#include <sys/inotify.h>
+	#include <poll.h>
+	#include <unistd.h>
+#endif
+
+namespace pw {
+
+    // events are delivered once nothing changed for this long, editors often write a file in several steps
+    constexpr int64_t SettleTime = 150;
+
+    // how often the folders are scanned when there is no native notification
+    constexpr int64_t PollInterval = 500;
+
+    FileWatcher::FileWatcher()
+        :m_running(false)
+    { }
+
+    FileWatcher::~FileWatcher() {
+        stop();
+    }
+
+    void FileWatcher::start(std::vector<std::string> const& folders, Callback callback) {
+        stop();
+
+#if defined(__EMSCRIPTEN__)
+        // no threads on the web build
+        return;
+#endif
+
+        m_folders = folders;
+        m_callback = callback;
+        m_running = true;
+        m_thread = std::thread(&FileWatcher::run, this);
+    }
+
+    void FileWatcher::stop() {
+        m_running = false;
+        if (m_thread.joinable())
+            m_thread.join();
+    }
+
+    bool FileWatcher::running() const {
+        return m_running;
+    }
+
+    void FileWatcher::run() {
+        traceThreadName("file watcher");
+
+#if defined(__linux__)
+        runNotify();
+#else
+        runPolling();
+#endif
+    }
+
+    void FileWatcher::runPolling() {
+        using Snapshot = std::map<std::string, int64_t>;
+
+        auto scan = [this]() {
+            Snapshot snapshot;
+            for (auto const& folder : m_folders) {
+                for (auto const& file : getDirectoryContents(folder)) {
+                    std::string filepath = mergePaths(folder, file);
+                    int64_t modified = 0;
+                    if (fileType(filepath) == FileType::FileRegular && fileModificationTime(filepath, modified))
+                        snapshot[filepath] = modified;
+                }
+            }
+            return snapshot;
+        };
+
+        Snapshot known = scan();
+
+        while (m_running) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(PollInterval));
+
+            Snapshot current = scan();
+
+            std::vector<std::string> changed;
+            for (auto const& [filepath, modified] : current) {
+                auto found = known.find(filepath);
+                if (found == known.end() || found->second != modified)
+                    changed.push_back(filepath);
+            }
+
+            for (auto const& [filepath, modified] : known)
+                if (!current.contains(filepath))
+                    changed.push_back(filepath);
+
+            known = current;
+
+            if (!changed.empty() && m_running)
+                m_callback(changed);
+        }
+    }
+
+    void FileWatcher::runNotify() {
+#if defined(__linux__)
+        int fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+        if (fd < 0) {
+            runPolling();
+            return;
+        }
+
+        std::map<int, std::string> watches;
+        for (auto const& folder : m_folders) {
+            int wd = inotify_add_watch(fd, folder.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO | IN_MOVED_FROM | IN_DELETE);
+            if (wd >= 0)
+                watches[wd] = folder;
+        }
+
+        std::set<std::string> pending;
+        ElapsedTimer settle;
+
+        alignas(inotify_event) char buffer[4096];
+
+        while (m_running) {
+            pollfd pfd = { fd, POLLIN, 0 };
+            int ready = poll(&pfd, 1, 50);
+
+            if (ready > 0) {
+                ssize_t length = 0;
+                while ((length = read(fd, buffer, sizeof(buffer))) > 0) {
+                    for (char* p = buffer; p < buffer + length; ) {
+                        inotify_event* event = (inotify_event*)p;
+                        p += sizeof(inotify_event) + event->len;
+
+                        auto found = watches.find(event->wd);
+                        if (found == watches.end() || event->len == 0 || (event->mask & IN_ISDIR))
+                            continue;
+
+                        pending.insert(mergePaths(found->second, event->name));
+                        settle.start();
+                    }
+                }
+            }
+
+            if (!pending.empty() && settle.hasExpired(SettleTime)) {
+                std::vector<std::string> changed(pending.begin(), pending.end());
+                pending.clear();
+                m_callback(changed);
+            }
+        }
+
+        close(fd);
+#endif
+    }
+}
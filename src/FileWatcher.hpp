@@ -0,0 +1,38 @@
+#pragma once
+
+#include "Lang.hpp"
+
+#include <thread>
+#include <atomic>
+
+namespace pw {
+
+    //
+    // Watches folders for changed, added and removed files on a background thread.
+    // Uses inotify on linux and polls modification times elsewhere.
+    //
+    class FileWatcher {
+    public:
+        // runs on the watcher thread with the paths that changed, events are grouped until the folders settle
+        using Callback = std::function<void(std::vector<std::string> const& changed)>;
+
+        FileWatcher();
+        ~FileWatcher();
+
+        void start(std::vector<std::string> const& folders, Callback callback);
+        void stop();
+
+        bool running() const;
+    private:
+        std::thread m_thread;
+        std::atomic<bool> m_running;
+
+        std::vector<std::string> m_folders;
+        Callback m_callback;
+
+        void run();
+        void runPolling();
+        void runNotify();
+    };
+
+}
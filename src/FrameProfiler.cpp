@@ -0,0 +1,272 @@
+#include "FrameProfiler.hpp"
+#include "Text.hpp"
+#include "Jobs.hpp"
+
+#include "raylib.h"
+
+namespace pw {
+
+    // how much history the overlay percentiles are computed over
+    constexpr int64_t OverlayWindow = 2000;
+
+    // a sample is the timestamp in the high bits and the duration in the low DurationBits
+    constexpr int DurationBits = 24;
+    constexpr uint64_t DurationMask = (uint64_t(1) << DurationBits) - 1;
+
+    const char* frameStageName(FrameStage stage) {
+        switch (stage) {
+            case FrameStage::Actions: return "actions";
+            case FrameStage::Sizes: return "sizes";
+            case FrameStage::Context: return "context";
+            case FrameStage::Shader: return "shader";
+            case FrameStage::Clamp: return "clamp";
+            case FrameStage::Sink: return "sink";
+            case FrameStage::Upload: return "upload";
+            case FrameStage::Draw: return "draw";
+            case FrameStage::Gui: return "gui";
+            default: return "unknown";
+        }
+    }
+
+    //
+    // StageSamples
+    //
+    StageSamples::StageSamples()
+        :m_head(0)
+    {
+        for (auto& sample : m_samples)
+            sample.store(0, std::memory_order_relaxed);
+    }
+
+    void StageSamples::push(int64_t timestamp, int64_t duration) {
+        uint64_t packed = (uint64_t(timestamp) << DurationBits) | uint64_t(clampTo<int64_t>(duration, 0, DurationMask));
+
+        uint64_t head = m_head.load(std::memory_order_relaxed);
+        m_samples[head % Capacity].store(packed, std::memory_order_relaxed);
+        m_head.store(head + 1, std::memory_order_release);
+    }
+
+    void StageSamples::collect(int64_t since, std::vector<Sample>& samples) const {
+        samples.clear();
+
+        uint64_t head = m_head.load(std::memory_order_acquire);
+        uint64_t count = minimum<uint64_t>(head, Capacity);
+
+        // newest to oldest, stops at the first sample that is too old
+        for (uint64_t i = 0; i != count; ++i) {
+            uint64_t packed = m_samples[(head - 1 - i) % Capacity].load(std::memory_order_relaxed);
+
+            Sample sample;
+            sample.timestamp = int64_t(packed >> DurationBits);
+            sample.duration = int64_t(packed & DurationMask);
+            if (sample.timestamp < since)
+                break;
+
+            samples.push_back(sample);
+        }
+
+        std::reverse(samples.begin(), samples.end());
+    }
+
+    //
+    // FrameProfiler
+    //
+    FrameProfiler::FrameProfiler()
+        :m_start(getCurrentMicroseconds())
+    { }
+
+    void FrameProfiler::setup() {
+        // parallel shaders run most of their tiles on the pool workers
+        m_counters.open(JobSystem::shared().threadIds());
+    }
+
+    void FrameProfiler::record(FrameStage stage, int64_t start, int64_t end) {
+        m_stages[size_t(stage)].push(start - m_start, end - start);
+    }
+
+    PerfCounters& FrameProfiler::counters() {
+        return m_counters;
+    }
+
+    void FrameProfiler::recordCounters(FrameStage stage, std::string const& shader, PerfCounterValues const& values) {
+        CounterTotals& totals = m_counter_totals[shader][size_t(stage)];
+        totals.frames++;
+
+        for (size_t i = 0; i != values.values.size(); ++i) {
+            if (values.values[i] < 0)
+                continue;
+            totals.values.values[i] = maximum<int64_t>(totals.values.values[i], 0) + values.values[i];
+        }
+    }
+
+    // 1234567 -> 1.23M
+    static std::string shortNumber(double value) {
+        if (value < 0.0) return "n/a";
+        if (value >= 1e9) return sfmt("%.2fG", value / 1e9);
+        if (value >= 1e6) return sfmt("%.2fM", value / 1e6);
+        if (value >= 1e3) return sfmt("%.1fk", value / 1e3);
+        return sfmt("%.0f", value);
+    }
+
+    static FrameProfiler::Percentiles computePercentiles(std::vector<StageSamples::Sample> const& samples) {
+        FrameProfiler::Percentiles percentiles;
+        percentiles.count = int(samples.size());
+        if (samples.empty())
+            return percentiles;
+
+        std::vector<int64_t> durations;
+        durations.reserve(samples.size());
+        for (auto const& sample : samples)
+            durations.push_back(sample.duration);
+
+        auto at = [&durations](float percentile) {
+            size_t index = minimum(durations.size() - 1, size_t(percentile * durations.size()));
+            std::nth_element(durations.begin(), durations.begin() + index, durations.end());
+            return durations[index] / 1000.0f;
+        };
+
+        percentiles.p50 = at(0.50f);
+        percentiles.p95 = at(0.95f);
+        percentiles.p99 = at(0.99f);
+        return percentiles;
+    }
+
+    FrameProfiler::Percentiles FrameProfiler::percentiles(FrameStage stage, int64_t window) const {
+        int64_t now = getCurrentMicroseconds() - m_start;
+
+        std::vector<StageSamples::Sample> samples;
+        m_stages[size_t(stage)].collect(now - window * 1000, samples);
+        return computePercentiles(samples);
+    }
+
+    void FrameProfiler::renderOverlay(int x, int y, std::string const& shader) const {
+        constexpr int font_size = 10;
+        constexpr int line_height = 12;
+        constexpr FrameStage counted[] = { FrameStage::Shader, FrameStage::Upload };
+
+        int lines = int(FrameStage::Count) + 1 + (m_counters.available() ? 3 : 1);
+        DrawRectangle(x, y, 290, line_height * lines + 6, Fade(BLACK, 0.6f));
+        x += 4;
+        y += 4;
+
+        DrawText(TextFormat("%-8s %8s %8s %8s", "ms", "p50", "p95", "p99"), x, y, font_size, RAYWHITE);
+        y += line_height;
+
+        for (int i = 0; i != int(FrameStage::Count); ++i) {
+            FrameStage stage = FrameStage(i);
+            Percentiles p = percentiles(stage, OverlayWindow);
+            DrawText(TextFormat("%-8s %8.2f %8.2f %8.2f", frameStageName(stage), p.p50, p.p95, p.p99), x, y, font_size, RAYWHITE);
+            y += line_height;
+        }
+
+        if (!m_counters.available()) {
+            DrawText("hardware counters not available", x, y, font_size, RAYWHITE);
+            return;
+        }
+
+        DrawText(TextFormat("%-8s %8s %8s %8s %8s  (%d threads)", "frame", "cycles", "ipc", "llc miss", "br miss", m_counters.threads()), x, y, font_size, RAYWHITE);
+        y += line_height;
+
+        auto found = m_counter_totals.find(shader);
+        for (FrameStage stage : counted) {
+            CounterTotals totals;
+            if (found != m_counter_totals.end())
+                totals = found->second[size_t(stage)];
+
+            auto perFrame = [&totals](PerfCounter counter) {
+                return (totals.frames == 0 || totals.values[counter] < 0) ? -1.0 : double(totals.values[counter]) / totals.frames;
+            };
+
+            double cycles = perFrame(PerfCounter::Cycles);
+            double instructions = perFrame(PerfCounter::Instructions);
+            std::string ipc = (cycles > 0.0 && instructions >= 0.0) ? sfmt("%.2f", instructions / cycles) : "n/a";
+
+            DrawText(TextFormat("%-8s %8s %8s %8s %8s", frameStageName(stage), shortNumber(cycles).c_str(), ipc.c_str(),
+                shortNumber(perFrame(PerfCounter::CacheMisses)).c_str(), shortNumber(perFrame(PerfCounter::BranchMisses)).c_str()), x, y, font_size, RAYWHITE);
+            y += line_height;
+        }
+    }
+
+    bool FrameProfiler::dump(int64_t seconds) const {
+        int64_t now = getCurrentMicroseconds() - m_start;
+        int64_t since = now - seconds * 1000 * 1000;
+
+        std::string csv = "stage,timestamp_us,duration_us\n";
+        std::string json = sfmt("{\n  \"seconds\": %lld,\n  \"stages\": {", (long long)seconds);
+
+        std::vector<StageSamples::Sample> samples;
+        for (int i = 0; i != int(FrameStage::Count); ++i) {
+            const char* name = frameStageName(FrameStage(i));
+            m_stages[i].collect(since, samples);
+            Percentiles p = computePercentiles(samples);
+
+            json += sfmt("%s\n    \"%s\": {\n      \"count\": %d, \"p50_ms\": %.3f, \"p95_ms\": %.3f, \"p99_ms\": %.3f,\n      \"samples\": [",
+                i == 0 ? "" : ",", name, p.count, p.p50, p.p95, p.p99);
+
+            for (size_t s = 0; s != samples.size(); ++s) {
+                csv += sfmt("%s,%lld,%lld\n", name, (long long)samples[s].timestamp, (long long)samples[s].duration);
+                json += sfmt("%s[%lld, %lld]", s == 0 ? "" : ", ", (long long)samples[s].timestamp, (long long)samples[s].duration);
+            }
+
+            json += "]\n    }";
+        }
+        json += sfmt("\n  },\n  \"counted_threads\": %d,\n  \"counters\": {", m_counters.threads());
+
+        // totals since the start, per shader and stage
+        bool first_shader = true;
+        for (auto const& [shader, stages] : m_counter_totals) {
+            json += sfmt("%s\n    \"%s\": {", first_shader ? "" : ",", shader);
+            first_shader = false;
+
+            bool first_stage = true;
+            for (int i = 0; i != int(FrameStage::Count); ++i) {
+                CounterTotals const& totals = stages[i];
+                if (totals.frames == 0)
+                    continue;
+
+                json += sfmt("%s\n      \"%s\": { \"frames\": %lld", first_stage ? "" : ",", frameStageName(FrameStage(i)), (long long)totals.frames);
+                first_stage = false;
+
+                for (int c = 0; c != int(PerfCounter::Count); ++c)
+                    if (totals.values.values[c] >= 0)
+                        json += sfmt(", \"%s\": %lld", perfCounterName(PerfCounter(c)), (long long)totals.values.values[c]);
+                json += " }";
+            }
+            json += "\n    }";
+        }
+        json += "\n  }\n}\n";
+
+        std::string base = "pinworld_profile_" + datetimeMarker();
+        bool written = writeRawText(base + ".csv", csv) && writeRawText(base + ".json", json);
+        if (written)
+            TraceLog(LOG_INFO, "Profile > last %llds written to %s.csv and %s.json", (long long)seconds, base.c_str(), base.c_str());
+        else
+            TraceLog(LOG_ERROR, "Profile > unable to write %s", base.c_str());
+        return written;
+    }
+
+    //
+    // ScopedStageCounters
+    //
+    ScopedStageCounters::ScopedStageCounters(FrameProfiler& profiler, FrameStage stage, std::string const& shader)
+        :m_profiler(profiler), m_stage(stage), m_shader(shader)
+    {
+        m_profiler.counters().start();
+    }
+
+    ScopedStageCounters::~ScopedStageCounters() {
+        if (m_profiler.counters().available())
+            m_profiler.recordCounters(m_stage, m_shader, m_profiler.counters().stop());
+    }
+
+    //
+    // ScopedStageTimer
+    //
+    ScopedStageTimer::ScopedStageTimer(FrameProfiler& profiler, FrameStage stage)
+        :m_profiler(profiler), m_stage(stage), m_start(getCurrentMicroseconds())
+    { }
+
+    ScopedStageTimer::~ScopedStageTimer() {
+        m_profiler.record(m_stage, m_start, getCurrentMicroseconds());
+    }
+}
@@ -0,0 +1,114 @@
+#pragma once
+
+#include "Lang.hpp"
+#include "PerfCounters.hpp"
+
+#include <atomic>
+
+namespace pw {
+
+    // stages of PinWorld::step()
+    enum class FrameStage {
+        Actions,        // shader merges, menu actions and camera
+        Sizes,          // computeSizes
+        Context,        // meta shader context update
+        Shader,         // meta shader evaluation
+        Clamp,          // pins clamped to [0, 1]
+        Sink,           // pins quantized for the UDP output
+        Upload,         // pins vertex buffer upload
+        Draw,           // background and pins draw calls
+        Gui,            // fps, overlay and menu
+
+        Count
+    };
+
+    const char* frameStageName(FrameStage stage);
+
+    //
+    // Fixed size ring of timing samples, written by one thread and readable from any thread without locks.
+    // Each sample is packed in one atomic word, so a reader never sees half of a sample.
+    //
+    class StageSamples {
+    public:
+        static constexpr int Capacity = 4096;   // about a minute at 60 fps
+
+        struct Sample {
+            int64_t timestamp;                  // microseconds since the profiler started
+            int64_t duration;                   // microseconds
+        };
+
+        StageSamples();
+
+        void push(int64_t timestamp, int64_t duration);
+
+        // samples taken at or after since, oldest first
+        void collect(int64_t since, std::vector<Sample>& samples) const;
+    private:
+        std::array<std::atomic<uint64_t>, Capacity> m_samples;
+        std::atomic<uint64_t> m_head;
+    };
+
+    class FrameProfiler {
+    public:
+        struct Percentiles {
+            int count = 0;
+            float p50 = 0.0f;                   // milliseconds
+            float p95 = 0.0f;
+            float p99 = 0.0f;
+        };
+
+        // hardware counters, per shader, since the start
+        struct CounterTotals {
+            int64_t frames = 0;
+            PerfCounterValues values;
+        };
+
+        FrameProfiler();
+
+        // opens the hardware counters, they count the calling thread and the shared job system workers
+        void setup();
+
+        void record(FrameStage stage, int64_t start, int64_t end);
+
+        PerfCounters& counters();
+        void recordCounters(FrameStage stage, std::string const& shader, PerfCounterValues const& values);
+
+        // over the samples of the last window milliseconds
+        Percentiles percentiles(FrameStage stage, int64_t window) const;
+
+        // rolling percentiles of every stage and the counters of the active shader
+        void renderOverlay(int x, int y, std::string const& shader) const;
+
+        // writes the samples of the last seconds to a csv and a json file in the working folder
+        bool dump(int64_t seconds) const;
+    private:
+        int64_t m_start;
+        std::array<StageSamples, size_t(FrameStage::Count)> m_stages;
+
+        PerfCounters m_counters;
+        std::map<std::string, std::array<CounterTotals, size_t(FrameStage::Count)>> m_counter_totals;   // main thread only
+    };
+
+    // counts one stage of the given shader, nothing is counted when the counters aren't available
+    class ScopedStageCounters {
+    public:
+        ScopedStageCounters(FrameProfiler& profiler, FrameStage stage, std::string const& shader);
+        ~ScopedStageCounters();
+    private:
+        FrameProfiler& m_profiler;
+        FrameStage m_stage;
+        std::string m_shader;
+    };
+
+    // records the time between construction and destruction as one stage sample
+    class ScopedStageTimer {
+    public:
+        ScopedStageTimer(FrameProfiler& profiler, FrameStage stage);
+        ~ScopedStageTimer();
+    private:
+        FrameProfiler& m_profiler;
+        FrameStage m_stage;
+        int64_t m_start;
+    };
+
+}
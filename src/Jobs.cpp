@@ -0,0 +1,247 @@
+#include "Jobs.hpp"
+#include "Trace.hpp"
+
+#include "raylib.h"
+
+namespace pw {
+
+    //
+    // JobSystem
+    //
+    JobSystem::JobSystem(int threads)
+        :m_stopping(false)
+    {
+        for (int i = 0; i < threads; ++i)
+            m_workers.emplace_back(&JobSystem::work, this);
+    }
+
+    JobSystem::~JobSystem() {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_stopping = true;
+        }
+        m_condition.notify_all();
+
+        for (auto& worker : m_workers)
+            worker.join();
+    }
+
+    void JobSystem::submit(Job job) {
+        if (m_workers.empty()) {
+            job();
+            return;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_jobs.push_back(std::move(job));
+        }
+        m_condition.notify_one();
+    }
+
+    int JobSystem::threads() const {
+        return int(m_workers.size());
+    }
+
+    std::vector<int> JobSystem::threadIds() {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_started.wait(lock, [this]() { return m_thread_ids.size() == m_workers.size(); });
+        return m_thread_ids;
+    }
+
+    void JobSystem::work() {
+        traceThreadName("jobs");
+
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_thread_ids.push_back(threadId());
+        }
+        m_started.notify_all();
+
+        while (true) {
+            Job job;
+            {
+                std::unique_lock<std::mutex> lock(m_mutex);
+                m_condition.wait(lock, [this]() { return m_stopping || !m_jobs.empty(); });
+
+                if (m_jobs.empty())
+                    return;
+
+                job = std::move(m_jobs.front());
+                m_jobs.pop_front();
+            }
+
+            job();
+        }
+    }
+
+    JobSystem& JobSystem::shared() {
+#if defined(__EMSCRIPTEN__)
+        static JobSystem jobs(0);
+#else
+        static JobSystem jobs(maximum(1, int(std::thread::hardware_concurrency()) - 1));
+#endif
+        return jobs;
+    }
+
+    void parallelFor(JobSystem& jobs, int count, std::function<void(int index)> const& job) {
+        if (count <= 0)
+            return;
+
+        int helpers = minimum(jobs.threads(), count - 1);
+        if (helpers == 0) {
+            for (int i = 0; i != count; ++i)
+                job(i);
+            return;
+        }
+
+        // helpers may only start after the call returned, they find nothing left and don't touch the job
+        struct Shared {
+            std::function<void(int)> job;
+            int count = 0;
+            std::atomic<int> next{ 0 };
+            std::atomic<int> done{ 0 };
+            std::mutex mutex;
+            std::condition_variable condition;
+        };
+
+        auto shared = std::make_shared<Shared>();
+        shared->job = job;
+        shared->count = count;
+
+        auto work = [](Shared& s) {
+            int ran = 0;
+            for (int i = s.next++; i < s.count; i = s.next++) {
+                s.job(i);
+                ++ran;
+            }
+
+            if (ran > 0 && s.done.fetch_add(ran) + ran == s.count) {
+                std::lock_guard<std::mutex> lock(s.mutex);
+                s.condition.notify_all();
+            }
+        };
+
+        for (int i = 0; i != helpers; ++i)
+            jobs.submit([shared, work]() { work(*shared); });
+
+        work(*shared);
+
+        std::unique_lock<std::mutex> lock(shared->mutex);
+        shared->condition.wait(lock, [&shared]() { return shared->done == shared->count; });
+    }
+
+    //
+    // JobGraph
+    //
+    JobGraph::JobGraph()
+        :m_jobs(nullptr), m_remaining(0), m_run_start(0)
+    { }
+
+    JobGraph::~JobGraph() {
+        wait();
+    }
+
+    JobGraph::JobId JobGraph::add(std::string const& name, JobSystem::Job job, std::vector<JobId> const& dependencies) {
+        assert(m_jobs == nullptr);
+
+        JobId id = JobId(m_nodes.size());
+
+        Node node;
+        node.name = name;
+        node.job = std::move(job);
+        node.pending = int(dependencies.size());
+        m_nodes.push_back(std::move(node));
+
+        for (JobId dependency : dependencies) {
+            assert(dependency < id);
+            m_nodes[dependency].dependents.push_back(id);
+        }
+
+        return id;
+    }
+
+    void JobGraph::run(JobSystem& jobs) {
+        std::vector<JobId> ready;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_jobs = &jobs;
+            m_remaining = int(m_nodes.size());
+            m_run_start = getCurrentMicroseconds();
+
+            for (JobId id = 0; id != JobId(m_nodes.size()); ++id)
+                if (m_nodes[id].pending == 0)
+                    ready.push_back(id);
+        }
+
+        for (JobId id : ready)
+            submit(id);
+    }
+
+    void JobGraph::submit(JobId id) {
+        m_jobs->submit([this, id]() {
+            Node& node = m_nodes[id];
+
+            int64_t start = getCurrentMicroseconds() - m_run_start;
+            {
+                PW_TRACE_ZONE(node.name.c_str());
+                node.job();
+            }
+            int64_t end = getCurrentMicroseconds() - m_run_start;
+
+            std::vector<JobId> ready;
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                node.start = start;
+                node.end = end;
+                node.done = true;
+                --m_remaining;
+
+                for (JobId dependent : node.dependents)
+                    if (--m_nodes[dependent].pending == 0)
+                        ready.push_back(dependent);
+
+                // notified under the lock, a waiter may destroy the graph as soon as it is released
+                m_condition.notify_all();
+            }
+
+            for (JobId dependent : ready)
+                submit(dependent);
+        });
+    }
+
+    void JobGraph::wait(JobId id) {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_condition.wait(lock, [this, id]() { return m_jobs == nullptr || m_nodes[id].done; });
+    }
+
+    void JobGraph::wait() {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_condition.wait(lock, [this]() { return m_remaining == 0; });
+    }
+
+    bool JobGraph::finished() {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_remaining == 0;
+    }
+
+    void JobGraph::logTimings(std::string const& title) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+
+        int64_t work = 0;
+        int64_t total = 0;
+        for (auto const& node : m_nodes) {
+            if (!node.done)
+                continue;
+
+            TraceLog(LOG_DEBUG, "%s > %-8s %8.2f ms (started at %.2f ms)", title.c_str(), node.name.c_str(),
+                (node.end - node.start) / 1000.0, node.start / 1000.0);
+
+            work += node.end - node.start;
+            total = maximum(total, node.end);
+        }
+
+        TraceLog(LOG_DEBUG, "%s > %d jobs, %.2f ms of work in %.2f ms on %d threads", title.c_str(), int(m_nodes.size()),
+            work / 1000.0, total / 1000.0, m_jobs ? maximum(1, m_jobs->threads()) : 0);
+    }
+}
@@ -0,0 +1,91 @@
+#pragma once
+
+#include "Lang.hpp"
+
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <deque>
+#include <atomic>
+
+namespace pw {
+
+    //
+    // Fixed pool of worker threads that run submitted jobs in order.
+    // Without workers (web build) jobs run inline on submit.
+    //
+    class JobSystem {
+    public:
+        using Job = std::function<void()>;
+
+        explicit JobSystem(int threads);
+        ~JobSystem();
+
+        void submit(Job job);
+        int threads() const;
+
+        // os ids of the worker threads, waits for every worker to start
+        std::vector<int> threadIds();
+
+        // pool shared by the whole app, one worker per core minus the main thread
+        static JobSystem& shared();
+    private:
+        std::vector<std::thread> m_workers;
+        std::mutex m_mutex;
+        std::condition_variable m_condition;
+        std::deque<Job> m_jobs;
+        bool m_stopping;
+
+        std::condition_variable m_started;
+        std::vector<int> m_thread_ids;
+
+        void work();
+    };
+
+    // runs job(index) for every index in [0, count), on the calling thread and the pool workers, returns when all ran
+    void parallelFor(JobSystem& jobs, int count, std::function<void(int index)> const& job);
+
+    //
+    // Jobs with dependencies, a job is submitted once every job it depends on finished.
+    // Records when each job ran so the cost of a graph can be broken down.
+    //
+    class JobGraph {
+    public:
+        using JobId = int;
+
+        JobGraph();
+        ~JobGraph();    // waits for the jobs that are running
+
+        // jobs can only depend on jobs added before them, nothing can be added after run
+        JobId add(std::string const& name, JobSystem::Job job, std::vector<JobId> const& dependencies = {});
+
+        void run(JobSystem& jobs);
+
+        void wait(JobId id);
+        void wait();
+        bool finished();
+
+        // per job start and duration, at LOG_DEBUG
+        void logTimings(std::string const& title);
+    private:
+        struct Node {
+            std::string name;
+            JobSystem::Job job;
+            std::vector<JobId> dependents;
+            int pending = 0;            // dependencies that didn't finish yet
+            bool done = false;
+            int64_t start = 0;          // microseconds since run
+            int64_t end = 0;
+        };
+
+        std::vector<Node> m_nodes;
+        JobSystem* m_jobs;
+        std::mutex m_mutex;
+        std::condition_variable m_condition;
+        int m_remaining;
+        int64_t m_run_start;
+
+        void submit(JobId id);
+    };
+
+}
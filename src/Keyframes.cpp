@@ -0,0 +1,106 @@
+#include "Keyframes.hpp"
+#include "Jobs.hpp"
+#include "Trace.hpp"
+
+namespace pw {
+
+    Keyframes::Keyframes()
+        :m_enabled(false), m_previous_time(0.0f), m_current_time(0.0f), m_next_time(0.0f), m_next_pending(false), m_running(false)
+    { }
+
+    Keyframes::~Keyframes() {
+        wait();
+    }
+
+    void Keyframes::setEnabled(bool enabled) {
+        reset();
+        m_enabled = enabled;
+    }
+
+    bool Keyframes::enabled() const {
+        return m_enabled;
+    }
+
+    void Keyframes::wait() {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_condition.wait(lock, [this]() { return !m_running; });
+    }
+
+    void Keyframes::reset() {
+        wait();
+
+        m_previous.clear();
+        m_current.clear();
+        m_next.clear();
+        m_next_pending = false;
+    }
+
+    bool Keyframes::running() {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_running;
+    }
+
+    void Keyframes::start(float time, Evaluate const& evaluate) {
+        // shaders that read the pin value carry on from the last keyframe
+        m_next = m_current;
+        m_next_time = time;
+        m_next_pending = true;
+
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_running = true;
+        }
+
+        JobSystem::shared().submit([this, evaluate]() {
+            {
+                PW_TRACE_ZONE("keyframe");
+                evaluate(m_next.data(), m_next_time);
+            }
+
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_running = false;
+            m_condition.notify_all();
+        });
+    }
+
+    void Keyframes::update(std::vector<float>& pins, float time, Evaluate const& evaluate) {
+        float const interval = 1.0f / Rate;
+
+        if (m_current.size() != pins.size()) {
+            reset();
+
+            // the first keyframe shows up on this frame
+            m_current = pins;
+            evaluate(m_current.data(), time);
+
+            m_previous = m_current;
+            m_previous_time = m_current_time = time;
+        }
+
+        float display = time - interval;
+
+        // a late keyframe holds the display on the current one, the frame never waits for the worker
+        if (m_next_pending && display >= m_current_time && !running()) {
+            std::swap(m_previous, m_current);
+            std::swap(m_current, m_next);
+            m_previous_time = m_current_time;
+            m_current_time = m_next_time;
+            m_next_pending = false;
+        }
+
+        // a worker that fell behind starts from the present instead of catching up
+        if (!m_next_pending)
+            start(maximum(m_current_time + interval, time), evaluate);
+
+        float const span = m_current_time - m_previous_time;
+        float const t = (span > 0.0f) ? clampTo((display - m_previous_time) / span, 0.0f, 1.0f) : 1.0f;
+
+        float const* previous = m_previous.data();
+        float const* current = m_current.data();
+        float* out = pins.data();
+        int const count = int(pins.size());
+        for (int i = 0; i < count; ++i)
+            out[i] = previous[i] + (current[i] - previous[i]) * t;
+    }
+
+}
@@ -0,0 +1,56 @@
+#pragma once
+
+#include "Lang.hpp"
+
+#include <mutex>
+#include <condition_variable>
+
+namespace pw {
+
+    //
+    // Evaluates the shader at a lower rate on a pool worker and interpolates the pins between the last two keyframes.
+    // The display runs one keyframe interval behind the shader time, so it never extrapolates,
+    // and the next keyframe has a whole interval to be evaluated.
+    //
+    class Keyframes {
+    public:
+        static constexpr float Rate = 15.0f;    // keyframes per second
+
+        // evaluates the shader at time into a canvas of pins, that holds the previous keyframe
+        using Evaluate = std::function<void(float* pins, float time)>;
+
+        Keyframes();
+        ~Keyframes();   // waits for the keyframe in flight
+
+        void setEnabled(bool enabled);
+        bool enabled() const;
+
+        // writes the pins for time. the first call after a reset evaluates a keyframe right away,
+        // later calls only start the next keyframe in the background and never wait for it
+        void update(std::vector<float>& pins, float time, Evaluate const& evaluate);
+
+        // the keyframe in flight reads the shader context, it has to finish before the context changes
+        void wait();
+
+        // waits and drops the keyframes, the next update starts over from the pins. call when the shader or the canvas changes
+        void reset();
+    private:
+        bool m_enabled;
+
+        std::vector<float> m_previous;
+        std::vector<float> m_current;
+        std::vector<float> m_next;      // written by the worker while m_running
+        float m_previous_time;
+        float m_current_time;
+        float m_next_time;
+        bool m_next_pending;            // a keyframe was started and wasn't taken yet
+
+        std::mutex m_mutex;
+        std::condition_variable m_condition;
+        bool m_running;
+
+        bool running();
+        void start(float time, Evaluate const& evaluate);
+    };
+
+}
@@ -1,10 +1,13 @@
 #include "Lang.hpp"
 #include "Text.hpp"
 
+#include "raylib.h"
+
 #include <filesystem>
 #include <fstream>
 #include <chrono>
 #include <mutex>
+#include <atomic>
 #include <ctime>
 
 
@@ -12,11 +15,23 @@
 #if defined(__APPLE__)
 	#include <mach-o/dyld.h>
 #elif defined(_WIN32)
+	// the gdi and user parts of windows.h clash with raylib names
+	#define NOGDI
+	#define NOUSER
 	#include <windows.h>
 #else
 	#include <unistd.h>
 #endif
 
+#if !defined(_WIN32)
+	#include <dlfcn.h>
+	#include <unistd.h>
+#endif
+
+#if defined(__linux__)
+	#include <sys/syscall.h>
+#endif
+
 namespace pw {
 
     static std::once_flag g_initialization_flag;
@@ -56,17 +71,158 @@ namespace pw {
         return std::string(buffer);
     }
 
-    // random number between 0.0 and 1.0
+    //
+    // Fast math
+    //
+    bool checkFastMath() {
+        struct Check {
+            const char* name;
+            float bound[2];         // fast, precise
+            bool relative;
+            std::function<float(float, float)> fast;
+            std::function<float(float, float)> precise;
+            std::function<double(double, double)> reference;
+            float x[2];             // range of x
+            float y[2];             // range of y, for the two argument functions
+        };
+
+        std::vector<Check> checks = {
+            { "sin", { 2e-3f, 1e-6f }, false, [](float x, float) { return fastSin(x); }, [](float x, float) { return fastSin<MathAccuracy::Precise>(x); },
+                [](double x, double) { return std::sin(x); }, { -100.0f, 100.0f }, { 0.0f, 0.0f } },
+            { "cos", { 2e-3f, 1e-6f }, false, [](float x, float) { return fastCos(x); }, [](float x, float) { return fastCos<MathAccuracy::Precise>(x); },
+                [](double x, double) { return std::cos(x); }, { -100.0f, 100.0f }, { 0.0f, 0.0f } },
+            { "exp", { 1e-3f, 1e-6f }, true, [](float x, float) { return fastExp(x); }, [](float x, float) { return fastExp<MathAccuracy::Precise>(x); },
+                [](double x, double) { return std::exp(x); }, { -20.0f, 20.0f }, { 0.0f, 0.0f } },
+            { "log2", { 1e-4f, 1e-6f }, false, [](float x, float) { return fastLog2(x); }, [](float x, float) { return fastLog2<MathAccuracy::Precise>(x); },
+                [](double x, double) { return std::log2(x); }, { 1e-3f, 1e3f }, { 0.0f, 0.0f } },
+            { "pow", { 2e-3f, 4e-6f }, true, [](float x, float y) { return fastPow(x, y); }, [](float x, float y) { return fastPow<MathAccuracy::Precise>(x, y); },
+                [](double x, double y) { return std::pow(x, y); }, { 1e-3f, 10.0f }, { -3.0f, 3.0f } },
+            { "cbrt", { 2e-3f, 1e-6f }, true, [](float x, float) { return fastCbrt(x); }, [](float x, float) { return fastCbrt<MathAccuracy::Precise>(x); },
+                [](double x, double) { return std::cbrt(x); }, { -1000.0f, 1000.0f }, { 0.0f, 0.0f } },
+            { "atan2", { 2e-3f, 1e-6f }, false, [](float y, float x) { return fastAtan2(y, x); }, [](float y, float x) { return fastAtan2<MathAccuracy::Precise>(y, x); },
+                [](double y, double x) { return std::atan2(y, x); }, { -10.0f, 10.0f }, { -10.0f, 10.0f } },
+        };
+
+        constexpr int Samples = 200000;
+
+        bool passed = true;
+        for (auto const& check : checks) {
+            float worst[2] = { 0.0f, 0.0f };
+            RandomGenerator random(1);
+
+            for (int i = 0; i != Samples; ++i) {
+                float x = random.uniformRange(check.x[0], check.x[1]);
+                float y = random.uniformRange(check.y[0], check.y[1]);
+
+                double expected = check.reference(x, y);
+                double scale = check.relative ? maximum(std::abs(expected), 1e-30) : 1.0;
+
+                worst[0] = maximum(worst[0], float(std::abs(check.fast(x, y) - expected) / scale));
+                worst[1] = maximum(worst[1], float(std::abs(check.precise(x, y) - expected) / scale));
+            }
+
+            bool ok = worst[0] <= check.bound[0] && worst[1] <= check.bound[1];
+            passed = passed && ok;
+
+            TraceLog(ok ? LOG_INFO : LOG_ERROR, "Math > %-6s %s error fast %.2e (bound %.0e) precise %.2e (bound %.0e) %s", check.name, check.relative ? "relative" : "absolute",
+                worst[0], check.bound[0], worst[1], check.bound[1], ok ? "ok" : "FAILED");
+        }
+
+        return passed;
+    }
+
+
+    //
+    // Random
+    //
+    static uint32_t splitMix(uint64_t& state) {
+        uint64_t z = (state += 0x9e3779b97f4a7c15ull);
+        z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+        z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+        return uint32_t((z ^ (z >> 31)) >> 32);
+    }
+
+    static inline uint32_t rotateLeft(uint32_t x, int k) {
+        return (x << k) | (x >> (32 - k));
+    }
+
+    RandomGenerator::RandomGenerator(uint32_t seed) {
+        this->seed(seed);
+    }
+
+    void RandomGenerator::seed(uint32_t seed) {
+        // splitmix never gives an all zero state
+        uint64_t state = seed;
+        for (uint32_t& s : m_state)
+            s = splitMix(state);
+    }
+
+    uint32_t RandomGenerator::next() {
+        uint32_t const result = m_state[0] + m_state[3];
+        uint32_t const t = m_state[1] << 9;
+
+        m_state[2] ^= m_state[0];
+        m_state[3] ^= m_state[1];
+        m_state[1] ^= m_state[2];
+        m_state[0] ^= m_state[3];
+        m_state[2] ^= t;
+        m_state[3] = rotateLeft(m_state[3], 11);
+
+        return result;
+    }
+
+    float RandomGenerator::uniform() {
+        return hashToUniform(next());
+    }
+
+    float RandomGenerator::uniformRange(float minv, float maxv) {
+        return minv + (maxv - minv) * uniform();
+    }
+
+    static std::atomic<uint32_t> g_random_seed(0);
+    static std::atomic<uint32_t> g_random_generation(0);
+    static std::atomic<uint32_t> g_random_threads(0);
+
+    struct ThreadRandom {
+        RandomGenerator generator;
+        uint32_t generation = ~0u;
+        uint32_t thread = g_random_threads++;
+    };
+
+    static RandomGenerator& threadRandom() {
+        thread_local ThreadRandom local;
+
+        uint32_t generation = g_random_generation.load(std::memory_order_acquire);
+        if (local.generation != generation) {
+            local.generator.seed(g_random_seed.load(std::memory_order_relaxed) ^ hashMix(local.thread));
+            local.generation = generation;
+        }
+        return local.generator;
+    }
+
+    void seedRandom(uint32_t seed) {
+        g_random_seed.store(seed, std::memory_order_relaxed);
+        g_random_generation.fetch_add(1, std::memory_order_release);
+    }
+
+    uint32_t randomSeed() {
+        return g_random_seed.load(std::memory_order_relaxed);
+    }
+
 	float uniformRandom() {
-        const float max_float = static_cast<float>(RAND_MAX);
-        const float rand_float = static_cast<float>(rand());
-        return rand_float / max_float;
+        return threadRandom().uniform();
     }
 
     float uniformRandomRange(float minv, float maxv) {
         return minv + (maxv - minv) * uniformRandom();
     }
 
+    void hashUniformFill(uint32_t seed, uint32_t first_index, uint32_t frame, float* values, int count) {
+        uint32_t const key = hashKey(seed, frame);
+        for (int i = 0; i < count; ++i)
+            values[i] = hashToUniform(hashMix((first_index + uint32_t(i)) ^ key));
+    }
+
 
     //
     // Elapsed Timer
@@ -202,6 +358,16 @@ namespace pw {
         return std::filesystem::exists(status);
     }
 
+    bool fileModificationTime(std::string const& filename, int64_t& time) {
+        std::error_code ec;
+        auto write_time = std::filesystem::last_write_time(filename, ec);
+        if (ec)
+            return false;
+
+        time = std::chrono::duration_cast<std::chrono::milliseconds>(write_time.time_since_epoch()).count();
+        return true;
+    }
+
     bool deleteFile(std::string const& filename) {
         std::error_code ec;
         return std::filesystem::remove_all(filename, ec) > 0;
@@ -242,6 +408,22 @@ namespace pw {
         return path;
     }
 
+    int processId() {
+#if defined(_WIN32)
+        return int(GetCurrentProcessId());
+#else
+        return int(getpid());
+#endif
+    }
+
+    int threadId() {
+#if defined(__linux__)
+        return int(syscall(SYS_gettid));
+#else
+        return 0;
+#endif
+    }
+
     DirectoryContents getDirectoryContents(std::string const& directory_name, DirectorySorting sorting, bool reverse) {
         DirectoryContents contents;
 
@@ -420,6 +602,41 @@ namespace pw {
         return out.good();
     }
 
+    //
+    // Dynamic libraries
+    //
+    void* openLibrary(std::string const& filename, std::string& error) {
+#if defined(_WIN32)
+        void* library = (void*)LoadLibraryA(filename.c_str());
+        if (library == nullptr)
+            error = sfmt("LoadLibrary failed with error %d", int(GetLastError()));
+#else
+        void* library = dlopen(filename.c_str(), RTLD_NOW | RTLD_LOCAL);
+        if (library == nullptr)
+            error = dlerror();
+#endif
+        return library;
+    }
+
+    void* librarySymbol(void* library, std::string const& name) {
+#if defined(_WIN32)
+        return (void*)GetProcAddress((HMODULE)library, name.c_str());
+#else
+        return dlsym(library, name.c_str());
+#endif
+    }
+
+    void closeLibrary(void* library) {
+        if (library == nullptr)
+            return;
+
+#if defined(_WIN32)
+        FreeLibrary((HMODULE)library);
+#else
+        dlclose(library);
+#endif
+    }
+
     bool saveCppBinary(uint8_t* data, size_t size, std::string filename) {
         std::ofstream out(filename.c_str(), std::ios::out | std::ios::trunc);
 
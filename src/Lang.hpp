@@ -12,6 +12,7 @@
 #include <iterator>
 
 #include <cmath>
+#include <bit>
 #include <cstdint>
 #include <cassert>
 
@@ -91,10 +92,225 @@ namespace pw {
 
 
 
-	// random number between 0.0 and 1.0
+	//
+	// Fast math for the shader hot paths, the pins are clamped to [0.0, 1.0] so the libm precision is wasted.
+	// Fast is good to about 1e-3 and Precise to about 1e-6, relative for exp, pow and cbrt, absolute for the others.
+	// Exact calls the standard library. The array versions are plain loops over the inline scalar ones, they vectorize.
+	//
+	enum class MathAccuracy {
+		Fast,
+		Precise,
+		Exact
+	};
+
+	// building blocks of the fast math functions
+	inline float fastMathRound(float x) { return float(int(x + ((x >= 0.0f) ? 0.5f : -0.5f))); }
+	inline float fastMathPow2(float k) { return std::bit_cast<float>(uint32_t(int(k) + 127) << 23); }
+
+	// wraps to [-PI, PI], two pi is split in two so the reduction stays exact for large angles
+	inline float fastMathReduceAngle(float x) {
+		float k = fastMathRound(x * TWO_PI_RECIPROCAL);
+		return (x - k * 6.28125f) - k * 1.9353071795864769e-3f;
+	}
+
+	// sin of a in [-PI, PI]
+	template<MathAccuracy A> inline float fastMathSinReduced(float a) {
+		if constexpr (A == MathAccuracy::Fast) {
+			constexpr float B = 4.0f / PI;
+			constexpr float C = -4.0f / (PI * PI);
+			float y = B * a + C * a * absolute(a);
+			return 0.225f * (y * absolute(y) - y) + y;
+		} else {
+			// sin(PI - a) = sin(a), folds to [-PI/2, PI/2]
+			float h = (a > HALF_PI) ? PI - a : ((a < -HALF_PI) ? -PI - a : a);
+			float s = h * h;
+			return h * (1.0f + s * (-1.0f / 6.0f + s * (1.0f / 120.0f + s * (-1.0f / 5040.0f + s * (1.0f / 362880.0f + s * (-1.0f / 39916800.0f))))));
+		}
+	}
+
+	// e^r for r in [-ln(2) / 2, ln(2) / 2]
+	template<MathAccuracy A> inline float fastMathExpReduced(float r) {
+		if constexpr (A == MathAccuracy::Fast)
+			return 1.0f + r * (1.0f + r * (0.5f + r * (1.0f / 6.0f)));
+		else
+			return 1.0f + r * (1.0f + r * (0.5f + r * (1.0f / 6.0f + r * (1.0f / 24.0f + r * (1.0f / 120.0f + r * (1.0f / 720.0f))))));
+	}
+
+	template<MathAccuracy A = MathAccuracy::Fast> inline float fastSin(float x) {
+		if constexpr (A == MathAccuracy::Exact)
+			return std::sin(x);
+		else
+			return fastMathSinReduced<A>(fastMathReduceAngle(x));
+	}
+
+	template<MathAccuracy A = MathAccuracy::Fast> inline float fastCos(float x) {
+		if constexpr (A == MathAccuracy::Exact)
+			return std::cos(x);
+		else
+			return fastMathSinReduced<A>(HALF_PI - absolute(fastMathReduceAngle(x)));
+	}
+
+	template<MathAccuracy A = MathAccuracy::Fast> inline float fastExp2(float x) {
+		if constexpr (A == MathAccuracy::Exact) {
+			return std::exp2(x);
+		} else {
+			x = clampTo(x, -126.0f, 127.0f);
+			float k = fastMathRound(x);
+			return fastMathExpReduced<A>((x - k) * 0.69314718f) * fastMathPow2(k);
+		}
+	}
+
+	template<MathAccuracy A = MathAccuracy::Fast> inline float fastExp(float x) {
+		if constexpr (A == MathAccuracy::Exact) {
+			return std::exp(x);
+		} else {
+			// e^x = 2^k * e^r, ln(2) is split in two so r keeps its precision
+			x = clampTo(x, -87.0f, 88.0f);
+			float k = fastMathRound(x * 1.44269504f);
+			float r = (x - k * 0.693145751953125f) - k * 1.428606765330187e-6f;
+			return fastMathExpReduced<A>(r) * fastMathPow2(k);
+		}
+	}
+
+	// x must be positive
+	template<MathAccuracy A = MathAccuracy::Fast> inline float fastLog2(float x) {
+		if constexpr (A == MathAccuracy::Exact) {
+			return std::log2(x);
+		} else {
+			// x = m * 2^e with m in [sqrt(0.5), sqrt(2)), log(m) from the series of atanh((m - 1) / (m + 1))
+			uint32_t bits = std::bit_cast<uint32_t>(x);
+			float m = std::bit_cast<float>((bits & 0x007fffffu) | 0x3f800000u);
+			float e = float(int((bits >> 23) & 255u) - 127);
+
+			float big = (m > 1.41421356f) ? 1.0f : 0.0f;
+			m *= 1.0f - 0.5f * big;
+			e += big;
+
+			float s = (m - 1.0f) / (m + 1.0f);
+			float s2 = s * s;
+
+			float ln;
+			if constexpr (A == MathAccuracy::Fast)
+				ln = 2.0f * s * (1.0f + s2 * (1.0f / 3.0f));
+			else
+				ln = 2.0f * s * (1.0f + s2 * (1.0f / 3.0f + s2 * (1.0f / 5.0f + s2 * (1.0f / 7.0f + s2 * (1.0f / 9.0f)))));
+
+			return e + ln * 1.44269504f;
+		}
+	}
+
+	// x must not be negative, x * x or absolute(x) keep the old results of a negative base with even exponents
+	template<MathAccuracy A = MathAccuracy::Fast> inline float fastPow(float x, float y) {
+		if constexpr (A == MathAccuracy::Exact) {
+			return std::pow(x, y);
+		} else {
+			float r = fastExp2<A>(y * fastLog2<A>(maximum(x, 1e-30f)));
+			return (x > 0.0f) ? r : 0.0f;
+		}
+	}
+
+	template<MathAccuracy A = MathAccuracy::Fast> inline float fastCbrt(float x) {
+		if constexpr (A == MathAccuracy::Exact) {
+			return std::cbrt(x);
+		} else {
+			// exponent divided by 3 in the bits, then newton steps
+			float a = maximum(absolute(x), 1e-30f);
+			float y = std::bit_cast<float>(std::bit_cast<uint32_t>(a) / 3u + 709921077u);
+
+			constexpr int Steps = (A == MathAccuracy::Fast) ? 1 : 3;
+			for (int i = 0; i != Steps; ++i)
+				y = (2.0f * y + a / (y * y)) * (1.0f / 3.0f);
+
+			y = (absolute(x) > 1e-30f) ? y : 0.0f;
+			return (x < 0.0f) ? -y : y;
+		}
+	}
+
+	template<MathAccuracy A = MathAccuracy::Fast> inline float fastAtan2(float y, float x) {
+		if constexpr (A == MathAccuracy::Exact) {
+			return std::atan2(y, x);
+		} else {
+			// atan of the ratio in [0, 1], then moved to the octant of (x, y)
+			float ax = absolute(x);
+			float ay = absolute(y);
+			float a = minimum(ax, ay) / maximum(maximum(ax, ay), 1e-30f);
+
+			float r;
+			if constexpr (A == MathAccuracy::Fast) {
+				r = QUARTER_PI * a - a * (a - 1.0f) * (0.2447f + 0.0663f * a);
+			} else {
+				// atan(a) = PI/4 + atan((a - 1) / (a + 1)) keeps the series argument below tan(PI/8)
+				bool big = a > 0.41421356f;
+				float t = big ? (a - 1.0f) / (a + 1.0f) : a;
+				float s = t * t;
+				r = t * (1.0f + s * (-1.0f / 3.0f + s * (1.0f / 5.0f + s * (-1.0f / 7.0f + s * (1.0f / 9.0f + s * (-1.0f / 11.0f + s * (1.0f / 13.0f + s * (-1.0f / 15.0f))))))));
+				r += big ? QUARTER_PI : 0.0f;
+			}
+
+			r = (ay > ax) ? HALF_PI - r : r;
+			r = (x < 0.0f) ? PI - r : r;
+			return (y < 0.0f) ? -r : r;
+		}
+	}
+
+	template<MathAccuracy A = MathAccuracy::Fast> inline void fastSin(float const* x, float* out, int count) { for (int i = 0; i < count; ++i) out[i] = fastSin<A>(x[i]); }
+	template<MathAccuracy A = MathAccuracy::Fast> inline void fastCos(float const* x, float* out, int count) { for (int i = 0; i < count; ++i) out[i] = fastCos<A>(x[i]); }
+	template<MathAccuracy A = MathAccuracy::Fast> inline void fastExp(float const* x, float* out, int count) { for (int i = 0; i < count; ++i) out[i] = fastExp<A>(x[i]); }
+	template<MathAccuracy A = MathAccuracy::Fast> inline void fastCbrt(float const* x, float* out, int count) { for (int i = 0; i < count; ++i) out[i] = fastCbrt<A>(x[i]); }
+	template<MathAccuracy A = MathAccuracy::Fast> inline void fastPow(float const* x, float y, float* out, int count) { for (int i = 0; i < count; ++i) out[i] = fastPow<A>(x[i], y); }
+	template<MathAccuracy A = MathAccuracy::Fast> inline void fastAtan2(float const* y, float const* x, float* out, int count) { for (int i = 0; i < count; ++i) out[i] = fastAtan2<A>(y[i], x[i]); }
+
+	// prints the worst error of every function and tier against the standard library, false when one is over its bound
+	bool checkFastMath();
+
+
+	//
+	// Random
+	//
+
+	// xoshiro128+, small and fast, not thread safe, give each thread its own
+	class RandomGenerator
+	{
+		public:
+            explicit RandomGenerator(uint32_t seed = 0);
+
+            void seed(uint32_t seed);
+
+            uint32_t next();
+            float uniform();                                // [0.0, 1.0)
+            float uniformRange(float minv, float maxv);
+		private:
+            uint32_t m_state[4];
+	};
+
+	// seeds the generator of every thread, each thread mixes in its own id so the streams differ
+	void seedRandom(uint32_t seed);
+	uint32_t randomSeed();
+
+	// random number between 0.0 and 1.0 from the calling thread generator
 	float uniformRandom();
 	float uniformRandomRange(float minv, float maxv);
 
+	// lowbias32 integer hash
+	inline uint32_t hashMix(uint32_t x) {
+		x ^= x >> 16;
+		x *= 0x7feb352du;
+		x ^= x >> 15;
+		x *= 0x846ca68bu;
+		x ^= x >> 16;
+		return x;
+	}
+
+	inline uint32_t hashKey(uint32_t seed, uint32_t frame) { return hashMix(seed + frame * 0x9e3779b9u); }
+	inline float hashToUniform(uint32_t hash) { return float(int32_t(hash >> 8)) * (1.0f / 16777216.0f); }
+
+	// counter based random, the value only depends on the inputs, so pins can be evaluated in any order or on any thread
+	inline uint32_t hashRandom(uint32_t seed, uint32_t index, uint32_t frame) { return hashMix(index ^ hashKey(seed, frame)); }
+	inline float hashUniform(uint32_t seed, uint32_t index, uint32_t frame) { return hashToUniform(hashRandom(seed, index, frame)); }
+
+	// hashUniform for count consecutive indices, written so the compiler vectorizes it
+	void hashUniformFill(uint32_t seed, uint32_t first_index, uint32_t frame, float* values, int count);
+
 
 	//
 	// containers
@@ -142,9 +358,12 @@ namespace pw {
 	FileType fileType(std::string const& filename);
 	bool fileSize(std::string const& filename);
 	bool fileExists(std::string const& filename);
+	bool fileModificationTime(std::string const& filename, int64_t& time); // opaque, only good for comparisons
 	bool deleteFile(std::string const& filename);
 	bool copyFolder(std::string const& src, std::string const& dst);
 	std::string executablePath();
+	int processId();
+	int threadId();		// os id of the calling thread, 0 where there is none
 
 	std::string getFirstFolder(std::string const& filename);
 	std::string getFilePath(std::string const& filename);
@@ -169,6 +388,14 @@ namespace pw {
 	bool saveCppBinary(uint8_t* data, size_t size, std::string filename);
 
 
+	//
+	// Dynamic libraries
+	//
+	void* openLibrary(std::string const& filename, std::string& error);
+	void* librarySymbol(void* library, std::string const& name);
+	void closeLibrary(void* library);
+
+
 	//
 	// Enum
 	//
@@ -34,24 +34,11 @@ namespace pw
 	}
 
 	void Menu::setup(MetaShaderContext& meta_shader_context) {
-		m_available_shaders = meta_shader_context.shaders;
-
-		m_selected_animation_string.clear();
-		for (auto& current : m_available_shaders) {
-			if (!m_selected_animation_string.empty())
-				m_selected_animation_string += ";";
-			m_selected_animation_string += current.name;
-		}
+		updateShaders(meta_shader_context);
 
 		if (!m_started) {
 			addShaderAction(m_selected_animation_active);
 			addSizeAction(m_size_active);
-		} else {
-
-			m_selected_animation_active = 0;
-			for (size_t i = 0; i != m_available_shaders.size(); ++i) 
-				if (m_available_shaders[i].name == meta_shader_context.shader.name) 
-					m_selected_animation_active = int(i);	
 		}
 		 
 		m_menu_key = KEY_M;
@@ -68,12 +55,46 @@ namespace pw
         m_previous_shader_key = KEY_LEFT;
         m_previous_shader_fast_key = KEY_UP;
 
+		m_profiler_key = KEY_P;
+		m_profiler_dump_key = KEY_O;
+		m_trace_key = KEY_T;
+		m_resolution_key = KEY_R;
+		m_keyframes_key = KEY_K;
+		m_detail_key = KEY_L;
+		m_canvas_key = KEY_TAB;
+
 
 		show(true);
 		TraceLog(LOG_INFO, "Press '%c' for control options", m_menu_key);
 		m_started = true;
 	}
 
+	void Menu::updateShaders(MetaShaderContext& meta_shader_context) {
+		m_available_shaders = meta_shader_context.shaders;
+
+		m_selected_animation_string.clear();
+		for (auto& current : m_available_shaders) {
+			if (!m_selected_animation_string.empty())
+				m_selected_animation_string += ";";
+			m_selected_animation_string += current.name;
+		}
+
+		if (m_started) {
+			m_selected_animation_active = 0;
+			for (size_t i = 0; i != m_available_shaders.size(); ++i) 
+				if (m_available_shaders[i].name == meta_shader_context.shader.name) 
+					m_selected_animation_active = int(i);	
+		}
+	}
+
+	void Menu::focusCanvas(MetaShaderContext& meta_shader_context, int divisor) {
+		updateShaders(meta_shader_context);
+
+		m_size_active = 0;
+		while ((1 << m_size_active) < divisor && m_size_active < 3)
+			++m_size_active;
+	}
+
 	bool Menu::animationRunning() {
 		return m_animation_running;
 	}
@@ -101,6 +122,14 @@ namespace pw
 		else if (IsKeyPressed(m_previous_shader_key)) addNextShaderAction(-1);
 		else if (IsKeyPressed(m_previous_shader_fast_key)) addNextShaderAction(-5);
 
+		if (IsKeyPressed(m_profiler_key)) m_actions.push_back({ MenuActionKind::ToggleProfiler });
+		if (IsKeyPressed(m_profiler_dump_key)) m_actions.push_back({ MenuActionKind::DumpProfiler });
+		if (IsKeyPressed(m_trace_key)) m_actions.push_back({ MenuActionKind::ToggleTrace });
+		if (IsKeyPressed(m_resolution_key)) m_actions.push_back({ MenuActionKind::ToggleAdaptiveResolution });
+		if (IsKeyPressed(m_keyframes_key)) m_actions.push_back({ MenuActionKind::ToggleKeyframes });
+		if (IsKeyPressed(m_detail_key)) m_actions.push_back({ MenuActionKind::ToggleCameraDetail });
+		if (IsKeyPressed(m_canvas_key)) m_actions.push_back({ MenuActionKind::NextCanvas });
+
 
 		std::string animation_text = "";
 		for (auto& current : m_available_shaders) {
@@ -12,7 +12,14 @@ namespace pw {
         ShaderChange,
         SizeChange,
         RestartAnimation,
-        ReloadShaders
+        ReloadShaders,
+        ToggleProfiler,
+        DumpProfiler,
+        ToggleTrace,
+        ToggleAdaptiveResolution,
+        ToggleKeyframes,
+        ToggleCameraDetail,
+        NextCanvas
     };
 
     struct MenuAction {
@@ -29,6 +36,8 @@ namespace pw {
             ~Menu();
 
             void setup(MetaShaderContext& meta_shader_context);
+            void updateShaders(MetaShaderContext& meta_shader_context);    // refresh the shaders list without showing the menu
+            void focusCanvas(MetaShaderContext& meta_shader_context, int divisor);     // shows the shader and size of the canvas the actions go to
             void render();
             void shutdown();
 
@@ -59,6 +68,13 @@ namespace pw {
             int m_next_shader_fast_key = 0;
             int m_previous_shader_key = 0;
             int m_previous_shader_fast_key = 0;
+            int m_profiler_key = 0;
+            int m_profiler_dump_key = 0;
+            int m_trace_key = 0;
+            int m_resolution_key = 0;
+            int m_keyframes_key = 0;
+            int m_detail_key = 0;
+            int m_canvas_key = 0;
 
 
             bool m_window_controls_active = true;
@@ -7,17 +7,61 @@
 namespace pw {
 
     struct MetaShaderContext;
+    struct MetaShaderLoading;
 
     struct MetaShaderPy;
+    struct MetaShaderPwx;
+    struct MetaShaderPlugin;
     struct MetaShaderCpp;
     struct MetaShaderGif;
     struct MetaShaderWater;
+    struct MetaShaderNoise;
+    struct MetaShaderStencil;
+    struct MetaShaderComposition;
+    struct MetaShaderStream;
 
     typedef float(*MetaShaderFunction)(MetaShaderContext&, int const, Vector2 const&, float const);
 
+    // evaluates the pins [x_begin, x_end) of row y in one call, row points to the first pin of the row
+    typedef void(*MetaShaderBatchFunction)(MetaShaderContext&, int const y, int const x_begin, int const x_end, float* const row);
+
+    // pins around a block, reach of a stencil shader
+    constexpr int StencilRadius = 1;
+
+    // a block of the last two steps of a stencil shader, with StencilRadius pins of halo on every side.
+    // rows are stride floats apart, current[-1] and current[-stride] are the halo left and above the first pin
+    struct StencilBlock {
+        float const* current;
+        float const* previous;
+        int stride;
+        int x, y;                           // canvas position of the first pin
+        int width, height;                  // pins to write
+        int canvas_width, canvas_height;
+        uint32_t step;                      // steps since the simulation started
+    };
+
+    // writes the next step of the block, rows of next are next_stride floats apart.
+    // step 0 writes the initial state, current and previous hold the pins on screen then and the result is at rest
+    typedef void(*MetaShaderStencilFunction)(MetaShaderContext&, StencilBlock const& block, float* const next, int const next_stride);
+
+    // pins [x_begin, x_end) x [y_begin, y_end) of the canvas
+    struct PinRegion {
+        int x_begin, y_begin;
+        int x_end, y_end;
+    };
+
+    // appends the regions that may hold non-zero pins this frame, called after updateContextState.
+    // the regions are conservative, every pin outside them is 0
+    typedef void(*MetaShaderBoundsFunction)(MetaShaderContext&, int const canvas_width, int const canvas_height, std::vector<PinRegion>& regions);
+
     struct MetaShaderInfo {
         std::string name;
         MetaShaderFunction function;
+        MetaShaderBatchFunction batch = nullptr;    // optional, used instead of function when available
+        bool parallel = false;                      // batch only reads the context, tiles can run on several threads
+        MetaShaderStencilFunction stencil = nullptr; // optional, steps a simulation from the previous steps, used instead of function and batch
+        MetaShaderBoundsFunction bounds = nullptr;  // optional, the tiles outside the bounds are cleared instead of evaluated
+        bool feedback = false;                      // reads pin_value, the rows skipped at a lower detail keep their pins instead of being interpolated
     };
     using MetaShadersInfo = std::vector<MetaShaderInfo>;
 
@@ -27,21 +71,103 @@ namespace pw {
 
         std::shared_ptr<MetaShaderGif> gif;     // gif context
         std::shared_ptr<MetaShaderPy> py;       // python context 
+        std::shared_ptr<MetaShaderPwx> pwx;     // expression language context
+        std::shared_ptr<MetaShaderPlugin> plugin; // native plugins context
         std::shared_ptr<MetaShaderWater> wtr;   // native context
         std::shared_ptr<MetaShaderCpp> cpp;     // native context
+        std::shared_ptr<MetaShaderNoise> noise; // native context
+        std::shared_ptr<MetaShaderStencil> stencil; // simulation fields
+        std::shared_ptr<MetaShaderComposition> composition; // shaders made of other shaders
+        std::shared_ptr<MetaShaderStream> stream; // pin frames of another process
+
+        std::shared_ptr<MetaShaderLoading> loading; // kinds still loading in the background
     };
 
-    std::vector<std::string> platformShadersFiles(std::string const& kind);
+    // swaps a shader that was rebuilt off the main thread into the context, returns true when the shaders list was updated
+    using MetaShaderSwap = std::function<bool(MetaShaderContext&)>;
+
+    // updates or adds the named shader in the shaders list, and the active shader when it is the one being replaced
+    void replaceMetaShader(MetaShaderContext& context, MetaShaderInfo const& info);
+
+    // removes the named shader, the first shader becomes active if it was the active one
+    bool removeMetaShader(MetaShaderContext& context, std::string const& name);
+
+    // folders that may hold kind shaders
+    std::vector<std::string> platformShadersFolders(std::string const& kind);
+
+    // files in the kind folder, with the kind extension unless another extension is given
+    std::vector<std::string> platformShadersFiles(std::string const& kind, std::string const& extension = "");
+
+    // loads every shader kind concurrently on the job system, returns once the default shader is ready.
+    // unless wait is set the other kinds are still loading and are merged in by finishMetaShaders
+    void setupMetaShaders(MetaShaderContext& context, bool wait = true);
 
-    void setupMetaShaders(MetaShaderContext& context);
+    // merges the kinds that loaded in the background, returns true when the shaders list was updated
+    bool finishMetaShaders(MetaShaderContext& context);
+
+    // points the context of a canvas at the shaders of source, the scripts, plugins, graphs and decoded gifs are shared by every canvas.
+    // the per frame state is the canvas own, so canvases update and evaluate without waiting on each other.
+    // the active shader is kept, or is the first one when source doesn't have it
+    void shareMetaShaderContext(MetaShaderContext& context, MetaShaderContext const& source);
     void updateContextState(MetaShaderContext& context, int canvas_width, int canvas_height, float time);
 
+    // the kinds part of updateContextState, for a context whose active shader isn't the one on screen
+    void updateKindContextState(MetaShaderContext& context, int canvas_width, int canvas_height, float time);
+
     void setupPyMetaShaders(MetaShaderContext& context);
     void updatePyContextState(MetaShaderContext& context, int canvas_width, int canvas_height, float time);
+    MetaShaderSwap preparePyMetaShader(std::string const& filepath);
+    void sharePyContext(MetaShaderContext& context, MetaShaderContext const& source);
+
+    void setupPwxMetaShaders(MetaShaderContext& context);
+    void updatePwxContextState(MetaShaderContext& context, int canvas_width, int canvas_height, float time);
+    MetaShaderSwap preparePwxMetaShader(std::string const& filepath);
+    void sharePwxContext(MetaShaderContext& context, MetaShaderContext const& source);
+
+    void setupPluginMetaShaders(MetaShaderContext& context);
+    void updatePluginContextState(MetaShaderContext& context, int canvas_width, int canvas_height, float time);
+    void sharePluginContext(MetaShaderContext& context, MetaShaderContext const& source);
+
+    // true when a plugin library was rebuilt and has settled, reloadPluginMetaShaders then swaps it in once no canvas runs
+    bool pluginMetaShadersChanged(MetaShaderContext& context);
+    void reloadPluginMetaShaders(MetaShaderContext& context);
 
     void setupGifMetaShaders(MetaShaderContext& context);
     void updateGifContextState(MetaShaderContext& context, int canvas_width, int canvas_height, float time);
+    MetaShaderSwap prepareGifMetaShader(std::string const& filepath);
+    void shareGifContext(MetaShaderContext& context, MetaShaderContext const& source);
+    bool isGifShader(MetaShaderInfo const& info);
+
+    void setupNoiseMetaShaders(MetaShaderContext& context);
+    void updateNoiseContextState(MetaShaderContext& context, int canvas_width, int canvas_height, float time);
+    void shareNoiseContext(MetaShaderContext& context, MetaShaderContext const& source);
+
+    void setupCompositionMetaShaders(MetaShaderContext& context);
+    MetaShaderSwap prepareCompositionMetaShader(std::string const& filepath);
+
+    // updates the kinds of every shader in the active composition, false when the active shader isn't a composition
+    bool updateCompositionContextState(MetaShaderContext& context, int canvas_width, int canvas_height, float time);
+    void shareCompositionContext(MetaShaderContext& context, MetaShaderContext const& source);
+
+    // runs the compositions mixing a gif with shaders of other kinds for a few frames and a multiply of negative values,
+    // false when a gif node or an output stays flat or the multiply is out of its range
+    bool checkCompositions();
+
+    void setupStreamMetaShaders(MetaShaderContext& context);
+    void updateStreamContextState(MetaShaderContext& context, int canvas_width, int canvas_height, float time);
+    void shareStreamContext(MetaShaderContext& context, MetaShaderContext const& source);
+
+    void setupStencilMetaShaders(MetaShaderContext& context);
+    void shareStencilContext(MetaShaderContext& context, MetaShaderContext const& source);
+
+    // steps the active stencil shader over the canvas on the job system and writes the new step to pins.
+    // the simulation starts over when the stencil shader or the canvas size changes, its step 0 writes the initial state
+    void evaluateStencilMetaShader(MetaShaderContext& context, float* pins, int canvas_width, int canvas_height);
+
+    // logs the cost per pin of hand-written c++ shaders and the same shaders written with combinators
+    void benchmarkCombinators();
 
     void setupWaterMetaShaders(MetaShaderContext& context);
     void updateWaterContextState(MetaShaderContext& context, int canvas_width, int canvas_height, float time);
+    void shareWaterContext(MetaShaderContext& context, MetaShaderContext const& source);
 }
\ No newline at end of file
@@ -0,0 +1,564 @@
+#include "MetaShader.hpp"
+#include "Text.hpp"
+
+//
+// composition meta shaders
+// Other shaders combined into one, described one node per line in a .comp file.
+//
+//   # water with the ghost gif inside a ring
+//   water = shader Water
+//   ghost = shader gif_ghost
+//   ring = shader Circle
+//   window = remap ring -1.0 1.0
+//   inside = mask ghost window
+//   max water inside
+//
+// Nodes: shader <name>, blend <a> <b> <weight>, max <a> <b>, multiply <a> <b>, mask <a> <mask>, remap <a> <low> <high>.
+// A node only uses nodes defined before it and the last line is the pin height.
+// Every node runs over a chunk of a row before the next one, so the chunk stays in cache,
+// and the source of a mask isn't evaluated where the mask is zero or less for the whole chunk, nor a multiply where the other side is zero.
+// Every gif node plays its own gif, the decoded frames are shared with the canvases that show the same file.
+//
+
+namespace pw {
+
+    // pins evaluated by every node before moving on to the next chunk
+    constexpr int CompositionChunk = 64;
+
+    enum class CompositionOp : uint8_t {
+        Shader,
+        Blend,
+        Max,
+        Multiply,
+        Mask,
+        Remap,
+    };
+
+    struct CompositionNode {
+        CompositionOp op = CompositionOp::Shader;
+        std::string shader;         // shader name, for Shader nodes
+        int a = -1;                 // input nodes
+        int b = -1;
+        float p0 = 0.0f;            // blend weight, remap range
+        float p1 = 0.0f;
+    };
+
+    struct CompositionGraph {
+        std::string file;
+        std::vector<CompositionNode> nodes;         // the last one is the output
+    };
+
+    // the parsed graphs, shared by every canvas
+    struct CompositionLibrary {
+        std::map<std::string, CompositionGraph> graphs;
+    };
+
+    struct MetaShaderComposition {
+        std::shared_ptr<CompositionLibrary> library;
+        int canvas_width = 0;
+
+        // context of every Shader node of a graph, with the node shader active. refreshed every frame but the gif a node plays
+        std::map<std::string, std::vector<MetaShaderContext>> sources;
+    };
+
+    // per thread scratch, a chunk of every node and a row to run batch shaders on
+    struct CompositionScratch {
+        std::vector<float> values;
+        std::vector<uint8_t> done;
+        std::vector<float> row;
+    };
+
+    static bool isCompositionShader(MetaShaderInfo const& info);
+
+    //
+    // Evaluation
+    //
+    static float* evaluateNode(CompositionGraph const& graph, std::vector<MetaShaderContext>& sources, CompositionScratch& scratch, int node_index, int y, int x_begin, int count, float const* pins, int canvas_width) {
+        float* out = scratch.values.data() + node_index * CompositionChunk;
+        if (scratch.done[node_index])
+            return out;
+        scratch.done[node_index] = 1;
+
+        CompositionNode const& node = graph.nodes[node_index];
+
+        auto input = [&](int index) {
+            return evaluateNode(graph, sources, scratch, index, y, x_begin, count, pins, canvas_width);
+        };
+
+        // all zero, the other side of the node doesn't matter. a mask clamps its negative values to zero
+        auto zero = [count](float const* values, bool clamped) {
+            for (int i = 0; i != count; ++i)
+                if (clamped ? values[i] > 0.0f : values[i] != 0.0f)
+                    return false;
+            return true;
+        };
+
+        switch (node.op) {
+            case CompositionOp::Shader: {
+                MetaShaderContext& source = sources[node_index];
+                MetaShaderInfo const& info = source.shader;
+
+                if (info.batch) {
+                    // the shader sees the pins as they are, like when it runs alone
+                    float* row = scratch.row.data();
+                    std::copy(pins + x_begin, pins + x_begin + count, row + x_begin);
+                    info.batch(source, y, x_begin, x_begin + count, row);
+                    std::copy(row + x_begin, row + x_begin + count, out);
+                } else if (info.function) {
+                    Vector2 pin;
+                    pin.y = float(y);
+                    for (int i = 0; i != count; ++i) {
+                        int x = x_begin + i;
+                        pin.x = float(x);
+                        out[i] = info.function(source, y * canvas_width + x, pin, pins[x]);
+                    }
+                } else {
+                    std::fill(out, out + count, 0.0f);
+                }
+                break;
+            }
+            case CompositionOp::Blend: {
+                float const* a = input(node.a);
+                float const* b = input(node.b);
+                for (int i = 0; i != count; ++i)
+                    out[i] = a[i] + (b[i] - a[i]) * node.p0;
+                break;
+            }
+            case CompositionOp::Max: {
+                float const* a = input(node.a);
+                float const* b = input(node.b);
+                for (int i = 0; i != count; ++i)
+                    out[i] = maximum(a[i], b[i]);
+                break;
+            }
+            case CompositionOp::Multiply:
+            case CompositionOp::Mask: {
+                float const* b = input(node.b);
+                if (zero(b, node.op == CompositionOp::Mask)) {
+                    std::fill(out, out + count, 0.0f);
+                    break;
+                }
+
+                float const* a = input(node.a);
+                if (node.op == CompositionOp::Mask) {
+                    for (int i = 0; i != count; ++i)
+                        out[i] = a[i] * clampTo(b[i], 0.0f, 1.0f);
+                } else {
+                    for (int i = 0; i != count; ++i)
+                        out[i] = a[i] * b[i];
+                }
+                break;
+            }
+            case CompositionOp::Remap: {
+                float const* a = input(node.a);
+                for (int i = 0; i != count; ++i)
+                    out[i] = node.p0 + a[i] * (node.p1 - node.p0);
+                break;
+            }
+        }
+
+        return out;
+    }
+
+    static void compositionBatch(MetaShaderContext& msc, int const y, int const x_begin, int const x_end, float* const row) {
+        MetaShaderComposition& composition = *msc.composition;
+        auto found = composition.library->graphs.find(msc.shader.name);
+        if (found == composition.library->graphs.end())
+            return;
+
+        CompositionGraph const& graph = found->second;
+        int const nodes = int(graph.nodes.size());
+
+        // the sources are sized by the update of the canvas
+        auto sources = composition.sources.find(msc.shader.name);
+        if (sources == composition.sources.end() || int(sources->second.size()) != nodes)
+            return;
+        int const canvas_width = composition.canvas_width;
+
+        static thread_local CompositionScratch scratch;
+        scratch.values.resize(size_t(nodes) * CompositionChunk);
+        scratch.done.resize(nodes);
+        scratch.row.resize(canvas_width);
+
+        for (int start = x_begin; start < x_end; start += CompositionChunk) {
+            int count = minimum(CompositionChunk, x_end - start);
+            std::fill(scratch.done.begin(), scratch.done.end(), uint8_t(0));
+
+            float const* out = evaluateNode(graph, sources->second, scratch, nodes - 1, y, start, count, row, canvas_width);
+            std::copy(out, out + count, row + start);
+        }
+    }
+
+    static float compositionPin(MetaShaderContext& msc, int const, Vector2 const& pin_pos, float const pin_value) {
+        int const canvas_width = msc.composition->canvas_width;
+        int const x = int(pin_pos.x);
+
+        // a row holding the pin alone, the other pins are never read
+        static thread_local std::vector<float> row;
+        row.resize(canvas_width);
+        row[x] = pin_value;
+
+        compositionBatch(msc, int(pin_pos.y), x, x + 1, row.data());
+        return row[x];
+    }
+
+    static bool isCompositionShader(MetaShaderInfo const& info) {
+        return info.batch == compositionBatch;
+    }
+
+    //
+    // Parser
+    //
+    static bool parseComposition(std::string const& source, CompositionGraph& graph, std::string& error) {
+        std::map<std::string, int> names;
+
+        auto node = [&names](std::string const& name, int& index) {
+            auto found = names.find(name);
+            if (found == names.end())
+                return false;
+            index = found->second;
+            return true;
+        };
+
+        auto number = [](std::string const& text, float& value) {
+            if (!isNumber(text))
+                return false;
+            value = lexical_cast<float>(text, 0.0f);
+            return true;
+        };
+
+        int line_number = 0;
+        for (auto line : split(source, "\n")) {
+            ++line_number;
+
+            auto comment = line.find('#');
+            if (comment != std::string::npos)
+                line.erase(comment);
+            trim(line);
+            if (line.empty())
+                continue;
+
+            std::string name;
+            auto equals = line.find('=');
+            if (equals != std::string::npos) {
+                name = line.substr(0, equals);
+                line = line.substr(equals + 1);
+                trim(name);
+                trim(line);
+            }
+
+            std::vector<std::string> tokens;
+            for (auto const& token : split(line, " "))
+                if (!token.empty())
+                    tokens.push_back(token);
+
+            if (tokens.empty()) {
+                error = sfmt("line %d: missing node", line_number);
+                return false;
+            }
+
+            CompositionNode n;
+            std::string const& op = tokens[0];
+            bool valid = false;
+
+            if (op == "shader") {
+                n.op = CompositionOp::Shader;
+                n.shader = line.substr(op.size());
+                trim(n.shader);
+                valid = !n.shader.empty();
+            } else if (op == "blend") {
+                n.op = CompositionOp::Blend;
+                valid = tokens.size() == 4 && node(tokens[1], n.a) && node(tokens[2], n.b) && number(tokens[3], n.p0);
+            } else if (op == "max" || op == "multiply" || op == "mask") {
+                n.op = (op == "max") ? CompositionOp::Max : (op == "multiply") ? CompositionOp::Multiply : CompositionOp::Mask;
+                valid = tokens.size() == 3 && node(tokens[1], n.a) && node(tokens[2], n.b);
+            } else if (op == "remap") {
+                n.op = CompositionOp::Remap;
+                valid = tokens.size() == 4 && node(tokens[1], n.a) && number(tokens[2], n.p0) && number(tokens[3], n.p1);
+            } else {
+                error = sfmt("line %d: unknown node '%s'", line_number, op);
+                return false;
+            }
+
+            if (!valid) {
+                error = sfmt("line %d: bad '%s' node, inputs must be defined before", line_number, op);
+                return false;
+            }
+
+            if (!name.empty())
+                names[name] = int(graph.nodes.size());
+            graph.nodes.push_back(n);
+        }
+
+        if (graph.nodes.empty()) {
+            error = "no nodes";
+            return false;
+        }
+
+        return true;
+    }
+
+    static bool compileComposition(std::string const& filepath, CompositionGraph& graph) {
+        std::string source;
+        if (!readRawText(filepath, source)) {
+            TraceLog(LOG_ERROR, "%s > unable to read", graph.file.c_str());
+            return false;
+        }
+
+        std::string error;
+        if (!parseComposition(source, graph, error)) {
+            TraceLog(LOG_ERROR, "%s > %s", graph.file.c_str(), error.c_str());
+            return false;
+        }
+
+        TraceLog(LOG_DEBUG, "%s > %d nodes", graph.file.c_str(), int(graph.nodes.size()));
+        return true;
+    }
+
+    //
+    // composition Meta shaders
+    //
+    void setupCompositionMetaShaders(MetaShaderContext& context) {
+        context.composition = std::make_shared<MetaShaderComposition>();
+        context.composition->library = std::make_shared<CompositionLibrary>();
+
+        for (auto const& filepath : platformShadersFiles("comp")) {
+            std::string file = getSimpleFileName(filepath);
+            std::string name = getNameLessExtension(file);
+
+            CompositionGraph graph;
+            graph.file = file;
+            if (!compileComposition(filepath, graph))
+                continue;
+
+            context.composition->library->graphs[name] = std::move(graph);
+            context.shaders.push_back({ name, compositionPin, compositionBatch });
+        }
+    }
+
+    MetaShaderSwap prepareCompositionMetaShader(std::string const& filepath) {
+        std::string file = getSimpleFileName(filepath);
+        std::string name = getNameLessExtension(file);
+
+        if (fileType(filepath) != FileType::FileRegular) {
+            return [name](MetaShaderContext& context) {
+                context.composition->library->graphs.erase(name);
+                return removeMetaShader(context, name);
+            };
+        }
+
+        auto graph = std::make_shared<CompositionGraph>();
+        graph->file = file;
+        if (!compileComposition(filepath, *graph))
+            graph.reset();
+
+        return [name, graph](MetaShaderContext& context) {
+            // keep the running version if the new one doesn't parse
+            if (!graph)
+                return false;
+
+            context.composition->library->graphs[name] = std::move(*graph);
+            replaceMetaShader(context, { name, compositionPin, compositionBatch });
+            return true;
+        };
+    }
+
+    bool updateCompositionContextState(MetaShaderContext& context, int canvas_width, int canvas_height, float time) {
+        if (!context.composition || !isCompositionShader(context.shader))
+            return false;
+
+        MetaShaderComposition& composition = *context.composition;
+        composition.canvas_width = canvas_width;
+
+        auto found = composition.library->graphs.find(context.shader.name);
+        if (found == composition.library->graphs.end())
+            return true;
+
+        CompositionGraph const& graph = found->second;
+        std::vector<MetaShaderContext>& sources = composition.sources[context.shader.name];
+        sources.resize(graph.nodes.size());
+
+        // the gif of the canvas is released like for any other shader, the gif nodes play their own
+        if (context.gif)
+            updateGifContextState(context, canvas_width, canvas_height, time);
+
+        // tiles run on several threads when every source can, and keep their skipped rows when a source reads its pins
+        bool parallel = true;
+        bool feedback = false;
+
+        for (size_t i = 0; i != graph.nodes.size(); ++i) {
+            CompositionNode const& node = graph.nodes[i];
+            if (node.op != CompositionOp::Shader)
+                continue;
+
+            // shaders are looked up every frame, they may load later or be reloaded
+            MetaShaderContext& source = sources[i];
+            std::shared_ptr<MetaShaderGif> gif = std::move(source.gif);
+            source = MetaShaderContext();
+            source.py = context.py;
+            source.pwx = context.pwx;
+            source.plugin = context.plugin;
+            source.wtr = context.wtr;
+            source.cpp = context.cpp;
+            source.noise = context.noise;
+            source.stencil = context.stencil;
+            source.stream = context.stream;
+            source.composition = context.composition;
+
+            auto shader = std::find_if(context.shaders.begin(), context.shaders.end(), [&node](auto const& current) { return current.name == node.shader; });
+
+            // simulations and other compositions don't nest
+            if (shader == context.shaders.end() || shader->stencil || isCompositionShader(*shader)) {
+                source.shader = { node.shader, nullptr };
+                continue;
+            }
+
+            source.shader = *shader;
+            parallel = parallel && shader->batch && shader->parallel;
+            feedback = feedback || shader->feedback;
+
+            // a gif node updates its gif alone, the other nodes don't see it so they can't clear its frames
+            if (isGifShader(*shader)) {
+                source.gif = gif;
+                shareGifContext(source, context);
+                updateGifContextState(source, canvas_width, canvas_height, time);
+            } else {
+                updateKindContextState(source, canvas_width, canvas_height, time);
+            }
+        }
+
+        context.shader.parallel = parallel;
+        context.shader.feedback = feedback;
+        return true;
+    }
+
+    void shareCompositionContext(MetaShaderContext& context, MetaShaderContext const& source) {
+        if (!source.composition) {
+            context.composition.reset();
+            return;
+        }
+
+        // the node contexts of a canvas are its own
+        if (context.composition && context.composition != source.composition && context.composition->library == source.composition->library)
+            return;
+
+        context.composition = std::make_shared<MetaShaderComposition>();
+        context.composition->library = source.composition->library;
+    }
+
+    //
+    // Check
+    //
+    bool checkCompositions() {
+        constexpr int Width = 160;
+        constexpr int Height = 90;
+        constexpr int Frames = 10;
+        constexpr float FrameTime = 1.0f / 30.0f;
+
+        MetaShaderContext context;
+        setupMetaShaders(context);
+        if (!context.composition || !context.gif) {
+            TraceLog(LOG_ERROR, "Compositions > no composition or gif shaders loaded");
+            return false;
+        }
+
+        auto findShader = [&context](std::string const& name) {
+            return std::find_if(context.shaders.begin(), context.shaders.end(), [&name](auto const& current) { return current.name == name; });
+        };
+
+        std::vector<float> pins(size_t(Width) * Height);
+        bool passed = true;
+        int checked = 0;
+
+        for (auto const& [name, graph] : context.composition->library->graphs) {
+            // the gif nodes and the nodes of the other kinds
+            std::vector<int> gifs;
+            int others = 0;
+            for (size_t i = 0; i != graph.nodes.size(); ++i) {
+                if (graph.nodes[i].op != CompositionOp::Shader)
+                    continue;
+
+                auto shader = findShader(graph.nodes[i].shader);
+                if (shader != context.shaders.end() && isGifShader(*shader))
+                    gifs.push_back(int(i));
+                else
+                    ++others;
+            }
+            if (gifs.empty() || others == 0)
+                continue;
+
+            context.shader = *findShader(name);
+            std::fill(pins.begin(), pins.end(), 0.0f);
+
+            // the largest pin of the output and of every gif node over the frames
+            float output = 0.0f;
+            std::vector<float> gif_peaks(gifs.size(), 0.0f);
+
+            for (int frame = 0; frame != Frames; ++frame) {
+                updateContextState(context, Width, Height, frame * FrameTime);
+
+                for (int y = 0; y != Height; ++y)
+                    context.shader.batch(context, y, 0, Width, pins.data() + y * Width);
+                output = maximum(output, *std::max_element(pins.begin(), pins.end()));
+
+                for (size_t g = 0; g != gifs.size(); ++g) {
+                    MetaShaderContext& source = context.composition->sources[name][gifs[g]];
+                    for (int y = 0; y != Height; ++y) {
+                        for (int x = 0; x != Width; ++x)
+                            gif_peaks[g] = maximum(gif_peaks[g], source.shader.function(source, y * Width + x, { float(x), float(y) }, 0.0f));
+                    }
+                }
+            }
+
+            bool ok = output > 0.0f && *std::min_element(gif_peaks.begin(), gif_peaks.end()) > 0.0f;
+            passed = passed && ok;
+            ++checked;
+
+            for (size_t g = 0; g != gifs.size(); ++g)
+                TraceLog(LOG_INFO, "Compositions > %s: gif node '%s' max pin %.3f", graph.file.c_str(), graph.nodes[gifs[g]].shader.c_str(), gif_peaks[g]);
+            TraceLog(ok ? LOG_INFO : LOG_ERROR, "Compositions > %s: output max pin %.3f %s", graph.file.c_str(), output, ok ? "ok" : "FAILED");
+        }
+
+        // the square of a negated Circle, a negative side of a multiply isn't skipped like a mask
+        {
+            std::string const name = "check_negative_multiply";
+            CompositionGraph graph;
+            graph.file = name;
+            std::string error;
+            if (!parseComposition("a = shader Circle\nn = remap a 0.0 -1.0\nmultiply n n", graph, error)) {
+                TraceLog(LOG_ERROR, "Compositions > %s: %s", name.c_str(), error.c_str());
+                return false;
+            }
+
+            context.composition->library->graphs[name] = std::move(graph);
+            context.shader = { name, compositionPin, compositionBatch };
+            // Circle is in [0.5, 1.0], it is flat until its ring grows
+            float low = 1.0f;
+            float high = 0.0f;
+            for (int frame = 0; frame != Frames; ++frame) {
+                updateContextState(context, Width, Height, frame * FrameTime * 4.0f);
+
+                for (int y = 0; y != Height; ++y)
+                    context.shader.batch(context, y, 0, Width, pins.data() + y * Width);
+
+                auto [frame_low, frame_high] = std::minmax_element(pins.begin(), pins.end());
+                low = minimum(low, *frame_low);
+                high = maximum(high, *frame_high);
+            }
+
+            bool ok = low >= 0.25f - 1e-4f && high <= 1.0f + 1e-4f;
+            passed = passed && ok;
+
+            TraceLog(ok ? LOG_INFO : LOG_ERROR, "Compositions > %s: pins in [%.3f, %.3f], expected in [0.25, 1.0] %s", name.c_str(), low, high, ok ? "ok" : "FAILED");
+            context.composition->library->graphs.erase(name);
+            context.composition->sources.erase(name);
+        }
+
+        if (checked == 0) {
+            TraceLog(LOG_ERROR, "Compositions > no composition mixes a gif with other shaders");
+            return false;
+        }
+
+        return passed;
+    }
+}
@@ -1,5 +1,7 @@
 #include "MetaShader.hpp"
 #include "Text.hpp"
+#include "Jobs.hpp"
+#include "ShaderCombinators.hpp"
 
 #include "raymath.h"
 
@@ -12,6 +14,8 @@ namespace pw {
         Vector2 size;                       // size of the canvas
         Vector2 half_size;                  // half size of the canvas
         float time;                         // time in seconds
+        uint32_t frame = 0;                 // frames evaluated, the counter of the random shaders
+        uint32_t seed = 0;                  // random seed
 
         const float wave_cycles = 5.0f;
         const float wave_speed = 3.0f;
@@ -21,10 +25,23 @@ namespace pw {
         context.cpp->size = { float(canvas_width), float(canvas_height) };
         context.cpp->half_size = { canvas_width * 0.5f, canvas_height * 0.5f };
         context.cpp->time = time;
+        context.cpp->frame++;
+        context.cpp->seed = randomSeed();
 
-        updateGifContextState(context, canvas_width, canvas_height, time);
-        updatePyContextState(context, canvas_width, canvas_height, time);
+        // a composition updates the kinds for each of its shaders instead
+        if (!updateCompositionContextState(context, canvas_width, canvas_height, time))
+            updateKindContextState(context, canvas_width, canvas_height, time);
+    }
+
+    void updateKindContextState(MetaShaderContext& context, int canvas_width, int canvas_height, float time) {
+        // these kinds may still be loading in the background
+        if (context.gif) updateGifContextState(context, canvas_width, canvas_height, time);
+        if (context.py) updatePyContextState(context, canvas_width, canvas_height, time);
+        if (context.pwx) updatePwxContextState(context, canvas_width, canvas_height, time);
+        if (context.plugin) updatePluginContextState(context, canvas_width, canvas_height, time);
         updateWaterContextState(context, canvas_width, canvas_height, time);
+        updateNoiseContextState(context, canvas_width, canvas_height, time);
+        if (context.stream) updateStreamContextState(context, canvas_width, canvas_height, time);
     }
 
     static float swirl(MetaShaderContext& msc, int const pin_index, Vector2 const& pin_pos, float const pin_value) {
@@ -45,7 +62,7 @@ namespace pw {
         float d = Vector2DotProduct(pos_normalized, target_dir);
 
         float displacement = d * TWO_PI * 3.5f;
-        out = sin(t + displacement) * 0.5f + 0.5f;
+        out = fastSin(t + displacement) * 0.5f + 0.5f;
 
         //float modulator = time;
         //float x_distance = smoothstep(0.0f, float(m_canvas_width), float(x)) * 2.0f - 1.0f;
@@ -77,6 +94,27 @@ namespace pw {
         return out;
     }
 
+    // pins of the [x0, x1] x [y0, y1] range of the [-1.0, 1.0] coordinates, grown by a pin for the rounding
+    static PinRegion normalizedRegion(float x0, float x1, float y0, float y1, int canvas_width, int canvas_height) {
+        auto pin = [](float n, int size) { return (n + 1.0f) * 0.5f * float(size); };
+        return {
+            clampTo(int(std::floor(pin(x0, canvas_width))) - 1, 0, canvas_width),
+            clampTo(int(std::floor(pin(y0, canvas_height))) - 1, 0, canvas_height),
+            clampTo(int(std::ceil(pin(x1, canvas_width))) + 2, 0, canvas_width),
+            clampTo(int(std::ceil(pin(y1, canvas_height))) + 2, 0, canvas_height)
+        };
+    }
+
+    // the two lines, nothing when the cross fades out
+    static void crossBounds(MetaShaderContext& msc, int const canvas_width, int const canvas_height, std::vector<PinRegion>& regions) {
+        float size = 0.1f;
+        if (fract(msc.cpp->time * 0.5f) == 0.0f)
+            return;
+
+        regions.push_back(normalizedRegion(-size, size, -1.0f, 1.0f, canvas_width, canvas_height));
+        regions.push_back(normalizedRegion(-1.0f, 1.0f, -size, size, canvas_width, canvas_height));
+    }
+
     static float asteroid(MetaShaderContext& msc, int const pin_index, Vector2 const& pin_pos, float const pin_value) {
         float out = 0.0f;
         float size = 0.25f;
@@ -84,7 +122,8 @@ namespace pw {
         // [-1.0f, 1.0f]
         Vector2 pos_normalized = Vector2SubtractValue(Vector2Scale(Vector2Divide(pin_pos, msc.cpp->size), 2.0f), 1.0f);
 
-        float value = std::pow(std::abs(pos_normalized.x), 2.0f/3.0f) + std::pow(std::abs(pos_normalized.y), 2.0f / 3.0f) - 1.0f;
+        // |x|^(2/3) is the cube root of x^2
+        float value = fastCbrt(pos_normalized.x * pos_normalized.x) + fastCbrt(pos_normalized.y * pos_normalized.y) - 1.0f;
         out += smoothstep(size, 0.0f, abs(value));
         return out;
     }
@@ -99,12 +138,23 @@ namespace pw {
         // [-2.0f, 2.0f]
         pos_normalized = Vector2Scale(pos_normalized, 2.0f);
 
-        float value = std::pow(pos_normalized.x, 2.0f) + std::pow(-pos_normalized.y - std::pow(std::pow(pos_normalized.x, 2.0f), 1.0f/3.0f), 2.0f) -1.0f;
+        float x2 = pos_normalized.x * pos_normalized.x;
+        float curve = -pos_normalized.y - fastCbrt(x2);
+        float value = x2 + curve * curve - 1.0f;
         out += smoothstep(size, 0.0f, abs(value));
         return out;
     }
 
 
+    // |value| < size needs x^2 < 1 + size and (y + cbrt(x^2))^2 < 1 + size, the curve ends above the bottom of the canvas
+    static void heartBounds(MetaShaderContext& msc, int const canvas_width, int const canvas_height, std::vector<PinRegion>& regions) {
+        float size = 0.5f;
+        float reach = std::sqrt(1.0f + size);
+
+        // the heart is drawn on [-2.0, 2.0]
+        regions.push_back(normalizedRegion(-reach / 2.0f, reach / 2.0f, -1.0f, reach / 2.0f, canvas_width, canvas_height));
+    }
+
     static float ellipses(MetaShaderContext& msc, int const pin_index, Vector2 const& pin_pos, float const pin_value) {
         float out = 0.0f;
         float size = 0.5f;
@@ -119,7 +169,7 @@ namespace pw {
         float x = pos_normalized.x + msc.cpp->time * speed;
         float y = pos_normalized.y + msc.cpp->time * speed;
 
-        float value = sin(std::pow(x, 2.0f) + std::pow(y, 2.0f)) - cos(x * y);
+        float value = fastSin(x * x + y * y) - fastCos(x * y);
 
         out += smoothstep(size, 0.0f, abs(value));
 
@@ -143,20 +193,20 @@ namespace pw {
         out = smoothstep(size, 0.0f, abs(radius - distance));
 
         // make it move
-        out = out * sin(c_time) * 0.5f + 0.5f;
+        out = out * fastSin(c_time) * 0.5f + 0.5f;
 
         return out;
     }
 
     static float sinWave(MetaShaderContext& msc, int const pin_index, Vector2 const& pin_pos, float const pin_value) {
         float phase = (pin_pos.x / msc.cpp->size.x) * 2.0f * PI * msc.cpp->wave_cycles;
-        return sin(phase + msc.cpp->time * msc.cpp->wave_speed) * 0.5f + 0.5f;
+        return fastSin(phase + msc.cpp->time * msc.cpp->wave_speed) * 0.5f + 0.5f;
     }
 
 	static float triangleWave(MetaShaderContext& msc, int const pin_index, Vector2 const& pin_pos, float const pin_value) {
 		const float relative_x = (pin_pos.x / msc.cpp->size.x);
 		float phase = (relative_x * TWO_PI) * msc.cpp->wave_cycles;
-		phase = fmodf(phase + msc.cpp->time * msc.cpp->wave_speed, TWO_PI);
+		phase = fract((phase + msc.cpp->time * msc.cpp->wave_speed) * TWO_PI_RECIPROCAL) * TWO_PI;
 
 		return 1.0f - fabs(-1.0f + (phase / PI));
 	}
@@ -165,7 +215,7 @@ namespace pw {
         const float x_diff = 1.0f / msc.cpp->size.x;
 
         float t = int(msc.cpp->time * (msc.cpp->wave_speed * 2.0f) * TWO_PI);
-        float value = fmodf((pin_pos.x + t) * x_diff * msc.cpp->wave_cycles, 1.0f);
+        float value = fract((pin_pos.x + t) * x_diff * msc.cpp->wave_cycles);
         return value;
     }
 
@@ -180,43 +230,296 @@ namespace pw {
     }
 
     static float randomData(MetaShaderContext& msc, int const pin_index, Vector2 const& pin_pos, float const pin_value) {
-         return uniformRandom() * 0.5f + 0.5f;
+         return hashUniform(msc.cpp->seed, uint32_t(pin_index), msc.cpp->frame) * 0.5f + 0.5f;
+    }
+
+    static void randomDataBatch(MetaShaderContext& msc, int const y, int const x_begin, int const x_end, float* const row) {
+        uint32_t first = uint32_t(y * int(msc.cpp->size.x) + x_begin);
+        hashUniformFill(msc.cpp->seed, first, msc.cpp->frame, row + x_begin, x_end - x_begin);
+
+        for (int x = x_begin; x != x_end; ++x)
+            row[x] = row[x] * 0.5f + 0.5f;
     }
 
     //
-    // c++ Meta shaders
+    // combinator shaders, each composition is a constexpr tree the batch template inlines in the pin loop
     //
-    void setupMetaShaders(MetaShaderContext& context) {
-        context.shaders.clear();
+    namespace cm = combinators;
+
+    // circles tiled over the canvas, breathing in and out
+    static constexpr auto TiledCircles = cm::Remap{ cm::Animate{
+        cm::Smoothstep{ cm::Abs{ cm::Circle{ cm::Repeat{ cm::Centered{}, { 0.5f, 0.5f } }, 0.15f } }, 0.06f, 0.0f },
+        cm::Sine{ 2.0f } }, 0.5f, 1.0f };
+
+    // a frame sliding through a ring
+    static constexpr auto SlidingFrame = cm::Max{
+        cm::Smoothstep{ cm::Abs{ cm::Circle{ cm::Centered{}, 0.6f } }, 0.15f, 0.0f },
+        cm::Smoothstep{ cm::Abs{ cm::Box{ cm::Repeat{ cm::Scroll{ cm::Centered{}, { 0.3f, 0.0f } }, { 2.0f, 4.0f } }, { 0.3f, 0.3f } } }, 0.08f, 0.0f } };
+
+    // the Circle and Cross shaders written with combinators, they compute the same pins
+    static constexpr auto ComposedCircle = cm::Remap{ cm::Animate{
+        cm::Smoothstep{ cm::Abs{ cm::Circle{ cm::Centered{}, 0.7f } }, 0.3f, 0.0f },
+        cm::Sine{ 1.0f } }, 0.5f, 1.0f };
+
+    static constexpr auto ComposedCross = cm::Animate{ cm::Add{
+        cm::Smoothstep{ cm::Abs{ cm::Line{ cm::Normalized{}, { 1.0f, 0.0f } } }, 0.1f, 0.0f },
+        cm::Smoothstep{ cm::Abs{ cm::Line{ cm::Normalized{}, { 0.0f, 1.0f } } }, 0.1f, 0.0f } },
+        cm::Saw{ 0.5f } };
+
+    static cm::Frame combinatorFrame(MetaShaderCpp const& cpp) {
+        return { cpp.size, cpp.half_size, cpp.time };
+    }
+
+    template<auto const& Shader> static float combinatorPin(MetaShaderContext& msc, int const pin_index, Vector2 const& pin_pos, float const pin_value) {
+        return Shader(pin_pos, combinatorFrame(*msc.cpp));
+    }
 
-        setupWaterMetaShaders(context);
-        setupGifMetaShaders(context);
+    template<auto const& Shader> static void combinatorBatch(MetaShaderContext& msc, int const y, int const x_begin, int const x_end, float* const row) {
+        cm::evaluateRow(Shader, combinatorFrame(*msc.cpp), y, x_begin, x_end, row);
+    }
+
+    template<auto const& Shader> static MetaShaderInfo combinatorShader(std::string const& name) {
+        return { name, combinatorPin<Shader>, combinatorBatch<Shader>, true };
+    }
+
+    // the hand-written shaders called directly in the row loop, the baseline of the benchmark
+    template<MetaShaderFunction Function> static void handWrittenBatch(MetaShaderContext& msc, int const y, int const x_begin, int const x_end, float* const row) {
+        Vector2 pin = { 0.0f, float(y) };
+        for (int x = x_begin; x != x_end; ++x) {
+            pin.x = float(x);
+            row[x] = Function(msc, 0, pin, row[x]);
+        }
+    }
+
+    void benchmarkCombinators() {
+        constexpr int Width = 320;
+        constexpr int Height = 240;
+        constexpr int Runs = 16;
+
+        MetaShaderContext context;
+        context.cpp = std::make_shared<MetaShaderCpp>();
+        context.cpp->size = { float(Width), float(Height) };
+        context.cpp->half_size = { Width * 0.5f, Height * 0.5f };
+        context.cpp->time = 1.3f;
+
+        struct Variant {
+            const char* name;
+            MetaShaderBatchFunction hand_written;
+            MetaShaderBatchFunction composed;
+        };
+
+        Variant variants[] = {
+            { "circle", handWrittenBatch<circle>, combinatorBatch<ComposedCircle> },
+            { "cross", handWrittenBatch<cross>, combinatorBatch<ComposedCross> },
+        };
+
+        std::vector<float> expected(Width * Height), pins(Width * Height);
+        auto run = [&](MetaShaderBatchFunction batch, std::vector<float>& out) {
+            int64_t start = getCurrentMicroseconds();
+            for (int r = 0; r != Runs; ++r)
+                for (int y = 0; y != Height; ++y)
+                    batch(context, y, 0, Width, out.data() + y * Width);
+            return double(getCurrentMicroseconds() - start) * 1000.0 / (double(Runs) * Width * Height);
+        };
+
+        TraceLog(LOG_INFO, "Combinators > ns per pin on a %dx%d canvas", Width, Height);
+        for (auto const& variant : variants) {
+            double hand_written = run(variant.hand_written, expected);
+            double composed = run(variant.composed, pins);
+
+            float difference = 0.0f;
+            for (size_t i = 0; i != pins.size(); ++i)
+                difference = maximum(difference, absolute(pins[i] - expected[i]));
+
+            TraceLog(LOG_INFO, "Combinators > %-8s hand-written %6.2f composed %6.2f, max difference %g", variant.name, hand_written, composed, difference);
+        }
+    }
+
+    // every kind is loaded into its own context, so the jobs don't share any state
+    struct MetaShaderLoading {
+        // the jobs write into the contexts below, they must be done before those go away
+        ~MetaShaderLoading() { graph.wait(); }
+
+        JobGraph graph;
+        int64_t start = 0;
+
+        MetaShaderContext water;
+        MetaShaderContext gif;
+        MetaShaderContext cpp;
+        MetaShaderContext py;
+        MetaShaderContext pwx;
+        MetaShaderContext plugin;
+        MetaShaderContext comp;
+    };
+
+    static void ensureActiveShader(MetaShaderContext& context) {
+        if (!context.shader.name.empty()) {
+            std::string const& active = context.shader.name;
+            bool found = std::any_of(context.shaders.begin(), context.shaders.end(), [&active](auto const& current) {  return current.name == active; });
+            if (!found) {
+                context.shader = context.shaders[0];
+            }
+        }
+    }
 
+    //
+    // c++ Meta shaders
+    //
+    static void setupCppMetaShaders(MetaShaderContext& context) {
         context.cpp = std::make_shared<MetaShaderCpp>();
         context.shaders.push_back({ "Sin Wave", sinWave });
         context.shaders.push_back({ "Triangle Wave", triangleWave });
         context.shaders.push_back({ "Saw Wave", sawWave });
         context.shaders.push_back({ "Swirl", swirl });
-        context.shaders.push_back({ "Cross", cross });
+        context.shaders.push_back({ "Cross", cross, nullptr, false, nullptr, crossBounds });
         context.shaders.push_back({ "Asteroid", asteroid });
-        context.shaders.push_back({ "Heart", heart });
+        context.shaders.push_back({ "Heart", heart, nullptr, false, nullptr, heartBounds });
         context.shaders.push_back({ "Ellipses", ellipses });
         context.shaders.push_back({ "Circle", circle });
-        context.shaders.push_back({ "Random", randomData });
+        context.shaders.push_back({ "Random", randomData, randomDataBatch, true });
+        context.shaders.push_back(combinatorShader<TiledCircles>("Tiled Circles"));
+        context.shaders.push_back(combinatorShader<SlidingFrame>("Sliding Frame"));
 
-        setupPyMetaShaders(context);
+        setupNoiseMetaShaders(context);
+        setupStencilMetaShaders(context);
+        setupStreamMetaShaders(context);
+    }
 
+    void setupMetaShaders(MetaShaderContext& context, bool wait) {
+        // a previous load is finished and dropped before starting again
+        context.loading.reset();
+
+        auto loading = std::make_shared<MetaShaderLoading>();
+        loading->start = getCurrentMicroseconds();
+
+        MetaShaderLoading& l = *loading;
+        JobGraph::JobId water = l.graph.add("water", [&l]() { setupWaterMetaShaders(l.water); });
+        l.graph.add("gif", [&l]() { setupGifMetaShaders(l.gif); });
+        l.graph.add("py", [&l]() { setupPyMetaShaders(l.py); });
+        l.graph.add("pwx", [&l]() { setupPwxMetaShaders(l.pwx); });
+        l.graph.add("plugin", [&l]() { setupPluginMetaShaders(l.plugin); });
+        l.graph.add("comp", [&l]() { setupCompositionMetaShaders(l.comp); });
+        l.graph.run(JobSystem::shared());
+
+        setupCppMetaShaders(l.cpp);
+
+        // the default shader is available right away, the rest is merged by finishMetaShaders
+        l.graph.wait(water);
+
+        context.wtr = l.water.wtr;
+        context.cpp = l.cpp.cpp;
+        context.noise = l.cpp.noise;
+        context.stencil = l.cpp.stencil;
+        context.stream = l.cpp.stream;
+        context.gif.reset();
+        context.py.reset();
+        context.pwx.reset();
+        context.plugin.reset();
+        context.composition.reset();
 
-        if (!context.shader.name.empty()) {
-            std::string const& active = context.shader.name;
-            bool found = std::any_of(context.shaders.begin(), context.shaders.end(), [&active](auto const& current) {  return current.name == active; });
-            if (!found) {
-                context.shader = context.shaders[0];
+        context.shaders.clear();
+        addAll(context.shaders, l.water.shaders);
+        addAll(context.shaders, l.cpp.shaders);
+
+        TraceLog(LOG_DEBUG, "Startup > default shader ready in %.2f ms", (getCurrentMicroseconds() - l.start) / 1000.0);
+
+        context.loading = loading;
+
+        if (wait) {
+            l.graph.wait();
+            finishMetaShaders(context);
+        }
+    }
+
+    bool finishMetaShaders(MetaShaderContext& context) {
+        if (!context.loading || !context.loading->graph.finished())
+            return false;
+
+        MetaShaderLoading& l = *context.loading;
+
+        context.gif = l.gif.gif;
+        context.py = l.py.py;
+        context.pwx = l.pwx.pwx;
+        context.plugin = l.plugin.plugin;
+        context.composition = l.comp.composition;
+
+        // same order as a serial load, so the menu doesn't depend on which job finished first
+        context.shaders.clear();
+        addAll(context.shaders, l.water.shaders);
+        addAll(context.shaders, l.gif.shaders);
+        addAll(context.shaders, l.cpp.shaders);
+        addAll(context.shaders, l.py.shaders);
+        addAll(context.shaders, l.pwx.shaders);
+        addAll(context.shaders, l.plugin.shaders);
+        addAll(context.shaders, l.comp.shaders);
+
+        l.graph.logTimings("Startup");
+        TraceLog(LOG_DEBUG, "Startup > %d shaders loaded in %.2f ms", int(context.shaders.size()), (getCurrentMicroseconds() - l.start) / 1000.0);
+
+        context.loading.reset();
+
+        ensureActiveShader(context);
+        return true;
+    }
+
+    void shareMetaShaderContext(MetaShaderContext& context, MetaShaderContext const& source) {
+        std::string active = context.shader.name;
+
+        context.shaders = source.shaders;
+        context.loading.reset();
+
+        // the frame counter of the random shaders doesn't depend on the other canvases
+        if (!source.cpp)
+            context.cpp.reset();
+        else if (!context.cpp || context.cpp == source.cpp)
+            context.cpp = std::make_shared<MetaShaderCpp>(*source.cpp);
+
+        sharePyContext(context, source);
+        sharePwxContext(context, source);
+        sharePluginContext(context, source);
+        shareWaterContext(context, source);
+        shareNoiseContext(context, source);
+        shareGifContext(context, source);
+        shareStencilContext(context, source);
+        shareCompositionContext(context, source);
+        shareStreamContext(context, source);
+
+        // the shader may have been rebuilt, its functions are taken again
+        auto found = std::find_if(context.shaders.begin(), context.shaders.end(), [&active](auto const& current) { return current.name == active; });
+        if (found != context.shaders.end())
+            context.shader = *found;
+        else if (!context.shaders.empty())
+            context.shader = context.shaders[0];
+    }
+
+    void replaceMetaShader(MetaShaderContext& context, MetaShaderInfo const& info) {
+        if (context.shader.name == info.name)
+            context.shader = info;
+
+        for (auto& current : context.shaders) {
+            if (current.name == info.name) {
+                current = info;
+                return;
             }
         }
+
+        context.shaders.push_back(info);
+    }
+
+    bool removeMetaShader(MetaShaderContext& context, std::string const& name) {
+        auto found = std::find_if(context.shaders.begin(), context.shaders.end(), [&name](auto const& current) { return current.name == name; });
+        if (found == context.shaders.end())
+            return false;
+
+        context.shaders.erase(found);
+
+        if (context.shader.name == name && !context.shaders.empty())
+            context.shader = context.shaders[0];
+
+        return true;
     }
 
-    std::vector<std::string> platformShadersFiles(std::string const& kind) {
+    std::vector<std::string> platformShadersFolders(std::string const& kind) {
 		std::vector<std::string> folders;
 
 		
@@ -229,6 +532,14 @@ namespace pw {
 			const int max_search = 4;
 			int search = 0; // on mac search should find it at 3
 			auto parent = std::filesystem::path(executablePath()).parent_path();;
+
+			// built shaders, like the plugins, are written next to the executable
+			std::string built = mergePaths(parent.string(), kind);
+			if (fileType(built) == FileType::FileDirectory) {
+				folders.push_back(built);
+				search = max_search;
+			}
+
 			while (search < max_search) {
 				if (!parent.has_parent_path()) 
 					break;
@@ -251,7 +562,11 @@ namespace pw {
 		}
 #endif
 
+		return folders;
+	}
 
+    std::vector<std::string> platformShadersFiles(std::string const& kind, std::string const& extension) {
+		std::vector<std::string> folders = platformShadersFolders(kind);
         std::vector<std::string> files;
 
 		// find candidate shaders
@@ -264,7 +579,7 @@ namespace pw {
 				TraceLog(LOG_DEBUG, "[%s] Checking File %s", kind.c_str(), filepath.c_str());
 						
 				if (fileType(filepath) != FileType::FileRegular) continue;
-				if (!endsWith(filepath, "." + kind)) continue;
+				if (!endsWith(filepath, "." + (extension.empty() ? kind : extension))) continue;
 
 				files.push_back(filepath);
 			}
@@ -1,8 +1,11 @@
 #include "MetaShader.hpp"
+#include "Trace.hpp"
 
 #include "raymath.h"
 #include "external/stb_image.h"
 
+#include <mutex>
+
 namespace pw {
 
     struct Frame {
@@ -12,12 +15,12 @@ namespace pw {
         float duration = 0.0f;
         std::vector<float> data;
 
-        float get_pixel(int x, int y) {
+        float get_pixel(int x, int y) const {
             return data[y * w + x];
         }
 
         // relative coordinates
-        float sample_nn(float x, float y) {
+        float sample_nn(float x, float y) const {
             int ix = int(x * (w - 1));
             int iy = int(y * (h - 1));
 
@@ -43,79 +46,139 @@ namespace pw {
         Frame& operator=(const Frame& o) = delete;
     };
 
-    // info that is constat during a frame run
-    struct MetaShaderGif {
+    static void grayscaleFrame(stbi_uc* data, Frame& frame) {
+        for (int y = 0; y != frame.h; ++y) {
+            for (int x = 0; x != frame.w; ++x) {
+                stbi_uc* source_pixel = data + (y * frame.w + x) * 4;
 
-        MetaShaderGif() {
-            clean();
-        }
+                float r = float(*(source_pixel + 0)) / 255.0f;
+                float g = float(*(source_pixel + 1)) / 255.0f;
+                float b = float(*(source_pixel + 2)) / 255.0f;
+                float a = float(*(source_pixel + 3)) / 255.0f;
 
-        void clean() {
-            total_time = 0.0;
-            active_frame = -1;
-            frames.clear();
-            active_shader_name.clear();
+                float value = 0.2126f * r + 0.7152f * g + 0.0722f * b;
+                value *= a;
+
+                float* dst_pixel = frame.data.data() + (y * frame.w + x);
+                *dst_pixel = clampTo(value, 0.0f, 1.0f);
+            }
         }
+    }
 
-        void grayscaleFrame(stbi_uc* data, Frame& frame) {
-            for (int y = 0; y != frame.h; ++y) {
-                for (int x = 0; x != frame.w; ++x) {
-                    stbi_uc* source_pixel = data + (y * frame.w + x) * 4;
+    // decodes every frame of a gif to grayscale, doesn't touch any shared state so it can run off the main thread
+    static bool decodeGif(std::string const& filepath, std::vector<Frame>& frames, float& total_time) {
+        PW_TRACE_ZONE("decodeGif");
 
-                    float r = float(*(source_pixel + 0)) / 255.0f;
-                    float g = float(*(source_pixel + 1)) / 255.0f;
-                    float b = float(*(source_pixel + 2)) / 255.0f;
-                    float a = float(*(source_pixel + 3)) / 255.0f;
+        std::vector<uint8_t> file_data;
+        if (!readRawBinary(filepath, file_data)) return false;
 
-                    float value = 0.2126f * r + 0.7152f * g + 0.0722f * b;
-                    value *= a;
+        int* delays = nullptr;
+        int x, y, z, comp;
 
-                    float* dst_pixel = frame.data.data() + (y * frame.w + x);
-                    *dst_pixel = clampTo(value, 0.0f, 1.0f);
-                }
-            }
+        stbi_uc* gif = stbi_load_gif_from_memory(file_data.data(), file_data.size(), &delays, &x, &y, &z, &comp, 0);
+        if (!gif || !delays) return false;
+
+        size_t frame_size = size_t(x) * y * comp;
+        total_time = 0.0f;
+        for (int f = 0; f != z; ++f) {
+            float delay = delays[f] / 1000.f;
+            if (delay < 0.0001) 
+                delay = 0.1;
+
+            Frame frame;
+            frame.w = x;
+            frame.h = y;
+            frame.duration = delay;
+            frame.ts = total_time;
+            frame.data.resize(size_t(x * y));
+
+            grayscaleFrame(gif + frame_size * f, frame);
+
+            frames.push_back(std::move(frame));
+            total_time += frame.duration;
         }
 
-        void loadGif(std::string const& name) {
-            clean();
+        free(delays);
+        stbi_image_free(gif);
+        return true;
+    }
 
-            if (!file_mapping.contains(name)) return;
+    // every frame of a gif, shared by the canvases that show it
+    struct GifFrames {
+        std::vector<Frame> frames;
+        float total_time = 0.0f;
+    };
 
-            std::vector<uint8_t> file_data;
-            if (!readRawBinary(file_mapping[name], file_data)) return;
+    // the gif files and the decoded gifs some canvas shows, shared by the canvases.
+    // the canvases update from their keyframe workers too, the maps are only used under the mutex
+    struct GifLibrary {
+        std::mutex mutex;
+        std::map<std::string, std::string> file_mapping;
+        std::map<std::string, std::shared_ptr<GifFrames>> decoded;
+
+        // decodes the gif unless a canvas already shows it, null for names that aren't gifs
+        std::shared_ptr<GifFrames> find(std::string const& name) {
+            std::string filepath;
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                auto found = decoded.find(name);
+                if (found != decoded.end())
+                    return found->second;
+
+                auto file = file_mapping.find(name);
+                if (file == file_mapping.end())
+                    return nullptr;
+                filepath = file->second;
+            }
 
-            int* delays = nullptr;
-            int x, y, z, comp;
+            // the other canvases don't wait for the decode, the first decoded copy is kept
+            PW_TRACE_ZONE("loadGif");
+            auto frames = std::make_shared<GifFrames>();
+            decodeGif(filepath, frames->frames, frames->total_time);
 
-            stbi_uc* gif = stbi_load_gif_from_memory(file_data.data(), file_data.size(), &delays, &x, &y, &z, &comp, 0);
-            if (!gif || !delays) return;
+            std::lock_guard<std::mutex> lock(mutex);
+            return decoded.emplace(name, frames).first->second;
+        }
 
-            size_t frame_size = size_t(x) * y * comp;
-            total_time = 0.0f;
-            for (int f = 0; f != z; ++f) {
-                float delay = delays[f] / 1000.f;
-                if (delay < 0.0001) 
-                    delay = 0.1;
+        // the frames a canvas shows now, null when no canvas shows the gif
+        std::shared_ptr<GifFrames> current(std::string const& name) {
+            std::lock_guard<std::mutex> lock(mutex);
+            auto found = decoded.find(name);
+            return (found != decoded.end()) ? found->second : nullptr;
+        }
 
-                Frame frame;
-                frame.w = x;
-                frame.h = y;
-                frame.duration = delay;
-                frame.ts = total_time;
-                frame.data.resize(size_t(x * y));
+        // the frames go away with the last canvas that shows them
+        void release(std::string const& name) {
+            std::lock_guard<std::mutex> lock(mutex);
+            auto found = decoded.find(name);
+            if (found != decoded.end() && found->second.use_count() == 1)
+                decoded.erase(found);
+        }
+    };
 
-                grayscaleFrame(gif + frame_size * f, frame);
+    // info that is constat during a frame run, every canvas has its own
+    struct MetaShaderGif {
 
-                frames.push_back(std::move(frame));
-                total_time += frame.duration;
-            }
+        MetaShaderGif() {
+            clean();
+        }
 
-            free(delays);
-            stbi_image_free(gif);
+        ~MetaShaderGif() {
+            clean();
+        }
+
+        void clean() {
+            active_frame = -1;
+            if (gif) {
+                gif.reset();
+                library->release(active_shader_name);
+            }
+            active_shader_name.clear();
         }
 
         void advanceTime(float time) {
-            float modulated = fmod(time, total_time);
+            std::vector<Frame> const& frames = gif->frames;
+            float modulated = fmod(time, gif->total_time);
             for (size_t i = 0; i != frames.size(); ++i) {
                 int index = (int(frames.size()) + active_frame + i) % frames.size();
 
@@ -128,10 +191,10 @@ namespace pw {
         }
 
         void letterbox() {
-            if (frames.empty()) return;
+            if (!gif || gif->frames.empty()) return;
 
             // Compute source/destination ratios.
-            Vector2 src_size = { float(frames[0].w), float(frames[0].h) };
+            Vector2 src_size = { float(gif->frames[0].w), float(gif->frames[0].h) };
             Vector2 dst_size = size;
 
             if (((src_size.x * dst_size.y) / src_size.y) <= dst_size.x) {
@@ -158,27 +221,35 @@ namespace pw {
         Vector2 letterbox_end{};
         Vector2 letterbox_region{};
 
-        std::map<std::string, std::string> file_mapping;
+        std::shared_ptr<GifLibrary> library;
 
         std::string active_shader_name;
-        std::vector<Frame> frames;
-        float total_time;
+        std::shared_ptr<GifFrames const> gif;
         int active_frame;
     };
 
 
     static bool ensureShader(MetaShaderContext& msc) {
-        if (msc.gif->active_shader_name != msc.shader.name) {
-            msc.gif->loadGif(msc.shader.name);
+        MetaShaderGif& gif = *msc.gif;
+        if (gif.active_shader_name != msc.shader.name) {
+            gif.clean();
+            gif.gif = gif.library->find(msc.shader.name);
+            gif.active_shader_name = msc.shader.name;
+        } else if (gif.gif) {
+            // the file changed on disk, the new frames are in the library
+            auto current = gif.library->current(gif.active_shader_name);
+            if (current && current != gif.gif) {
+                gif.gif = current;
+                gif.active_frame = -1;
+            }
         }
 
-        msc.gif->active_shader_name = msc.shader.name;
-
-        return !msc.gif->frames.empty();
+        return gif.gif && !gif.gif->frames.empty();
     }
 
     void updateGifContextState(MetaShaderContext& context, int canvas_width, int canvas_height, float time) {
-        ensureShader(context);
+        if (!ensureShader(context))
+            return;
 
         context.gif->size = { float(canvas_width), float(canvas_height) };
         context.gif->advanceTime(time);
@@ -195,15 +266,34 @@ namespace pw {
 
         Vector2 relative_pos = Vector2Divide(Vector2Subtract(pin_pos, msc.gif->letterbox_start), msc.gif->letterbox_region);
 
-        Frame& frame = msc.gif->frames[msc.gif->active_frame];
+        Frame const& frame = msc.gif->gif->frames[msc.gif->active_frame];
         return frame.sample_nn(relative_pos.x, relative_pos.y);
     }
 
+    // the letterbox, nothing before the first frame
+    static void gifBounds(MetaShaderContext& msc, int const canvas_width, int const canvas_height, std::vector<PinRegion>& regions) {
+        if (msc.gif->active_frame < 0)
+            return;
+
+        // the pins on the letterbox edges are inside
+        regions.push_back({
+            clampTo(int(std::floor(msc.gif->letterbox_start.x)), 0, canvas_width),
+            clampTo(int(std::floor(msc.gif->letterbox_start.y)), 0, canvas_height),
+            clampTo(int(std::floor(msc.gif->letterbox_end.x)) + 1, 0, canvas_width),
+            clampTo(int(std::floor(msc.gif->letterbox_end.y)) + 1, 0, canvas_height)
+        });
+    }
+
+    bool isGifShader(MetaShaderInfo const& info) {
+        return info.function == gifShader;
+    }
+
     //
     // gif Meta shaders
     //
     void setupGifMetaShaders(MetaShaderContext& context) {
         context.gif = std::make_shared<MetaShaderGif>();
+        context.gif->library = std::make_shared<GifLibrary>();
 
         std::vector<std::string> files = platformShadersFiles("gif");
 
@@ -212,9 +302,66 @@ namespace pw {
 			std::string file = getSimpleFileName(files[i]);
 			std::string name = getNameLessExtension(file);
 
-            context.gif->file_mapping[name] = filepath;
+            context.gif->library->file_mapping[name] = filepath;
+
+            context.shaders.push_back({ name, gifShader, nullptr, false, nullptr, gifBounds });
+        }
+    }
+
+    MetaShaderSwap prepareGifMetaShader(std::string const& filepath) {
+        std::string name = getNameLessExtension(getSimpleFileName(filepath));
+
+        if (fileType(filepath) != FileType::FileRegular) {
+            return [name](MetaShaderContext& context) {
+                {
+                    GifLibrary& library = *context.gif->library;
+                    std::lock_guard<std::mutex> lock(library.mutex);
+                    library.file_mapping.erase(name);
+                    library.decoded.erase(name);
+                }
+                if (context.gif->active_shader_name == name)
+                    context.gif->clean();
+                return removeMetaShader(context, name);
+            };
+        }
+
+        auto decoded = std::make_shared<GifFrames>();
+        if (!decodeGif(filepath, decoded->frames, decoded->total_time)) {
+            TraceLog(LOG_ERROR, "%s > unable to decode", getSimpleFileName(filepath).c_str());
+            decoded.reset();
+        }
 
-            context.shaders.push_back({ name, gifShader });
+        return [name, filepath, decoded](MetaShaderContext& context) {
+            // keep the running version if the new one doesn't decode
+            if (!decoded)
+                return false;
+
+            GifLibrary& library = *context.gif->library;
+            std::unique_lock<std::mutex> lock(library.mutex);
+            library.file_mapping[name] = filepath;
+
+            // the canvases that show the gif take the new frames on their next update, the others decode it when they show it
+            auto found = library.decoded.find(name);
+            if (found != library.decoded.end())
+                found->second = decoded;
+            lock.unlock();
+
+            replaceMetaShader(context, { name, gifShader, nullptr, false, nullptr, gifBounds });
+            return true;
+        };
+    }
+
+    void shareGifContext(MetaShaderContext& context, MetaShaderContext const& source) {
+        if (!source.gif) {
+            context.gif.reset();
+            return;
         }
+
+        // the gif a canvas shows and its current frame are its own
+        if (context.gif && context.gif != source.gif && context.gif->library == source.gif->library)
+            return;
+
+        context.gif = std::make_shared<MetaShaderGif>();
+        context.gif->library = source.gif->library;
     }
-}
\ No newline at end of file
+}
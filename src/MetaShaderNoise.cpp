@@ -0,0 +1,121 @@
+#include "MetaShader.hpp"
+#include "Noise.hpp"
+
+namespace pw {
+
+    // noise features per canvas height
+    constexpr float NoiseScale = 4.0f;
+
+    // how fast the time dimension is crossed, in lattice cells per second
+    constexpr float NoiseSpeed = 0.25f;
+
+    // info that is constat during a frame run
+    struct MetaShaderNoise {
+        float scale = 0.0f;     // canvas to noise space
+        float z = 0.0f;         // time as the third dimension
+    };
+
+    void updateNoiseContextState(MetaShaderContext& context, int, int canvas_height, float time) {
+        context.noise->scale = NoiseScale / float(maximum(1, canvas_height));
+        context.noise->z = time * NoiseSpeed;
+    }
+
+    //
+    // shaders over arrays of points, they write heights in [0.0, 1.0]
+    //
+    static void valueShader(float const* x, float const* y, float const* z, float* out, int count) {
+        noise(NoiseBasis::Value, x, y, z, out, count);
+        for (int i = 0; i < count; ++i)
+            out[i] = out[i] * 0.5f + 0.5f;
+    }
+
+    static void gradientShader(float const* x, float const* y, float const* z, float* out, int count) {
+        noise(NoiseBasis::Gradient, x, y, z, out, count);
+        for (int i = 0; i < count; ++i)
+            out[i] = out[i] * 0.5f + 0.5f;
+    }
+
+    static void simplexShader(float const* x, float const* y, float const* z, float* out, int count) {
+        noise(NoiseBasis::Simplex, x, y, z, out, count);
+        for (int i = 0; i < count; ++i)
+            out[i] = out[i] * 0.5f + 0.5f;
+    }
+
+    static void fbmShader(float const* x, float const* y, float const* z, float* out, int count) {
+        fbm(NoiseBasis::Simplex, NoiseOctaves(), x, y, z, out, count);
+        for (int i = 0; i < count; ++i)
+            out[i] = out[i] * 0.5f + 0.5f;
+    }
+
+    static void ridgedShader(float const* x, float const* y, float const* z, float* out, int count) {
+        ridged(NoiseBasis::Gradient, NoiseOctaves(), x, y, z, out, count);
+    }
+
+    static void domainWarpShader(float const* x, float const* y, float const* z, float* out, int count) {
+        NoiseOctaves octaves;
+        octaves.octaves = 4;
+
+        domainWarp(NoiseBasis::Simplex, octaves, 1.5f, x, y, z, out, count);
+        for (int i = 0; i < count; ++i)
+            out[i] = out[i] * 0.5f + 0.5f;
+    }
+
+    using NoiseShader = void(*)(float const*, float const*, float const*, float*, int);
+
+    template<NoiseShader Shader>
+    static float noisePin(MetaShaderContext& msc, int const, Vector2 const& pin_pos, float const) {
+        float x = pin_pos.x * msc.noise->scale;
+        float y = pin_pos.y * msc.noise->scale;
+        float z = msc.noise->z;
+
+        float out = 0.0f;
+        Shader(&x, &y, &z, &out, 1);
+        return out;
+    }
+
+    template<NoiseShader Shader>
+    static void noiseBatch(MetaShaderContext& msc, int const y, int const x_begin, int const x_end, float* const row) {
+        float xs[NoiseLanes], ys[NoiseLanes], zs[NoiseLanes];
+
+        float const scale = msc.noise->scale;
+        for (int i = 0; i != NoiseLanes; ++i) {
+            ys[i] = y * scale;
+            zs[i] = msc.noise->z;
+        }
+
+        for (int start = x_begin; start < x_end; start += NoiseLanes) {
+            int count = minimum(NoiseLanes, x_end - start);
+            for (int i = 0; i < count; ++i)
+                xs[i] = (start + i) * scale;
+
+            Shader(xs, ys, zs, row + start, count);
+        }
+    }
+
+    template<NoiseShader Shader>
+    static MetaShaderInfo noiseInfo(std::string const& name) {
+        return { name, noisePin<Shader>, noiseBatch<Shader>, true };
+    }
+
+    //
+    // noise Meta shaders
+    //
+    void setupNoiseMetaShaders(MetaShaderContext& context) {
+        context.noise = std::make_shared<MetaShaderNoise>();
+
+        context.shaders.push_back(noiseInfo<valueShader>("Value Noise"));
+        context.shaders.push_back(noiseInfo<gradientShader>("Gradient Noise"));
+        context.shaders.push_back(noiseInfo<simplexShader>("Simplex Noise"));
+        context.shaders.push_back(noiseInfo<fbmShader>("Fbm"));
+        context.shaders.push_back(noiseInfo<ridgedShader>("Ridged"));
+        context.shaders.push_back(noiseInfo<domainWarpShader>("Domain Warp"));
+    }
+
+    void shareNoiseContext(MetaShaderContext& context, MetaShaderContext const& source) {
+        // the noise space follows the size and time of the canvas
+        if (!source.noise)
+            context.noise.reset();
+        else if (!context.noise || context.noise == source.noise)
+            context.noise = std::make_shared<MetaShaderNoise>(*source.noise);
+    }
+}
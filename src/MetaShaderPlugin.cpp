@@ -0,0 +1,303 @@
+#include "MetaShader.hpp"
+#include "Text.hpp"
+#include "PinWorldPlugin.h"
+
+#include <filesystem>
+
+namespace pw {
+
+#if defined(_WIN32)
+    static const std::string PluginExtension = "dll";
+#else
+    static const std::string PluginExtension = "so";
+#endif
+
+    // how often the plugin folder is checked for changed libraries
+    constexpr int64_t PluginCheckInterval = 1000;
+
+    struct PluginShader {
+        PinWorldShader shader{};
+        void* state = nullptr;
+    };
+
+    struct PluginLibrary {
+        std::string filepath;                   // library in the plugin folder
+        std::string loaded_path;                // private copy that is actually loaded
+        void* handle = nullptr;
+        int64_t modified = 0;                   // modification time of the loaded library
+        int64_t pending_modified = 0;           // a change waiting for the file to settle
+        bool pending = false;
+        bool settled = false;                   // the change stopped, reloaded once no canvas runs the shaders
+        std::vector<std::string> shader_names;
+    };
+
+    // the loaded libraries and their shaders, shared by the canvases
+    struct PluginHost {
+        ~PluginHost();
+
+        std::vector<PluginLibrary> libraries;
+        std::map<std::string, PluginShader> shaders;
+        ElapsedTimer check_timer;
+        int generation = 0;
+    };
+
+    // every canvas has its own
+    struct MetaShaderPlugin {
+        std::shared_ptr<PluginHost> host;
+        PinWorldFrame frame{};
+    };
+
+    static void unloadLibrary(PluginHost& plugin, PluginLibrary& library) {
+        for (auto const& name : library.shader_names) {
+            auto found = plugin.shaders.find(name);
+            if (found == plugin.shaders.end())
+                continue;
+
+            PluginShader& ps = found->second;
+            if (ps.shader.destroy)
+                ps.shader.destroy(ps.state);
+
+            plugin.shaders.erase(found);
+        }
+        library.shader_names.clear();
+
+        closeLibrary(library.handle);
+        library.handle = nullptr;
+
+        if (!library.loaded_path.empty())
+            deleteFile(library.loaded_path);
+        library.loaded_path.clear();
+    }
+
+    // the library that already provides the shader, null when the name is free
+    static PluginLibrary const* shaderOwner(PluginHost const& plugin, std::string const& name) {
+        for (auto const& library : plugin.libraries)
+            if (contains(library.shader_names, name))
+                return &library;
+        return nullptr;
+    }
+
+    PluginHost::~PluginHost() {
+        for (auto& library : libraries)
+            unloadLibrary(*this, library);
+    }
+
+    //
+    // loads a private copy of the library, the original can then be rebuilt while we are running
+    //
+    static bool loadLibrary(PluginHost& plugin, PluginLibrary& library, std::map<std::string, PluginShader>& shaders) {
+        std::string file = getSimpleFileName(library.filepath);
+
+        // other PinWorld processes may load the same library from the same temp folder
+        std::error_code ec;
+        auto copy = std::filesystem::temp_directory_path(ec) / sfmt("pinworld_%d_%d_%s", processId(), plugin.generation++, file);
+        std::filesystem::copy_file(library.filepath, copy, std::filesystem::copy_options::overwrite_existing, ec);
+        if (ec) {
+            TraceLog(LOG_ERROR, "%s > unable to copy plugin %s", file.c_str(), ec.message().c_str());
+            return false;
+        }
+
+        library.loaded_path = copy.string();
+        fileModificationTime(library.filepath, library.modified);
+
+        std::string error;
+        library.handle = openLibrary(library.loaded_path, error);
+        if (library.handle == nullptr) {
+            TraceLog(LOG_ERROR, "%s > %s", file.c_str(), error.c_str());
+            unloadLibrary(plugin, library);
+            return false;
+        }
+
+        auto entry = reinterpret_cast<PinWorldPluginEntry>(librarySymbol(library.handle, PINWORLD_PLUGIN_ENTRY));
+        const PinWorldPlugin* description = entry ? entry() : nullptr;
+        if (description == nullptr) {
+            TraceLog(LOG_ERROR, "%s > %s not found", file.c_str(), PINWORLD_PLUGIN_ENTRY);
+            unloadLibrary(plugin, library);
+            return false;
+        }
+
+        if (description->version != PINWORLD_PLUGIN_VERSION) {
+            TraceLog(LOG_ERROR, "%s > plugin version %u, expected %u", file.c_str(), description->version, PINWORLD_PLUGIN_VERSION);
+            unloadLibrary(plugin, library);
+            return false;
+        }
+
+        for (uint32_t i = 0; i != description->shader_count; ++i) {
+            PinWorldShader const& shader = description->shaders[i];
+
+            if (shader.name == nullptr || shader.shade == nullptr) {
+                TraceLog(LOG_ERROR, "%s > shader %u has no name or shade function", file.c_str(), i);
+                continue;
+            }
+
+            // the shader of another library keeps the name, a reload of this library replaces its own
+            PluginLibrary const* owner = shaderOwner(plugin, shader.name);
+            if (shaders.count(shader.name) || (owner && owner->filepath != library.filepath)) {
+                TraceLog(LOG_WARNING, "%s > shader %s is already loaded, skipped", file.c_str(), shader.name);
+                continue;
+            }
+
+            PluginShader ps;
+            ps.shader = shader;
+            ps.state = shader.create ? shader.create() : nullptr;
+
+            shaders[shader.name] = ps;
+            library.shader_names.push_back(shader.name);
+        }
+
+        TraceLog(LOG_INFO, "%s > loaded %d plugin shaders", file.c_str(), int(library.shader_names.size()));
+        return true;
+    }
+
+    static void reloadLibrary(PluginHost& plugin, PluginLibrary& library) {
+        PluginLibrary reloaded;
+        reloaded.filepath = library.filepath;
+
+        // keep the running version if the new one doesn't load
+        std::map<std::string, PluginShader> shaders;
+        if (!loadLibrary(plugin, reloaded, shaders)) {
+            library.modified = reloaded.modified;
+            return;
+        }
+
+        std::vector<std::string> previous_names = library.shader_names;
+        unloadLibrary(plugin, library);
+
+        for (auto const& name : reloaded.shader_names)
+            if (!contains(previous_names, name))
+                TraceLog(LOG_WARNING, "%s > new shader %s, reload shaders to list it", getSimpleFileName(library.filepath).c_str(), name.c_str());
+
+        plugin.shaders.insert(shaders.begin(), shaders.end());
+        library = reloaded;
+    }
+
+    static float pluginShader(MetaShaderContext& msc, int const pin_index, Vector2 const& pin_pos, float const pin_value) {
+        PluginHost& host = *msc.plugin->host;
+        auto found = host.shaders.find(msc.shader.name);
+        if (found == host.shaders.end())
+            return 0.0f;
+
+        PluginShader& ps = found->second;
+        return ps.shader.shade(ps.state, &msc.plugin->frame, pin_index, pin_pos.x, pin_pos.y, pin_value);
+    }
+
+    static void pluginBatch(MetaShaderContext& msc, int const y, int const x_begin, int const x_end, float* const row) {
+        PluginHost& host = *msc.plugin->host;
+        auto found = host.shaders.find(msc.shader.name);
+        if (found == host.shaders.end()) {
+            std::fill(row + x_begin, row + x_end, 0.0f);
+            return;
+        }
+
+        PluginShader& ps = found->second;
+        PinWorldFrame const* frame = &msc.plugin->frame;
+
+        if (ps.shader.shade_row) {
+            ps.shader.shade_row(ps.state, frame, y, x_begin, x_end, row);
+            return;
+        }
+
+        const int row_start = y * int(frame->size_x);
+        for (int x = x_begin; x != x_end; ++x)
+            row[x] = ps.shader.shade(ps.state, frame, row_start + x, float(x), float(y), row[x]);
+    }
+
+    //
+    // plugin Meta shaders
+    //
+    void setupPluginMetaShaders(MetaShaderContext& context) {
+        // the previous plugins are unloaded first, so their state is destroyed before the new one is created
+        context.plugin.reset();
+        context.plugin = std::make_shared<MetaShaderPlugin>();
+        context.plugin->host = std::make_shared<PluginHost>();
+        PluginHost& plugin = *context.plugin->host;
+
+        std::vector<std::string> files = platformShadersFiles("plugin", PluginExtension);
+
+        for (auto const& filepath : files) {
+            PluginLibrary library;
+            library.filepath = filepath;
+
+            std::map<std::string, PluginShader> shaders;
+            if (!loadLibrary(plugin, library, shaders))
+                continue;
+
+            for (auto const& name : library.shader_names)
+                context.shaders.push_back({ name, pluginShader, pluginBatch, false, nullptr, nullptr, true });
+
+            plugin.shaders.insert(shaders.begin(), shaders.end());
+            plugin.libraries.push_back(library);
+        }
+
+        plugin.check_timer.start();
+    }
+
+    void updatePluginContextState(MetaShaderContext& context, int canvas_width, int canvas_height, float time) {
+        PinWorldFrame& frame = context.plugin->frame;
+        frame.size_x = float(canvas_width);
+        frame.size_y = float(canvas_height);
+        frame.half_size_x = canvas_width * 0.5f;
+        frame.half_size_y = canvas_height * 0.5f;
+        frame.time = time;
+    }
+
+    bool pluginMetaShadersChanged(MetaShaderContext& context) {
+        if (!context.plugin)
+            return false;
+
+        PluginHost& plugin = *context.plugin->host;
+        if (!plugin.check_timer.hasExpired(PluginCheckInterval))
+            return false;
+        plugin.check_timer.start();
+
+        bool changed = false;
+        for (auto& library : plugin.libraries) {
+            int64_t modified = 0;
+            if (!fileModificationTime(library.filepath, modified) || modified == library.modified) {
+                library.pending = false;
+                continue;
+            }
+
+            // only reload once the file stopped changing, the linker may still be writing it
+            if (!library.pending || modified != library.pending_modified) {
+                library.pending = true;
+                library.pending_modified = modified;
+                continue;
+            }
+
+            library.pending = false;
+            library.settled = true;
+            changed = true;
+        }
+
+        return changed;
+    }
+
+    void reloadPluginMetaShaders(MetaShaderContext& context) {
+        if (!context.plugin)
+            return;
+
+        PluginHost& plugin = *context.plugin->host;
+        for (auto& library : plugin.libraries) {
+            if (!library.settled)
+                continue;
+
+            TraceLog(LOG_INFO, "%s > changed, reloading", getSimpleFileName(library.filepath).c_str());
+            library.settled = false;
+            reloadLibrary(plugin, library);
+        }
+    }
+
+    void sharePluginContext(MetaShaderContext& context, MetaShaderContext const& source) {
+        if (!source.plugin) {
+            context.plugin.reset();
+            return;
+        }
+
+        if (context.plugin && context.plugin != source.plugin && context.plugin->host == source.plugin->host)
+            return;
+
+        context.plugin = std::make_shared<MetaShaderPlugin>();
+        context.plugin->host = source.plugin->host;
+    }
+}
@@ -0,0 +1,730 @@
+#include "MetaShader.hpp"
+#include "Text.hpp"
+
+//
+// pwx meta shaders
+// A small expression language compiled on load into register bytecode.
+//
+//   # comment
+//   let d = sqrt(pow(pin_pos.x - c_half_size.x, 2) + pow(pin_pos.y - c_half_size.y, 2)) / c_half_size.y
+//   smoothstep(0.3, 0.0, abs(0.7 - d)) * (sin(c_time) * 0.5 + 0.5)
+//
+// The last line is the pin height. Inputs: c_size, c_half_size, c_time, pin_pos, pin_index, pin_value.
+// Constant expressions are folded, frame and row invariant code is hoisted out of the pin loop,
+// and the pin code runs over a whole row PwxLanes pins at a time.
+//
+
+namespace pw {
+
+    constexpr int PwxLanes = 16;
+    constexpr int PwxMaxRegisters = 128;
+
+    enum class PwxOp : uint8_t {
+        Constant,
+        Input,          // frame or row input, a = input slot
+        PinX,
+        PinIndex,
+        PinValue,
+        Add,
+        Sub,
+        Mul,
+        Div,
+        Neg,
+        Sin,
+        Cos,
+        Pow,
+        Sqrt,
+        Abs,
+        Fract,
+        Min,
+        Max,
+        Smoothstep,
+    };
+
+    // when a value can be computed, everything that only depends on earlier stages is hoisted
+    enum class PwxStage : uint8_t {
+        Constant = 0,
+        Frame,
+        Row,
+        Pin,
+    };
+
+    enum PwxInput : uint8_t {
+        InputSizeX = 0,
+        InputSizeY,
+        InputHalfSizeX,
+        InputHalfSizeY,
+        InputTime,
+        InputPinY,
+        InputCount
+    };
+
+    struct PwxInstruction {
+        PwxOp op;
+        uint8_t dst;
+        uint8_t a;
+        uint8_t b;
+        uint8_t c;
+        float constant;
+    };
+
+    struct PwxProgram {
+        std::vector<PwxInstruction> frame;      // once per frame
+        std::vector<PwxInstruction> row;        // once per row
+        std::vector<PwxInstruction> pin;        // once per PwxLanes pins
+        std::vector<uint8_t> broadcast;         // uniform registers read by the pin code
+        int registers = 0;
+        int output = 0;
+        PwxStage output_stage = PwxStage::Constant;
+    };
+
+    using PwxRegisters = std::array<float, PwxMaxRegisters>;
+
+    struct PwxShader {
+        std::string file;
+        PwxProgram program;
+    };
+
+    // the compiled programs, shared by the canvases
+    struct PwxLibrary {
+        std::map<std::string, PwxShader> shaders;
+    };
+
+    // every canvas has its own
+    struct MetaShaderPwx {
+        std::shared_ptr<PwxLibrary> library;
+        std::array<float, InputCount> inputs{};
+        int canvas_width = 0;
+        std::map<std::string, PwxRegisters> frame_registers;    // results of the frame code of the shaders the canvas runs
+    };
+
+    //
+    // Compiler
+    //
+    struct PwxNode {
+        PwxOp op = PwxOp::Constant;
+        PwxStage stage = PwxStage::Constant;
+        float constant = 0.0f;
+        uint8_t input = 0;
+        std::vector<std::shared_ptr<PwxNode>> args;
+    };
+    using PwxNodePtr = std::shared_ptr<PwxNode>;
+
+    struct PwxFunction {
+        const char* name;
+        PwxOp op;
+        int arguments;
+    };
+
+    static const PwxFunction pwx_functions[] = {
+        { "sin", PwxOp::Sin, 1 },
+        { "cos", PwxOp::Cos, 1 },
+        { "pow", PwxOp::Pow, 2 },
+        { "sqrt", PwxOp::Sqrt, 1 },
+        { "abs", PwxOp::Abs, 1 },
+        { "fract", PwxOp::Fract, 1 },
+        { "min", PwxOp::Min, 2 },
+        { "max", PwxOp::Max, 2 },
+        { "smoothstep", PwxOp::Smoothstep, 3 },
+    };
+
+    static float pwxEvaluate(PwxOp op, float a, float b, float c) {
+        switch (op) {
+            case PwxOp::Add: return a + b;
+            case PwxOp::Sub: return a - b;
+            case PwxOp::Mul: return a * b;
+            case PwxOp::Div: return a / b;
+            case PwxOp::Neg: return -a;
+            case PwxOp::Sin: return std::sin(a);
+            case PwxOp::Cos: return std::cos(a);
+            case PwxOp::Pow: return std::pow(a, b);
+            case PwxOp::Sqrt: return std::sqrt(a);
+            case PwxOp::Abs: return std::fabs(a);
+            case PwxOp::Fract: return fract(a);
+            case PwxOp::Min: return minimum(a, b);
+            case PwxOp::Max: return maximum(a, b);
+            case PwxOp::Smoothstep: return smoothstep(a, b, c);
+            default: return 0.0f;
+        }
+    }
+
+    class PwxCompiler {
+    public:
+        PwxCompiler(std::string const& source)
+            :m_source(source)
+        { }
+
+        bool compile(PwxProgram& program) {
+            PwxNodePtr result;
+
+            while (!failed()) {
+                skipBlank();
+                if (m_position >= m_source.size())
+                    break;
+
+                if (result) {
+                    fail("only the last line can be an expression");
+                    break;
+                }
+
+                if (acceptWord("let")) {
+                    std::string name = identifier();
+                    if (!failed() && !accept('='))
+                        fail("expected '='");
+
+                    PwxNodePtr value = expression();
+                    if (!failed())
+                        m_bindings[name] = value;
+                } else {
+                    result = expression();
+                }
+
+                if (!failed())
+                    endOfLine();
+            }
+
+            if (!failed() && !result)
+                fail("missing output expression");
+
+            if (failed())
+                return false;
+
+            emit(program, result);
+            program.output = m_registers[result.get()];
+            program.output_stage = result->stage;
+            program.registers = m_register_count;
+
+            // uniform registers that the pin code reads have to be broadcast to the lanes
+            std::set<uint8_t> written;
+            std::set<uint8_t> broadcast;
+            for (auto const& instruction : program.pin) {
+                int count = operandCount(instruction.op);
+                const uint8_t operands[] = { instruction.a, instruction.b, instruction.c };
+                for (int i = 0; i != count; ++i)
+                    if (!written.contains(operands[i]))
+                        broadcast.insert(operands[i]);
+                written.insert(instruction.dst);
+            }
+            program.broadcast.assign(broadcast.begin(), broadcast.end());
+
+            return !failed();
+        }
+
+        bool failed() const { return !m_error.empty(); }
+
+        std::string error() const { return sfmt("line %d > %s", m_line, m_error); }
+
+    private:
+        std::string const& m_source;
+        size_t m_position = 0;
+        int m_line = 1;
+        std::string m_error;
+
+        std::map<std::string, PwxNodePtr> m_bindings;
+        std::map<PwxNode*, int> m_registers;
+        int m_register_count = 0;
+
+        static int operandCount(PwxOp op) {
+            switch (op) {
+                case PwxOp::Constant: case PwxOp::Input: case PwxOp::PinX: case PwxOp::PinIndex: case PwxOp::PinValue: return 0;
+                case PwxOp::Neg: case PwxOp::Sin: case PwxOp::Cos: case PwxOp::Sqrt: case PwxOp::Abs: case PwxOp::Fract: return 1;
+                case PwxOp::Smoothstep: return 3;
+                default: return 2;
+            }
+        }
+
+        void fail(std::string const& message) {
+            if (m_error.empty())
+                m_error = message;
+        }
+
+        //
+        // lexing
+        //
+        void skipSpaces() {
+            while (m_position < m_source.size()) {
+                char c = m_source[m_position];
+                if (c == ' ' || c == '\t' || c == '\r') {
+                    ++m_position;
+                } else if (c == '#') {
+                    while (m_position < m_source.size() && m_source[m_position] != '\n')
+                        ++m_position;
+                } else {
+                    break;
+                }
+            }
+        }
+
+        void skipBlank() {
+            skipSpaces();
+            while (m_position < m_source.size() && (m_source[m_position] == '\n' || m_source[m_position] == ';')) {
+                if (m_source[m_position] == '\n')
+                    ++m_line;
+                ++m_position;
+                skipSpaces();
+            }
+        }
+
+        void endOfLine() {
+            skipSpaces();
+            if (m_position < m_source.size() && m_source[m_position] != '\n' && m_source[m_position] != ';')
+                fail(sfmt("unexpected '%c'", m_source[m_position]));
+        }
+
+        char peek() {
+            skipSpaces();
+            return m_position < m_source.size() ? m_source[m_position] : '\0';
+        }
+
+        bool accept(char c) {
+            if (peek() != c)
+                return false;
+            ++m_position;
+            return true;
+        }
+
+        bool acceptWord(std::string const& word) {
+            skipSpaces();
+            if (m_source.compare(m_position, word.size(), word) != 0)
+                return false;
+
+            size_t end = m_position + word.size();
+            if (end < m_source.size() && (isAlphabetic(m_source[end]) || isDigit(m_source[end]) || m_source[end] == '_'))
+                return false;
+
+            m_position = end;
+            return true;
+        }
+
+        std::string identifier() {
+            skipSpaces();
+            size_t start = m_position;
+            while (m_position < m_source.size()) {
+                char c = m_source[m_position];
+                if (!(isAlphabetic(c) || c == '_' || (m_position > start && isDigit(c))))
+                    break;
+                ++m_position;
+            }
+
+            if (start == m_position)
+                fail("expected an identifier");
+
+            return m_source.substr(start, m_position - start);
+        }
+
+        //
+        // parsing, nodes are folded as soon as they are built
+        //
+        PwxNodePtr constant(float value) {
+            auto node = std::make_shared<PwxNode>();
+            node->op = PwxOp::Constant;
+            node->stage = PwxStage::Constant;
+            node->constant = value;
+            return node;
+        }
+
+        PwxNodePtr input(PwxOp op, PwxStage stage, uint8_t slot = 0) {
+            auto node = std::make_shared<PwxNode>();
+            node->op = op;
+            node->stage = stage;
+            node->input = slot;
+            return node;
+        }
+
+        PwxNodePtr operation(PwxOp op, std::vector<PwxNodePtr> args) {
+            if (failed())
+                return constant(0.0f);
+
+            PwxStage stage = PwxStage::Constant;
+            for (auto const& arg : args)
+                stage = maximum(stage, arg->stage);
+
+            if (stage == PwxStage::Constant) {
+                float values[3] = { 0.0f, 0.0f, 0.0f };
+                for (size_t i = 0; i != args.size(); ++i)
+                    values[i] = args[i]->constant;
+                return constant(pwxEvaluate(op, values[0], values[1], values[2]));
+            }
+
+            auto node = std::make_shared<PwxNode>();
+            node->op = op;
+            node->stage = stage;
+            node->args = std::move(args);
+            return node;
+        }
+
+        PwxNodePtr expression() {
+            PwxNodePtr left = term();
+            while (!failed()) {
+                if (accept('+')) left = operation(PwxOp::Add, { left, term() });
+                else if (accept('-')) left = operation(PwxOp::Sub, { left, term() });
+                else break;
+            }
+            return left;
+        }
+
+        PwxNodePtr term() {
+            PwxNodePtr left = unary();
+            while (!failed()) {
+                if (accept('*')) left = operation(PwxOp::Mul, { left, unary() });
+                else if (accept('/')) left = operation(PwxOp::Div, { left, unary() });
+                else break;
+            }
+            return left;
+        }
+
+        PwxNodePtr unary() {
+            if (accept('-'))
+                return operation(PwxOp::Neg, { unary() });
+            if (accept('+'))
+                return unary();
+            return primary();
+        }
+
+        PwxNodePtr primary() {
+            char c = peek();
+
+            if (c == '(') {
+                ++m_position;
+                PwxNodePtr value = expression();
+                if (!accept(')'))
+                    fail("expected ')'");
+                return value;
+            }
+
+            if (isDigit(c) || c == '.') {
+                const char* start = m_source.c_str() + m_position;
+                char* end = nullptr;
+                float value = std::strtof(start, &end);
+                if (end == start) {
+                    fail("invalid number");
+                    return constant(0.0f);
+                }
+                m_position += size_t(end - start);
+                return constant(value);
+            }
+
+            std::string name = identifier();
+            if (failed())
+                return constant(0.0f);
+
+            if (accept('(')) {
+                std::vector<PwxNodePtr> args;
+                if (!accept(')')) {
+                    do {
+                        args.push_back(expression());
+                    } while (!failed() && accept(','));
+
+                    if (!accept(')'))
+                        fail("expected ')'");
+                }
+
+                for (auto const& function : pwx_functions) {
+                    if (name != function.name)
+                        continue;
+
+                    if (int(args.size()) != function.arguments)
+                        fail(sfmt("%s expects %d arguments", name, function.arguments));
+
+                    return operation(function.op, args);
+                }
+
+                fail(sfmt("unknown function %s", name));
+                return constant(0.0f);
+            }
+
+            if (accept('.')) {
+                std::string field = identifier();
+                if (field != "x" && field != "y") {
+                    fail(sfmt("unknown field %s.%s", name, field));
+                    return constant(0.0f);
+                }
+
+                bool x = (field == "x");
+                if (name == "c_size") return input(PwxOp::Input, PwxStage::Frame, x ? InputSizeX : InputSizeY);
+                if (name == "c_half_size") return input(PwxOp::Input, PwxStage::Frame, x ? InputHalfSizeX : InputHalfSizeY);
+                if (name == "pin_pos") return x ? input(PwxOp::PinX, PwxStage::Pin) : input(PwxOp::Input, PwxStage::Row, InputPinY);
+
+                fail(sfmt("unknown vector %s", name));
+                return constant(0.0f);
+            }
+
+            if (name == "c_time") return input(PwxOp::Input, PwxStage::Frame, InputTime);
+            if (name == "pin_index") return input(PwxOp::PinIndex, PwxStage::Pin);
+            if (name == "pin_value") return input(PwxOp::PinValue, PwxStage::Pin);
+            if (name == "pi") return constant(PI);
+
+            auto found = m_bindings.find(name);
+            if (found != m_bindings.end())
+                return found->second;
+
+            fail(sfmt("unknown name %s", name));
+            return constant(0.0f);
+        }
+
+        //
+        // code generation, one register per node, shared nodes (let bindings) are emitted once
+        //
+        void emit(PwxProgram& program, PwxNodePtr const& node) {
+            if (m_registers.contains(node.get()) || failed())
+                return;
+
+            for (auto const& arg : node->args)
+                emit(program, arg);
+
+            if (m_register_count >= PwxMaxRegisters) {
+                fail("expression is too big");
+                return;
+            }
+
+            PwxInstruction instruction{};
+            instruction.op = node->op;
+            instruction.dst = uint8_t(m_register_count++);
+            instruction.constant = node->constant;
+            instruction.a = node->input;
+
+            uint8_t* operands[] = { &instruction.a, &instruction.b, &instruction.c };
+            for (size_t i = 0; i != node->args.size(); ++i)
+                *operands[i] = uint8_t(m_registers[node->args[i].get()]);
+
+            m_registers[node.get()] = instruction.dst;
+
+            if (node->stage == PwxStage::Pin) program.pin.push_back(instruction);
+            else if (node->stage == PwxStage::Row) program.row.push_back(instruction);
+            else program.frame.push_back(instruction);
+        }
+    };
+
+    //
+    // Interpreter
+    //
+    static void runScalar(std::vector<PwxInstruction> const& code, float* registers, float const* inputs) {
+        for (auto const& i : code) {
+            switch (i.op) {
+                case PwxOp::Constant: registers[i.dst] = i.constant; break;
+                case PwxOp::Input: registers[i.dst] = inputs[i.a]; break;
+                default: registers[i.dst] = pwxEvaluate(i.op, registers[i.a], registers[i.b], registers[i.c]); break;
+            }
+        }
+    }
+
+    struct alignas(64) PwxLaneRegisters {
+        float r[PwxMaxRegisters][PwxLanes];
+    };
+
+    #define PWX_LANES_1(expression) { float* d = lanes.r[i.dst]; float const* a = lanes.r[i.a]; for (int l = 0; l != PwxLanes; ++l) d[l] = expression; }
+    #define PWX_LANES_2(expression) { float* d = lanes.r[i.dst]; float const* a = lanes.r[i.a]; float const* b = lanes.r[i.b]; for (int l = 0; l != PwxLanes; ++l) d[l] = expression; }
+
+    static void runLanes(std::vector<PwxInstruction> const& code, PwxLaneRegisters& lanes, float const x, float const index, float const* values, int const count) {
+        for (auto const& i : code) {
+            switch (i.op) {
+                case PwxOp::PinX: for (int l = 0; l != PwxLanes; ++l) lanes.r[i.dst][l] = x + float(l); break;
+                case PwxOp::PinIndex: for (int l = 0; l != PwxLanes; ++l) lanes.r[i.dst][l] = index + float(l); break;
+                case PwxOp::PinValue: for (int l = 0; l != PwxLanes; ++l) lanes.r[i.dst][l] = (l < count) ? values[l] : 0.0f; break;
+                case PwxOp::Add: PWX_LANES_2(a[l] + b[l]); break;
+                case PwxOp::Sub: PWX_LANES_2(a[l] - b[l]); break;
+                case PwxOp::Mul: PWX_LANES_2(a[l] * b[l]); break;
+                case PwxOp::Div: PWX_LANES_2(a[l] / b[l]); break;
+                case PwxOp::Neg: PWX_LANES_1(-a[l]); break;
+                case PwxOp::Sin: PWX_LANES_1(std::sin(a[l])); break;
+                case PwxOp::Cos: PWX_LANES_1(std::cos(a[l])); break;
+                case PwxOp::Pow: PWX_LANES_2(std::pow(a[l], b[l])); break;
+                case PwxOp::Sqrt: PWX_LANES_1(std::sqrt(a[l])); break;
+                case PwxOp::Abs: PWX_LANES_1(std::fabs(a[l])); break;
+                case PwxOp::Fract: PWX_LANES_1(a[l] - std::floor(a[l])); break;
+                case PwxOp::Min: PWX_LANES_2(a[l] < b[l] ? a[l] : b[l]); break;
+                case PwxOp::Max: PWX_LANES_2(a[l] > b[l] ? a[l] : b[l]); break;
+                case PwxOp::Smoothstep: {
+                    float* d = lanes.r[i.dst];
+                    float const* e0 = lanes.r[i.a];
+                    float const* e1 = lanes.r[i.b];
+                    float const* v = lanes.r[i.c];
+                    for (int l = 0; l != PwxLanes; ++l) {
+                        float t = clampTo((v[l] - e0[l]) / (e1[l] - e0[l]), 0.0f, 1.0f);
+                        d[l] = t * t * (3.0f - 2.0f * t);
+                    }
+                    break;
+                }
+                default: break;
+            }
+        }
+    }
+
+    #undef PWX_LANES_1
+    #undef PWX_LANES_2
+
+    // evaluates count pins of row y starting at x_begin, pins[0] is pin (x_begin, y)
+    static void execute(MetaShaderPwx const& pwx, PwxProgram const& program, PwxRegisters const& frame_registers, int const y, int const x_begin, int const count, float* const pins) {
+        float inputs[InputCount];
+        std::copy(pwx.inputs.begin(), pwx.inputs.end(), inputs);
+        inputs[InputPinY] = float(y);
+
+        float registers[PwxMaxRegisters];
+        std::copy(frame_registers.begin(), frame_registers.end(), registers);
+        runScalar(program.row, registers, inputs);
+
+        if (program.output_stage != PwxStage::Pin) {
+            std::fill(pins, pins + count, registers[program.output]);
+            return;
+        }
+
+        static thread_local PwxLaneRegisters lanes;
+        for (uint8_t r : program.broadcast)
+            std::fill(lanes.r[r], lanes.r[r] + PwxLanes, registers[r]);
+
+        const float row_index = float(y * pwx.canvas_width);
+        for (int start = 0; start < count; start += PwxLanes) {
+            const int active = minimum(PwxLanes, count - start);
+            const float x = float(x_begin + start);
+
+            runLanes(program.pin, lanes, x, row_index + x, pins + start, active);
+
+            float const* output = lanes.r[program.output];
+            for (int l = 0; l != active; ++l)
+                pins[start + l] = output[l];
+        }
+    }
+
+    // the program and its frame results, false before the canvas ran the frame code
+    static bool findProgram(MetaShaderContext& msc, PwxProgram const*& program, PwxRegisters const*& frame_registers) {
+        MetaShaderPwx const& pwx = *msc.pwx;
+        auto shader = pwx.library->shaders.find(msc.shader.name);
+        auto registers = pwx.frame_registers.find(msc.shader.name);
+        if (shader == pwx.library->shaders.end() || registers == pwx.frame_registers.end())
+            return false;
+
+        program = &shader->second.program;
+        frame_registers = &registers->second;
+        return true;
+    }
+
+    static void pwxBatch(MetaShaderContext& msc, int const y, int const x_begin, int const x_end, float* const row) {
+        PwxProgram const* program = nullptr;
+        PwxRegisters const* frame_registers = nullptr;
+        if (!findProgram(msc, program, frame_registers)) {
+            std::fill(row + x_begin, row + x_end, 0.0f);
+            return;
+        }
+
+        execute(*msc.pwx, *program, *frame_registers, y, x_begin, x_end - x_begin, row + x_begin);
+    }
+
+    static float pwxPin(MetaShaderContext& msc, int const, Vector2 const& pin_pos, float const pin_value) {
+        PwxProgram const* program = nullptr;
+        PwxRegisters const* frame_registers = nullptr;
+        if (!findProgram(msc, program, frame_registers))
+            return 0.0f;
+
+        float value = pin_value;
+        execute(*msc.pwx, *program, *frame_registers, int(pin_pos.y), int(pin_pos.x), 1, &value);
+        return value;
+    }
+
+    static bool compilePwx(std::string const& filepath, PwxShader& shader) {
+        std::string source;
+        if (!readRawText(filepath, source)) {
+            TraceLog(LOG_ERROR, "%s > unable to read", shader.file.c_str());
+            return false;
+        }
+
+        PwxCompiler compiler(source);
+        if (!compiler.compile(shader.program)) {
+            TraceLog(LOG_ERROR, "%s > %s", shader.file.c_str(), compiler.error().c_str());
+            return false;
+        }
+
+        PwxProgram const& program = shader.program;
+        TraceLog(LOG_DEBUG, "%s > %d frame, %d row, %d pin instructions, %d registers", shader.file.c_str(),
+            int(program.frame.size()), int(program.row.size()), int(program.pin.size()), program.registers);
+        return true;
+    }
+
+    // a program reading pin_value carries the pins over from one frame to the next
+    static MetaShaderInfo pwxInfo(std::string const& name, PwxShader const& shader) {
+        auto const& pin = shader.program.pin;
+        bool feedback = std::any_of(pin.begin(), pin.end(), [](PwxInstruction const& instruction) { return instruction.op == PwxOp::PinValue; });
+        return { name, pwxPin, pwxBatch, false, nullptr, nullptr, feedback };
+    }
+
+    //
+    // pwx Meta shaders
+    //
+    void setupPwxMetaShaders(MetaShaderContext& context) {
+        context.pwx = std::make_shared<MetaShaderPwx>();
+        context.pwx->library = std::make_shared<PwxLibrary>();
+
+        std::vector<std::string> files = platformShadersFiles("pwx");
+
+        for (size_t i = 0; i != files.size(); ++i) {
+            std::string filepath = files[i];
+            std::string file = getSimpleFileName(files[i]);
+            std::string name = getNameLessExtension(file);
+
+            PwxShader shader;
+            shader.file = file;
+            if (!compilePwx(filepath, shader))
+                continue;
+
+            context.shaders.push_back(pwxInfo(name, shader));
+            context.pwx->library->shaders[name] = std::move(shader);
+        }
+    }
+
+    MetaShaderSwap preparePwxMetaShader(std::string const& filepath) {
+        std::string file = getSimpleFileName(filepath);
+        std::string name = getNameLessExtension(file);
+
+        if (fileType(filepath) != FileType::FileRegular) {
+            return [name](MetaShaderContext& context) {
+                context.pwx->library->shaders.erase(name);
+                return removeMetaShader(context, name);
+            };
+        }
+
+        auto shader = std::make_shared<PwxShader>();
+        shader->file = file;
+        if (!compilePwx(filepath, *shader))
+            shader.reset();
+
+        return [name, shader](MetaShaderContext& context) {
+            // keep the running version if the new one doesn't compile
+            if (!shader)
+                return false;
+
+            MetaShaderInfo info = pwxInfo(name, *shader);
+            context.pwx->library->shaders[name] = std::move(*shader);
+            replaceMetaShader(context, info);
+            return true;
+        };
+    }
+
+    void updatePwxContextState(MetaShaderContext& context, int canvas_width, int canvas_height, float time) {
+        MetaShaderPwx& pwx = *context.pwx;
+        pwx.canvas_width = canvas_width;
+        pwx.inputs[InputSizeX] = float(canvas_width);
+        pwx.inputs[InputSizeY] = float(canvas_height);
+        pwx.inputs[InputHalfSizeX] = canvas_width * 0.5f;
+        pwx.inputs[InputHalfSizeY] = canvas_height * 0.5f;
+        pwx.inputs[InputTime] = time;
+
+        auto found = pwx.library->shaders.find(context.shader.name);
+        if (found == pwx.library->shaders.end())
+            return;
+
+        PwxRegisters& frame_registers = pwx.frame_registers[context.shader.name];
+        runScalar(found->second.program.frame, frame_registers.data(), pwx.inputs.data());
+    }
+
+    void sharePwxContext(MetaShaderContext& context, MetaShaderContext const& source) {
+        if (!source.pwx) {
+            context.pwx.reset();
+            return;
+        }
+
+        if (context.pwx && context.pwx != source.pwx && context.pwx->library == source.pwx->library)
+            return;
+
+        context.pwx = std::make_shared<MetaShaderPwx>();
+        context.pwx->library = source.pwx->library;
+    }
+}
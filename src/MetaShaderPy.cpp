@@ -1,9 +1,19 @@
 #include "pocketpy.h"
 
 #include "MetaShader.hpp"
+#include "MetaShaderPyNative.hpp"
+#include "Menu.hpp"
+#include "Trace.hpp"
+
+#include <mutex>
 
 namespace pw {
 
+	// pocketpy memory pools and names are shared between vms and are not thread safe,
+	// every vm is built, called and destroyed while holding this lock.
+	// the evaluation only tries it, a frame never waits for the watcher to build a vm
+	static std::mutex s_python_mutex;
+
 	struct VMContext {
 		std::string file;
 		std::shared_ptr<pkpy::VM> vm;
@@ -12,14 +22,71 @@ namespace pw {
 
 		PyObject* c_size = nullptr;
 		PyObject* c_half_size = nullptr;
+
+		PyNativeKernel native = nullptr;	// transpiled kernel, when the script is inside the supported subset
+		PyNativeState state{};				// c_size, c_half_size and c_time the vm holds
 	};
 
-	struct MetaShaderPy {
+	// the vms, shared by the canvases
+	struct PyLibrary {
+		~PyLibrary() {
+			std::lock_guard<std::mutex> lock(s_python_mutex);
+			vmc.clear();
+		}
+
 		std::map<std::string, VMContext> vmc;
 	};
 
+	// every canvas has its own, a vm takes the state of the canvas it runs for under the lock
+	struct MetaShaderPy {
+		std::shared_ptr<PyLibrary> library;
+		PyNativeState native_state{};
+	};
+
+	static uint64_t hashSource(std::string const& text) {
+		uint64_t hash = 0xcbf29ce484222325ull;
+		for (unsigned char c : text) {
+			hash ^= c;
+			hash *= 0x100000001b3ull;
+		}
+		return hash;
+	}
+
+	// called with the lock held
+	static void updateVMState(VMContext& vmc, PyNativeState const& state) {
+		pkpy::VM* vm = vmc.vm.get();
+
+		if (vmc.c_size != nullptr) {
+			PyVec2& size = _CAST(PyVec2&, vmc.c_size);
+			size.x = state.size.x;
+			size.y = state.size.y;
+		}
+
+		if (vmc.c_half_size != nullptr) {
+			PyVec2& half_size = _CAST(PyVec2&, vmc.c_half_size);
+			half_size.x = state.half_size.x;
+			half_size.y = state.half_size.y;
+		}
+
+		vm->_main->attr().set("c_time", VAR(state.time));
+		vmc.state = state;
+	}
+
+	// the vm of the shader with the state of the canvas, it may have run for another canvas since. called with the lock held
+	static VMContext& canvasVM(MetaShaderContext& msc) {
+		VMContext& vmc = msc.py->library->vmc[msc.shader.name];
+		PyNativeState const& state = msc.py->native_state;
+		if (vmc.vm && (vmc.state.time != state.time || vmc.state.size.x != state.size.x || vmc.state.size.y != state.size.y))
+			updateVMState(vmc, state);
+		return vmc;
+	}
+
 	static float python(MetaShaderContext& msc, int const pin_index, Vector2 const& pin_pos, float const pin_value) {
-		auto& vmc = msc.py->vmc[msc.shader.name];
+		std::unique_lock<std::mutex> lock(s_python_mutex, std::try_to_lock);
+		if (!lock.owns_lock())
+			return pin_value;
+
+		auto& vmc = canvasVM(msc);
 		pkpy::VM* vm = vmc.vm.get();
 
 		if (vmc.error.empty()) {
@@ -38,6 +105,94 @@ namespace pw {
 		return 0.0f;
 	}
 
+	// one lock per row. while the watcher builds a vm the row keeps its pins, the frame doesn't wait for the build
+	static void pythonBatch(MetaShaderContext& msc, int const y, int const x_begin, int const x_end, float* const row) {
+		std::unique_lock<std::mutex> lock(s_python_mutex, std::try_to_lock);
+		if (!lock.owns_lock())
+			return;
+
+		auto& vmc = canvasVM(msc);
+		if (!vmc.error.empty()) {
+			std::fill(row + x_begin, row + x_end, 0.0f);
+			return;
+		}
+
+		pkpy::VM* vm = vmc.vm.get();
+		const int row_start = y * int(msc.py->native_state.size.x);
+
+		int x = x_begin;
+		try {
+			for (; x != x_end; ++x) {
+				PyVec2 pos(Vec2{ float(x), float(y) });
+				PyObject* result = vm->call(vmc.meta_shade, VAR(row_start + x), VAR(pos), VAR(row[x]));
+				row[x] = CAST(float, result);
+			}
+		} catch (pkpy::Exception& e) {
+			vmc.error = e.msg.c_str();
+			TraceLog(LOG_ERROR, "python %s", e.msg.c_str());
+			std::fill(row + x, row + x_end, 0.0f);
+		}
+	}
+
+	static void pythonNative(MetaShaderContext& msc, int const y, int const x_begin, int const x_end, float* const row) {
+		auto& vmc = msc.py->library->vmc[msc.shader.name];
+		vmc.native(msc.py->native_state, y, x_begin, x_end, row);
+	}
+
+	//
+	// samples the canvas at a few points in time and compares the transpiled kernel against the interpreter
+	//
+	static bool checkNativeEquivalence(VMContext& vmc) {
+		constexpr float tolerance = 1e-3f;
+		constexpr int step = 8;
+		constexpr float pin_value = 0.25f;
+		const float times[] = { 0.0f, 1.7f, 13.3f };
+
+		const int w = CANVAS_WIDTH;
+		const int h = CANVAS_HEIGHT;
+
+		PyNativeState state;
+		state.size = { float(w), float(h) };
+		state.half_size = { float(w) / 2.0f, float(h) / 2.0f };
+
+		pkpy::VM* vm = vmc.vm.get();
+		std::vector<float> row(w, pin_value);
+		float max_error = 0.0f;
+
+		for (float time : times) {
+			state.time = time;
+			updateVMState(vmc, state);
+
+			for (int y = 0; y < h; y += step) {
+				for (int x = 0; x < w; x += step) {
+					float interpreted = 0.0f;
+					try {
+						PyVec2 pos(Vec2{ float(x), float(y) });
+						PyObject* result = vm->call(vmc.meta_shade, VAR(y * w + x), VAR(pos), VAR(pin_value));
+						interpreted = CAST(float, result);
+					} catch (pkpy::Exception& e) {
+						TraceLog(LOG_WARNING, "%s > interpreter failed while checking the native kernel %s", vmc.file.c_str(), e.msg.c_str());
+						return false;
+					}
+
+					row[x] = pin_value;
+					vmc.native(state, y, x, x + 1, row.data());
+
+					float error = absolute(clampTo(row[x], 0.0f, 1.0f) - clampTo(interpreted, 0.0f, 1.0f));
+					max_error = maximum(max_error, error);
+				}
+			}
+		}
+
+		if (max_error > tolerance) {
+			TraceLog(LOG_WARNING, "%s > native kernel differs from the interpreter (max error %f), using the interpreter", vmc.file.c_str(), max_error);
+			return false;
+		}
+
+		TraceLog(LOG_INFO, "%s > using native kernel (max error %f)", vmc.file.c_str(), max_error);
+		return true;
+	}
+
 	static void configureVM(VMContext& vmc) {
 		pkpy::VM* vm = vmc.vm.get();
 
@@ -56,79 +211,146 @@ namespace pw {
 
 	}
 
-	void setupPyMetaShaders(MetaShaderContext& context) {
-		context.py = std::make_shared<MetaShaderPy>();
+	static std::vector<PyNativeShader> nativeShaders() {
+		std::vector<PyNativeShader> natives;
+#if defined(PINWORLD_PY_NATIVE)
+		registerPyNativeShaders(natives);
+#endif
+		return natives;
+	}
 
-		std::vector<std::string> files = platformShadersFiles("py");
+	static bool buildVM(std::string const& filepath, std::vector<PyNativeShader> const& natives, VMContext& vmc) {
+		PW_TRACE_ZONE("python vm");
 
-		// generate vms
-		for (size_t i = 0; i != files.size(); ++i) {
-			std::string filepath = files[i];
-			std::string file = getSimpleFileName(files[i]);
-			std::string name = getNameLessExtension(file);
+		std::string file = getSimpleFileName(filepath);
+		std::string name = getNameLessExtension(file);
 
-			std::string python_code;
-			readRawText(filepath, python_code);
+		std::string python_code;
+		readRawText(filepath, python_code);
 
-			VMContext vmc;
-			vmc.file = file;
-			vmc.vm = std::make_shared<pkpy::VM>();
+		vmc.file = file;
+		vmc.vm = std::make_shared<pkpy::VM>();
 
-			configureVM(vmc);
+		configureVM(vmc);
 
-			vmc.vm->exec(python_code, file, EXEC_MODE);
+		vmc.vm->exec(python_code, file, EXEC_MODE);
 
-			vmc.meta_shade = vmc.vm->_main->attr().try_get("meta_shade");
-			vmc.c_size = vmc.vm->_main->attr().try_get("c_size");
-			vmc.c_half_size = vmc.vm->_main->attr().try_get("c_half_size");
-			PyObject* c_time = vmc.vm->_main->attr().try_get("c_time");
+		vmc.meta_shade = vmc.vm->_main->attr().try_get("meta_shade");
+		vmc.c_size = vmc.vm->_main->attr().try_get("c_size");
+		vmc.c_half_size = vmc.vm->_main->attr().try_get("c_half_size");
+		PyObject* c_time = vmc.vm->_main->attr().try_get("c_time");
 
-			if (vmc.meta_shade == nullptr) {
-				TraceLog(LOG_ERROR, "%s > meta_shade function not found", file.c_str());
-				continue;
-			}
+		if (vmc.meta_shade == nullptr) {
+			TraceLog(LOG_ERROR, "%s > meta_shade function not found", file.c_str());
+			return false;
+		}
 
-			if (vmc.c_size == nullptr) {
-				TraceLog(LOG_ERROR, "%s > c_size not found", file.c_str());
-				continue;
-			}
+		if (vmc.c_size == nullptr) {
+			TraceLog(LOG_ERROR, "%s > c_size not found", file.c_str());
+			return false;
+		}
 
-			if (vmc.c_half_size == nullptr) {
-				TraceLog(LOG_ERROR, "%s > c_half_size not found", file.c_str());
-				continue;
+		if (vmc.c_half_size == nullptr) {
+			TraceLog(LOG_ERROR, "%s > c_half_size not found", file.c_str());
+			return false;
+		}
+
+		if (c_time == nullptr) {
+			TraceLog(LOG_ERROR, "%s > c_time not found", file.c_str());
+			return false;
+		}
+
+		// a native kernel is only valid for the exact source it was generated from
+		uint64_t source_hash = hashSource(python_code);
+		for (auto const& native : natives) {
+			if (native.name == name && native.source_hash == source_hash) {
+				vmc.native = native.kernel;
+				if (!checkNativeEquivalence(vmc))
+					vmc.native = nullptr;
 			}
+		}
+
+		return true;
+	}
+
+	void setupPyMetaShaders(MetaShaderContext& context) {
+		context.py = std::make_shared<MetaShaderPy>();
+		context.py->library = std::make_shared<PyLibrary>();
 
-			if (c_time == nullptr) {
-				TraceLog(LOG_ERROR, "%s > c_time not found", file.c_str());
+		std::vector<std::string> files = platformShadersFiles("py");
+		std::vector<PyNativeShader> natives = nativeShaders();
+
+		// generate vms
+		for (size_t i = 0; i != files.size(); ++i) {
+			std::string name = getNameLessExtension(getSimpleFileName(files[i]));
+
+			std::lock_guard<std::mutex> lock(s_python_mutex);
+			VMContext vmc;
+			if (!buildVM(files[i], natives, vmc))
 				continue;
-			}
 
 			// if we reached this point, everything is ok and we can register this shader
-			context.py->vmc[name] = vmc;
-			context.shaders.push_back({ name, python });
+			context.py->library->vmc[name] = vmc;
+			context.shaders.push_back({ name, python, vmc.native ? pythonNative : pythonBatch, false, nullptr, nullptr, true });
 		}
 	}
 
-	void updatePyContextState(MetaShaderContext& context, int canvas_width, int canvas_height, float time) {
-		auto found = context.py->vmc.find(context.shader.name);
-		if (found == context.py->vmc.end())
-			return;
+	MetaShaderSwap preparePyMetaShader(std::string const& filepath) {
+		std::string name = getNameLessExtension(getSimpleFileName(filepath));
 
-		VMContext& vmc = context.py->vmc[context.shader.name];
-		pkpy::VM* vm = vmc.vm.get();		
+		if (fileType(filepath) != FileType::FileRegular) {
+			return [name](MetaShaderContext& context) {
+				std::lock_guard<std::mutex> lock(s_python_mutex);
+				context.py->library->vmc.erase(name);
+				return removeMetaShader(context, name);
+			};
+		}
 
-		if (vmc.c_size != nullptr) {
-			PyVec2& size = _CAST(PyVec2&, vmc.c_size);
-			size.x = float(canvas_width);
-			size.y = float(canvas_height);
+		// a swap that is dropped without being applied still destroys its vm under the lock
+		std::shared_ptr<VMContext> vmc(new VMContext(), [](VMContext* unused) {
+			std::lock_guard<std::mutex> lock(s_python_mutex);
+			delete unused;
+		});
+
+		bool built = false;
+		{
+			std::lock_guard<std::mutex> lock(s_python_mutex);
+			built = buildVM(filepath, nativeShaders(), *vmc);
 		}
+		if (!built)
+			vmc.reset();
+
+		return [name, vmc](MetaShaderContext& context) {
+			// keep the running version if the new one doesn't build
+			if (!vmc)
+				return false;
+
+			std::lock_guard<std::mutex> lock(s_python_mutex);
+			context.py->library->vmc[name] = *vmc;
+			vmc->vm.reset();
+			replaceMetaShader(context, { name, python, vmc->native ? pythonNative : pythonBatch, false, nullptr, nullptr, true });
+			return true;
+		};
+	}
 
-		if (vmc.c_half_size != nullptr) {
-			PyVec2& half_size = _CAST(PyVec2&, vmc.c_half_size);
-			half_size.x = float(canvas_width) / 2.0f;
-			half_size.y = float(canvas_height) / 2.0f;
+	// the vms are shared and only take the state when they run for the canvas
+	void updatePyContextState(MetaShaderContext& context, int canvas_width, int canvas_height, float time) {
+		PyNativeState& state = context.py->native_state;
+		state.size = { float(canvas_width), float(canvas_height) };
+		state.half_size = { float(canvas_width) / 2.0f, float(canvas_height) / 2.0f };
+		state.time = time;
+	}
+
+	void sharePyContext(MetaShaderContext& context, MetaShaderContext const& source) {
+		if (!source.py) {
+			context.py.reset();
+			return;
 		}
 
-		vm->_main->attr().set("c_time", VAR(time));
+		if (context.py && context.py != source.py && context.py->library == source.py->library)
+			return;
+
+		context.py = std::make_shared<MetaShaderPy>();
+		context.py->library = source.py->library;
 	}
 }
\ No newline at end of file
@@ -0,0 +1,28 @@
+#pragma once
+
+#include "MetaShader.hpp"
+
+namespace pw {
+
+    //
+    // Native kernels generated at build time from py/*.py by tools/py2cpp.py
+    //
+
+    // python context variables, constant during a frame run
+    struct PyNativeState {
+        Vector2 size;                       // c_size
+        Vector2 half_size;                  // c_half_size
+        float time;                         // c_time
+    };
+
+    // evaluates the pins [x_begin, x_end) of row y, row points to the first pin of the row
+    typedef void(*PyNativeKernel)(PyNativeState const&, int const y, int const x_begin, int const x_end, float* const row);
+
+    struct PyNativeShader {
+        std::string name;                   // script name without extension
+        uint64_t source_hash;               // fnv1a of the script the kernel was generated from
+        PyNativeKernel kernel;
+    };
+
+    void registerPyNativeShaders(std::vector<PyNativeShader>& shaders);
+}
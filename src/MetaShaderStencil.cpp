@@ -0,0 +1,192 @@
+#include "MetaShader.hpp"
+#include "Jobs.hpp"
+
+namespace pw {
+
+    // canvas blocks stepped by one job, a block and its halo stay in the L1 cache
+    constexpr int StencilBlockWidth = 64;
+    constexpr int StencilBlockHeight = 16;
+    constexpr int StencilHaloWidth = StencilBlockWidth + 2 * StencilRadius;
+    constexpr int StencilHaloHeight = StencilBlockHeight + 2 * StencilRadius;
+
+    // wave equation, squared speed in pins per step. above 0.5 the explicit step blows up
+    constexpr float RippleSpeed = 0.3f;
+
+    // part of the velocity kept every step
+    constexpr float RippleDamping = 0.995f;
+
+    // height of the still surface, the weak pull makes up for the volume the drops lose on the pins grid
+    constexpr float RippleRest = 0.5f;
+    constexpr float RippleRestPull = 0.0001f;
+
+    // a drop falls every few steps at a random place
+    constexpr uint32_t RippleDropSteps = 20;
+    constexpr float RippleDropDepth = 0.4f;
+
+    // the last three steps of the simulation, rotated so the newest is fields[current]
+    struct MetaShaderStencil {
+        MetaShaderStencilFunction function = nullptr;   // shader the fields belong to
+        int width = 0;
+        int height = 0;
+        uint32_t step = 0;
+
+        std::vector<float> fields[3];
+        int current = 0;
+    };
+
+    // the last step, or the pin as is when the simulation didn't run
+    static float stencilPin(MetaShaderContext& msc, int const pin_index, Vector2 const&, float const pin_value) {
+        MetaShaderStencil const& stencil = *msc.stencil;
+        std::vector<float> const& field = stencil.fields[stencil.current];
+        return (stencil.function == msc.shader.stencil && pin_index < int(field.size())) ? field[pin_index] : pin_value;
+    }
+
+    //
+    // Wave equation with damping, the heights of the last two steps give the velocity
+    //
+    static void rippleStencil(MetaShaderContext&, StencilBlock const& block, float* const next, int const next_stride) {
+        int const stride = block.stride;
+
+        // still water whatever was on screen
+        if (block.step == 0) {
+            for (int y = 0; y != block.height; ++y)
+                for (int x = 0; x != block.width; ++x)
+                    next[y * next_stride + x] = RippleRest;
+            return;
+        }
+
+        for (int y = 0; y != block.height; ++y) {
+            float const* c = block.current + y * stride;
+            float const* p = block.previous + y * stride;
+            float* out = next + y * next_stride;
+
+            for (int x = 0; x != block.width; ++x) {
+                float laplacian = c[x - 1] + c[x + 1] + c[x - stride] + c[x + stride] - 4.0f * c[x];
+                float velocity = (c[x] - p[x]) * RippleDamping;
+                out[x] = c[x] + velocity + laplacian * RippleSpeed + (RippleRest - c[x]) * RippleRestPull;
+            }
+        }
+
+        if (block.step % RippleDropSteps != 0)
+            return;
+
+        // every block finds the same drop, only the ones it touches add it.
+        // the drop pushes the middle down and the rim up by the same volume, the surface stays at rest height on average
+        uint32_t drop = block.step / RippleDropSteps;
+        uint32_t seed = randomSeed();
+        float drop_x = hashUniform(seed, 0, drop) * block.canvas_width;
+        float drop_y = hashUniform(seed, 1, drop) * block.canvas_height;
+        float radius = maximum(2.0f, block.canvas_height / 40.0f);
+
+        int x_begin = maximum(block.x, int(drop_x - radius));
+        int x_end = minimum(block.x + block.width, int(drop_x + radius) + 1);
+        int y_begin = maximum(block.y, int(drop_y - radius));
+        int y_end = minimum(block.y + block.height, int(drop_y + radius) + 1);
+
+        for (int y = y_begin; y < y_end; ++y) {
+            float* out = next + (y - block.y) * next_stride - block.x;
+            for (int x = x_begin; x < x_end; ++x) {
+                float dx = (float(x) - drop_x) / radius;
+                float dy = (float(y) - drop_y) / radius;
+                float d2 = dx * dx + dy * dy;
+                if (d2 < 1.0f)
+                    out[x] -= RippleDropDepth * (1.0f - d2) * (1.0f - d2) * (1.0f - 4.0f * d2);
+            }
+        }
+    }
+
+    //
+    // stepping
+    //
+
+    // copies the block and its halo out of a field, the halo past the canvas edges repeats the edge pins
+    static void gatherBlock(float const* field, int width, int height, int x_begin, int y_begin, int block_width, int block_height, float* block) {
+        for (int y = 0; y != block_height + 2 * StencilRadius; ++y) {
+            int field_y = clampTo(y_begin + y - StencilRadius, 0, height - 1);
+            float const* row = field + field_y * width;
+            float* out = block + y * StencilHaloWidth;
+
+            for (int x = 0; x != block_width + 2 * StencilRadius; ++x)
+                out[x] = row[clampTo(x_begin + x - StencilRadius, 0, width - 1)];
+        }
+    }
+
+    void evaluateStencilMetaShader(MetaShaderContext& context, float* pins, int canvas_width, int canvas_height) {
+        MetaShaderStencil& stencil = *context.stencil;
+        MetaShaderStencilFunction function = context.shader.stencil;
+        size_t count = size_t(canvas_width) * canvas_height;
+
+        // the simulation starts over, step 0 of the stencil writes the initial state and may read the pins on screen.
+        // Wave Ripples doesn't, it starts from still water
+        if (stencil.function != function || stencil.width != canvas_width || stencil.height != canvas_height) {
+            stencil.function = function;
+            stencil.width = canvas_width;
+            stencil.height = canvas_height;
+            stencil.step = 0;
+            for (auto& field : stencil.fields)
+                field.assign(pins, pins + count);
+        }
+
+        float const* current = stencil.fields[stencil.current].data();
+        float const* previous = stencil.fields[(stencil.current + 2) % 3].data();
+        float* next = stencil.fields[(stencil.current + 1) % 3].data();
+        uint32_t step = stencil.step;
+
+        int blocks_x = (canvas_width + StencilBlockWidth - 1) / StencilBlockWidth;
+        int blocks_y = (canvas_height + StencilBlockHeight - 1) / StencilBlockHeight;
+
+        // blocks only read the last steps and write their own pins of the next one, so they don't wait on each other
+        parallelFor(JobSystem::shared(), blocks_x * blocks_y, [&context, function, current, previous, next, step, canvas_width, canvas_height, blocks_x](int index) {
+            float current_block[StencilHaloWidth * StencilHaloHeight];
+            float previous_block[StencilHaloWidth * StencilHaloHeight];
+
+            StencilBlock block;
+            block.x = (index % blocks_x) * StencilBlockWidth;
+            block.y = (index / blocks_x) * StencilBlockHeight;
+            block.width = minimum(StencilBlockWidth, canvas_width - block.x);
+            block.height = minimum(StencilBlockHeight, canvas_height - block.y);
+            block.canvas_width = canvas_width;
+            block.canvas_height = canvas_height;
+            block.step = step;
+            block.stride = StencilHaloWidth;
+
+            gatherBlock(current, canvas_width, canvas_height, block.x, block.y, block.width, block.height, current_block);
+            gatherBlock(previous, canvas_width, canvas_height, block.x, block.y, block.width, block.height, previous_block);
+
+            int const first = StencilRadius * StencilHaloWidth + StencilRadius;
+            block.current = current_block + first;
+            block.previous = previous_block + first;
+
+            function(context, block, next + block.y * canvas_width + block.x, canvas_width);
+        });
+
+        stencil.current = (stencil.current + 1) % 3;
+        stencil.step++;
+
+        // the first step is the initial state, it doesn't move yet
+        if (step == 0) {
+            for (auto& field : stencil.fields)
+                if (field.data() != next)
+                    memcpy(field.data(), next, count * sizeof(float));
+        }
+
+        memcpy(pins, next, count * sizeof(float));
+    }
+
+    //
+    // stencil Meta shaders
+    //
+    void setupStencilMetaShaders(MetaShaderContext& context) {
+        context.stencil = std::make_shared<MetaShaderStencil>();
+
+        context.shaders.push_back({ "Wave Ripples", stencilPin, nullptr, false, rippleStencil });
+    }
+
+    void shareStencilContext(MetaShaderContext& context, MetaShaderContext const& source) {
+        // every canvas steps its own simulation
+        if (!source.stencil)
+            context.stencil.reset();
+        else if (!context.stencil || context.stencil == source.stencil)
+            context.stencil = std::make_shared<MetaShaderStencil>();
+    }
+}
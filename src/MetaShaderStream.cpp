@@ -0,0 +1,273 @@
+#include "MetaShader.hpp"
+#include "PinWorldStream.h"
+
+#if !defined(_WIN32) && !defined(__EMSCRIPTEN__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define PW_STREAMS
+#endif
+
+namespace pw {
+
+    // how often a missing stream is looked for, and an attached one is checked for a newer object
+    constexpr int64_t StreamCheckInterval = 1000;
+
+    struct MetaShaderStream {
+        ~MetaShaderStream();
+
+        std::string name;
+        ElapsedTimer check_timer;
+
+        // the mapped object
+        PinWorldStreamHeader* header = nullptr;
+        size_t size = 0;
+        uint64_t inode = 0;
+
+        // the layout validated at attach, the producer may write anything in the header afterwards
+        uint32_t width = 0;
+        uint32_t height = 0;
+        uint32_t format = 0;
+        uint32_t slot_count = 0;
+        uint64_t slot_size = 0;
+        uint64_t data_offset = 0;
+
+        // the claimed frame, read in place by the shader
+        uint8_t const* frame = nullptr;
+        uint64_t sequence = 0;
+
+        // stream pins of every canvas pin
+        int canvas_width = 0;
+        int canvas_height = 0;
+        std::vector<uint32_t> columns;
+        std::vector<uint32_t> rows;
+    };
+
+    static float streamPin(MetaShaderContext& msc, int const pin_index, Vector2 const& pin_pos, float const pin_value);
+
+#if defined(PW_STREAMS)
+
+    static void detachStream(MetaShaderStream& stream) {
+        if (stream.header) {
+            pinworld_stream_release(stream.header);
+            munmap(stream.header, stream.size);
+        }
+
+        stream.header = nullptr;
+        stream.size = 0;
+        stream.inode = 0;
+        stream.width = 0;
+        stream.height = 0;
+        stream.format = 0;
+        stream.slot_count = 0;
+        stream.slot_size = 0;
+        stream.data_offset = 0;
+        stream.frame = nullptr;
+        stream.sequence = 0;
+        stream.canvas_width = 0;
+        stream.canvas_height = 0;
+    }
+
+    // maps the object when its header is complete and fits its size
+    static bool attachStream(MetaShaderStream& stream) {
+        int fd = shm_open(stream.name.c_str(), O_RDWR, 0);
+        if (fd < 0)
+            return false;
+
+        struct stat info;
+        void* memory = MAP_FAILED;
+        if (fstat(fd, &info) == 0 && size_t(info.st_size) >= sizeof(PinWorldStreamHeader))
+            memory = mmap(nullptr, size_t(info.st_size), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        close(fd);
+
+        if (memory == MAP_FAILED)
+            return false;
+
+        // the layout is read once, what is validated is what is used
+        PinWorldStreamHeader* header = (PinWorldStreamHeader*)memory;
+        size_t size = size_t(info.st_size);
+        bool valid = __atomic_load_n(&header->magic, __ATOMIC_ACQUIRE) == PINWORLD_STREAM_MAGIC
+            && header->version == PINWORLD_STREAM_VERSION;
+
+        uint32_t width = header->width;
+        uint32_t height = header->height;
+        uint32_t format = header->format;
+        uint32_t slot_count = header->slot_count;
+        uint64_t slot_size = header->slot_size;
+        uint64_t data_offset = header->data_offset;
+
+        valid = valid
+            && width > 0 && height > 0
+            && format <= PINWORLD_STREAM_UINT16
+            && slot_count >= PINWORLD_STREAM_MIN_SLOTS && slot_count <= PINWORLD_STREAM_MAX_SLOTS
+            && slot_size >= pinworld_stream_slot_size(width, height, format)
+            && data_offset >= sizeof(PinWorldStreamHeader)
+            && data_offset + slot_size * slot_count <= size;
+
+        if (!valid) {
+            munmap(memory, size);
+            return false;
+        }
+
+        stream.header = header;
+        stream.size = size;
+        stream.inode = uint64_t(info.st_ino);
+        stream.width = width;
+        stream.height = height;
+        stream.format = format;
+        stream.slot_count = slot_count;
+        stream.slot_size = slot_size;
+        stream.data_offset = data_offset;
+
+        TraceLog(LOG_INFO, "%s > stream attached, %ux%u pins, %u slots", stream.name.c_str(), width, height, slot_count);
+        return true;
+    }
+
+    // true when the name now refers to another object, a producer that restarted made a new one
+    static bool streamReplaced(MetaShaderStream const& stream) {
+        int fd = shm_open(stream.name.c_str(), O_RDONLY, 0);
+        if (fd < 0)
+            return true;
+
+        struct stat info;
+        bool replaced = fstat(fd, &info) != 0 || uint64_t(info.st_ino) != stream.inode;
+        close(fd);
+        return replaced;
+    }
+
+    MetaShaderStream::~MetaShaderStream() {
+        detachStream(*this);
+    }
+
+#else
+
+    MetaShaderStream::~MetaShaderStream() { }
+
+#endif
+
+    void updateStreamContextState(MetaShaderContext& context, int canvas_width, int canvas_height, float) {
+#if defined(PW_STREAMS)
+        MetaShaderStream& stream = *context.stream;
+
+        // nothing is mapped until the stream is shown, the last frame stays claimed while another shader runs
+        if (context.shader.function != streamPin)
+            return;
+
+        if (stream.check_timer.hasExpired(StreamCheckInterval) || !stream.check_timer.isValid()) {
+            stream.check_timer.start();
+            if (stream.header && streamReplaced(stream)) {
+                TraceLog(LOG_INFO, "%s > stream replaced, attaching again", stream.name.c_str());
+                detachStream(stream);
+            }
+            if (!stream.header)
+                attachStream(stream);
+        }
+
+        if (!stream.header)
+            return;
+
+        // a slot outside the validated ones is skipped like a missing frame
+        uint64_t latest = pinworld_stream_claim(stream.header);
+        if (latest == 0 || pinworld_stream_slot(latest) >= stream.slot_count) {
+            stream.frame = nullptr;
+            return;
+        }
+
+        stream.sequence = pinworld_stream_sequence(latest);
+        stream.frame = (uint8_t const*)stream.header + stream.data_offset + pinworld_stream_slot(latest) * stream.slot_size;
+
+        // the stream is stretched over the canvas, nearest pin
+        if (stream.canvas_width != canvas_width || stream.canvas_height != canvas_height) {
+            stream.canvas_width = canvas_width;
+            stream.canvas_height = canvas_height;
+
+            stream.columns.resize(canvas_width);
+            for (int x = 0; x != canvas_width; ++x)
+                stream.columns[x] = uint32_t(uint64_t(x) * stream.width / canvas_width);
+
+            stream.rows.resize(canvas_height);
+            for (int y = 0; y != canvas_height; ++y)
+                stream.rows[y] = uint32_t(uint64_t(y) * stream.height / canvas_height);
+        }
+#endif
+    }
+
+    static float streamPin(MetaShaderContext& msc, int const, Vector2 const& pin_pos, float const pin_value) {
+        MetaShaderStream const& stream = *msc.stream;
+        if (!stream.frame)
+            return pin_value;
+
+        int x = clampTo(int(pin_pos.x), 0, stream.canvas_width - 1);
+        int y = clampTo(int(pin_pos.y), 0, stream.canvas_height - 1);
+        size_t index = size_t(stream.rows[y]) * stream.width + stream.columns[x];
+
+        switch (stream.format) {
+        case PINWORLD_STREAM_UINT8: return stream.frame[index] * (1.0f / 255.0f);
+        case PINWORLD_STREAM_UINT16: return ((uint16_t const*)stream.frame)[index] * (1.0f / 65535.0f);
+        default: return ((float const*)stream.frame)[index];
+        }
+    }
+
+    template<typename T>
+    static void streamRow(MetaShaderStream const& stream, T const* source, float scale, int const x_begin, int const x_end, float* const row) {
+        uint32_t const* columns = stream.columns.data();
+        for (int x = x_begin; x != x_end; ++x)
+            row[x] = source[columns[x]] * scale;
+    }
+
+    // the pins are read straight from the shared slot into the upload buffer
+    static void streamBatch(MetaShaderContext& msc, int const y, int const x_begin, int const x_end, float* const row) {
+        MetaShaderStream const& stream = *msc.stream;
+        if (!stream.frame)
+            return;
+
+        size_t first = size_t(stream.rows[y]) * stream.width;
+        switch (stream.format) {
+        case PINWORLD_STREAM_UINT8:
+            streamRow(stream, stream.frame + first, 1.0f / 255.0f, x_begin, x_end, row);
+            break;
+        case PINWORLD_STREAM_UINT16:
+            streamRow(stream, (uint16_t const*)stream.frame + first, 1.0f / 65535.0f, x_begin, x_end, row);
+            break;
+        default: {
+            float const* source = (float const*)stream.frame + first;
+            if (int(stream.width) == stream.canvas_width) {
+                memcpy(row + x_begin, source + x_begin, size_t(x_end - x_begin) * sizeof(float));
+            } else {
+                streamRow(stream, source, 1.0f, x_begin, x_end, row);
+            }
+            break;
+        }
+        }
+    }
+
+    //
+    // stream Meta shaders
+    //
+    void setupStreamMetaShaders(MetaShaderContext& context) {
+#if defined(PW_STREAMS)
+        context.stream = std::make_shared<MetaShaderStream>();
+
+        const char* name = getenv("PINWORLD_STREAM");
+        context.stream->name = name ? name : PINWORLD_STREAM_DEFAULT_NAME;
+
+        context.shaders.push_back({ "Stream", streamPin, streamBatch, true, nullptr, nullptr, true });
+#endif
+    }
+
+    void shareStreamContext(MetaShaderContext& context, MetaShaderContext const& source) {
+        if (!source.stream) {
+            context.stream.reset();
+            return;
+        }
+
+        // every canvas maps the object and claims its frames, the ring has a single reader slot
+        // so a canvas may read a slot the producer is rewriting while another canvas holds the claim
+        if (context.stream && context.stream != source.stream && context.stream->name == source.stream->name)
+            return;
+
+        context.stream = std::make_shared<MetaShaderStream>();
+        context.stream->name = source.stream->name;
+    }
+}
@@ -0,0 +1,70 @@
+#include "MetaShaderWatcher.hpp"
+#include "Text.hpp"
+#include "Trace.hpp"
+
+namespace pw {
+
+    MetaShaderWatcher::MetaShaderWatcher() 
+    { }
+
+    MetaShaderWatcher::~MetaShaderWatcher() {
+        stop();
+    }
+
+    void MetaShaderWatcher::start() {
+        std::vector<std::string> folders;
+        for (auto const& kind : { "py", "pwx", "gif", "comp" })
+            for (auto const& folder : platformShadersFolders(kind))
+                if (fileType(folder) == FileType::FileDirectory)
+                    folders.push_back(folder);
+
+        m_watcher.start(folders, [this](std::vector<std::string> const& changed) { prepare(changed); });
+    }
+
+    void MetaShaderWatcher::stop() {
+        m_watcher.stop();
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_swaps.clear();
+    }
+
+    void MetaShaderWatcher::prepare(std::vector<std::string> const& changed) {
+        for (auto const& filepath : changed) {
+            // anything else in the folders, like editor backups, is ignored
+            if (!endsWith(filepath, ".py") && !endsWith(filepath, ".pwx") && !endsWith(filepath, ".gif") && !endsWith(filepath, ".comp"))
+                continue;
+
+            TraceLog(LOG_INFO, "%s > changed, reloading", getSimpleFileName(filepath).c_str());
+            PW_TRACE_ZONE("reload");
+
+            MetaShaderSwap swap;
+            if (endsWith(filepath, ".py")) swap = preparePyMetaShader(filepath);
+            else if (endsWith(filepath, ".pwx")) swap = preparePwxMetaShader(filepath);
+            else if (endsWith(filepath, ".comp")) swap = prepareCompositionMetaShader(filepath);
+            else swap = prepareGifMetaShader(filepath);
+
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_swaps.push_back(swap);
+        }
+    }
+
+    bool MetaShaderWatcher::pending() {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return !m_swaps.empty();
+    }
+
+    bool MetaShaderWatcher::apply(MetaShaderContext& context) {
+        std::vector<MetaShaderSwap> swaps;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            swaps.swap(m_swaps);
+        }
+
+        bool updated = false;
+        for (auto const& swap : swaps)
+            if (swap(context))
+                updated = true;
+
+        return updated;
+    }
+}
@@ -0,0 +1,36 @@
+#pragma once
+
+#include "MetaShader.hpp"
+#include "FileWatcher.hpp"
+
+#include <mutex>
+
+namespace pw {
+
+    //
+    // Rebuilds changed py, pwx, gif and comp shaders on the file watcher thread.
+    // The rebuilt shaders are only swapped in by apply(), at a frame boundary on the main thread.
+    //
+    class MetaShaderWatcher {
+    public:
+        MetaShaderWatcher();
+        ~MetaShaderWatcher();
+
+        void start();
+        void stop();
+
+        // true when rebuilt shaders are waiting for apply
+        bool pending();
+
+        // swaps in the shaders that are ready, returns true when the shaders list was updated
+        bool apply(MetaShaderContext& context);
+    private:
+        FileWatcher m_watcher;
+
+        std::mutex m_mutex;
+        std::vector<MetaShaderSwap> m_swaps;
+
+        void prepare(std::vector<std::string> const& changed);
+    };
+
+}
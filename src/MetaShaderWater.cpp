@@ -77,7 +77,7 @@ namespace pw {
 			Vector2 d = GetDirection(p);
 			float xz = GetWaveCoord(p, d);
 
-			return ::sin(frequency * xz + GetTime(clock)) * amplitude;
+			return fastSin(frequency * xz + GetTime(clock)) * amplitude;
 		}
 	};
 
@@ -115,6 +115,45 @@ namespace pw {
         return out;
     }
 
+    // a run of pins at once, the wave phases are gathered first so the sines are one array
+    static void waterBatch(MetaShaderContext& msc, int const y, int const x_begin, int const x_end, float* const row) {
+        constexpr int Lanes = 64;
+        float phases[Lanes];
+        float sines[Lanes];
+
+        MetaShaderWater& wtr = *msc.wtr;
+        float const inverse_half = 1.0f / wtr.half_size.y;
+
+        Vector2 pos;
+        pos.y = (float(y) - wtr.half_size.y) * inverse_half * Meters;
+
+        for (int start = x_begin; start < x_end; start += Lanes) {
+            int const count = minimum(Lanes, x_end - start);
+            float* const out = row + start;
+
+            for (int i = 0; i < count; ++i)
+                out[i] = 0.0f;
+
+            for (int w = 0; w != WaveCount; ++w) {
+                Wave& wave = wtr.waves[w];
+                float const wave_time = wave.GetTime(wtr.time);
+
+                for (int i = 0; i < count; ++i) {
+                    pos.x = (float(start + i) - wtr.half_size.x) * inverse_half * Meters;
+                    phases[i] = wave.frequency * wave.GetWaveCoord(pos, wave.GetDirection(pos)) + wave_time;
+                }
+
+                fastSin(phases, sines, count);
+
+                for (int i = 0; i < count; ++i)
+                    out[i] += sines[i] * wave.amplitude;
+            }
+
+            for (int i = 0; i < count; ++i)
+                out[i] = out[i] * 0.5f + 0.5f;
+        }
+    }
+
     void setupWaterMetaShaders(MetaShaderContext& context) {
         context.wtr = std::make_shared<MetaShaderWater>();
 
@@ -128,16 +167,27 @@ namespace pw {
         constexpr float ampOverLen = MedianAmplitude / MedianWavelength;
 
 
+        // own generator, the waves don't depend on which thread loads them
+        RandomGenerator random(randomSeed());
+
         for (int i = 0; i != WaveCount; ++i) {
-            float wavelength = uniformRandomRange(wavelengthMin, wavelengthMax);
-            float direction = uniformRandomRange(directionMin, directionMax);
+            float wavelength = random.uniformRange(wavelengthMin, wavelengthMax);
+            float direction = random.uniformRange(directionMin, directionMax);
             float amplitude = wavelength * ampOverLen;
-            float speed = uniformRandomRange(speedMin, speedMax);
-            Vector2 origin{ uniformRandomRange(-Meters, Meters), uniformRandomRange(-Meters, Meters) };
+            float speed = random.uniformRange(speedMin, speedMax);
+            Vector2 origin{ random.uniformRange(-Meters, Meters), random.uniformRange(-Meters, Meters) };
       
             context.wtr->waves[i] = Wave(wavelength, amplitude, speed, direction, waveType, origin);
         }
 
-        context.shaders.push_back({ "Water", water });
+        context.shaders.push_back({ "Water", water, waterBatch, true });
+    }
+
+    void shareWaterContext(MetaShaderContext& context, MetaShaderContext const& source) {
+        // the waves are the same on every canvas, the size and time are the canvas own
+        if (!source.wtr)
+            context.wtr.reset();
+        else if (!context.wtr || context.wtr == source.wtr)
+            context.wtr = std::make_shared<MetaShaderWater>(*source.wtr);
     }
 }
\ No newline at end of file
@@ -0,0 +1,305 @@
+#include "Noise.hpp"
+#include "Text.hpp"
+
+#include "raylib.h"
+
+// the kernels are too big for the inliner to pick them, and a call keeps the loop scalar
+#if defined(_MSC_VER)
+    #define NOISE_INLINE __forceinline
+#else
+    #define NOISE_INLINE inline __attribute__((always_inline))
+#endif
+
+namespace pw {
+
+    //
+    // kernels, everything below must inline for the loops to vectorize.
+    // gcc only turns the selects into blends without trapping math, see CMakeLists.txt
+    //
+    static NOISE_INLINE float fastFloor(float v) {
+        float t = float(int(v));
+        return t - ((v < t) ? 1.0f : 0.0f);
+    }
+
+    static NOISE_INLINE float fade(float t) {
+        return t * t * t * (t * (t * 6.0f - 15.0f) + 10.0f);
+    }
+
+    static NOISE_INLINE float mix(float a, float b, float t) {
+        return a + (b - a) * t;
+    }
+
+    static NOISE_INLINE uint32_t latticeHash(int x, int y, int z) {
+        return hashMix(uint32_t(x) * 0x8da6b343u ^ uint32_t(y) * 0xd8163841u ^ uint32_t(z) * 0xcb1ab31fu);
+    }
+
+    static NOISE_INLINE float latticeValue(int x, int y, int z) {
+        return float(int32_t(latticeHash(x, y, z) >> 8)) * (2.0f / 16777216.0f) - 1.0f;
+    }
+
+    // one of the 12 cube edge directions, as in improved perlin noise
+    static NOISE_INLINE float latticeGradient(int x, int y, int z, float dx, float dy, float dz) {
+        uint32_t h = latticeHash(x, y, z) & 15;
+
+        // u = h < 8 ? dx : dy, v = h < 4 ? dy : (h == 12 || h == 14 ? dx : dz), written as blends
+        float u = dy + (dx - dy) * float(h < 8);
+        float v = dz + (dx - dz) * float((h & 13) == 12);
+        v = v + (dy - v) * float(h < 4);
+
+        float su = float(1 - int(h & 1) * 2);
+        float sv = float(1 - int(h & 2));
+        return su * u + sv * v;
+    }
+
+    static NOISE_INLINE float valueKernel(float x, float y, float z) {
+        float fx = fastFloor(x), fy = fastFloor(y), fz = fastFloor(z);
+        int ix = int(fx), iy = int(fy), iz = int(fz);
+        float u = fade(x - fx), v = fade(y - fy), w = fade(z - fz);
+
+        float x00 = mix(latticeValue(ix, iy, iz), latticeValue(ix + 1, iy, iz), u);
+        float x10 = mix(latticeValue(ix, iy + 1, iz), latticeValue(ix + 1, iy + 1, iz), u);
+        float x01 = mix(latticeValue(ix, iy, iz + 1), latticeValue(ix + 1, iy, iz + 1), u);
+        float x11 = mix(latticeValue(ix, iy + 1, iz + 1), latticeValue(ix + 1, iy + 1, iz + 1), u);
+
+        return mix(mix(x00, x10, v), mix(x01, x11, v), w);
+    }
+
+    static NOISE_INLINE float gradientKernel(float x, float y, float z) {
+        float fx = fastFloor(x), fy = fastFloor(y), fz = fastFloor(z);
+        int ix = int(fx), iy = int(fy), iz = int(fz);
+        float dx = x - fx, dy = y - fy, dz = z - fz;
+        float u = fade(dx), v = fade(dy), w = fade(dz);
+
+        float x00 = mix(latticeGradient(ix, iy, iz, dx, dy, dz), latticeGradient(ix + 1, iy, iz, dx - 1.0f, dy, dz), u);
+        float x10 = mix(latticeGradient(ix, iy + 1, iz, dx, dy - 1.0f, dz), latticeGradient(ix + 1, iy + 1, iz, dx - 1.0f, dy - 1.0f, dz), u);
+        float x01 = mix(latticeGradient(ix, iy, iz + 1, dx, dy, dz - 1.0f), latticeGradient(ix + 1, iy, iz + 1, dx - 1.0f, dy, dz - 1.0f), u);
+        float x11 = mix(latticeGradient(ix, iy + 1, iz + 1, dx, dy - 1.0f, dz - 1.0f), latticeGradient(ix + 1, iy + 1, iz + 1, dx - 1.0f, dy - 1.0f, dz - 1.0f), u);
+
+        return mix(mix(x00, x10, v), mix(x01, x11, v), w);
+    }
+
+    static NOISE_INLINE float simplexCorner(int x, int y, int z, float dx, float dy, float dz) {
+        float t = 0.6f - dx * dx - dy * dy - dz * dz;
+        t = maximum(t, 0.0f);
+        t *= t;
+        return t * t * latticeGradient(x, y, z, dx, dy, dz);
+    }
+
+    static NOISE_INLINE float simplexKernel(float x, float y, float z) {
+        constexpr float F3 = 1.0f / 3.0f;
+        constexpr float G3 = 1.0f / 6.0f;
+
+        // skew to the simplex cell
+        float s = (x + y + z) * F3;
+        float fi = fastFloor(x + s), fj = fastFloor(y + s), fk = fastFloor(z + s);
+        int i = int(fi), j = int(fj), k = int(fk);
+
+        float t = (fi + fj + fk) * G3;
+        float x0 = x - (fi - t), y0 = y - (fj - t), z0 = z - (fk - t);
+
+        // which of the six simplices, ranked without branches
+        int xy = (x0 >= y0), yz = (y0 >= z0), xz = (x0 >= z0);
+        int i1 = xy & xz, j1 = (1 - xy) & yz, k1 = (1 - xz) & (1 - yz);
+        int i2 = xy | xz, j2 = (1 - xy) | yz, k2 = 1 - (xz & yz);
+
+        float x1 = x0 - i1 + G3, y1 = y0 - j1 + G3, z1 = z0 - k1 + G3;
+        float x2 = x0 - i2 + 2.0f * G3, y2 = y0 - j2 + 2.0f * G3, z2 = z0 - k2 + 2.0f * G3;
+        float x3 = x0 - 1.0f + 3.0f * G3, y3 = y0 - 1.0f + 3.0f * G3, z3 = z0 - 1.0f + 3.0f * G3;
+
+        float n = simplexCorner(i, j, k, x0, y0, z0) +
+                  simplexCorner(i + i1, j + j1, k + k1, x1, y1, z1) +
+                  simplexCorner(i + i2, j + j2, k + k2, x2, y2, z2) +
+                  simplexCorner(i + 1, j + 1, k + 1, x3, y3, z3);
+
+        return 32.0f * n;
+    }
+
+    template<float(*Kernel)(float, float, float)>
+    static void evaluate(float const* x, float const* y, float const* z, float* out, int count) {
+        for (int i = 0; i < count; ++i)
+            out[i] = Kernel(x[i], y[i], z[i]);
+    }
+
+    float noise(NoiseBasis basis, float x, float y, float z) {
+        switch (basis) {
+            case NoiseBasis::Value: return valueKernel(x, y, z);
+            case NoiseBasis::Gradient: return gradientKernel(x, y, z);
+            case NoiseBasis::Simplex: return simplexKernel(x, y, z);
+        }
+        return 0.0f;
+    }
+
+    void noise(NoiseBasis basis, float const* x, float const* y, float const* z, float* out, int count) {
+        switch (basis) {
+            case NoiseBasis::Value: evaluate<valueKernel>(x, y, z, out, count); break;
+            case NoiseBasis::Gradient: evaluate<gradientKernel>(x, y, z, out, count); break;
+            case NoiseBasis::Simplex: evaluate<simplexKernel>(x, y, z, out, count); break;
+        }
+    }
+
+    //
+    // octaves
+    //
+
+    // octaves are shifted so their lattices don't line up at the origin
+    constexpr float OctaveShift = 19.19f;
+
+    void fbm(NoiseBasis basis, NoiseOctaves const& octaves, float const* x, float const* y, float const* z, float* out, int count) {
+        float sx[NoiseLanes], sy[NoiseLanes], sz[NoiseLanes], value[NoiseLanes];
+
+        for (int start = 0; start < count; start += NoiseLanes) {
+            int const n = minimum(NoiseLanes, count - start);
+            float* const result = out + start;
+
+            for (int i = 0; i < n; ++i)
+                result[i] = 0.0f;
+
+            float frequency = 1.0f;
+            float amplitude = 1.0f;
+            float total = 0.0f;
+
+            for (int octave = 0; octave < octaves.octaves; ++octave) {
+                float const shift = octave * OctaveShift;
+                for (int i = 0; i < n; ++i) {
+                    sx[i] = x[start + i] * frequency + shift;
+                    sy[i] = y[start + i] * frequency + shift;
+                    sz[i] = z[start + i] * frequency;
+                }
+
+                noise(basis, sx, sy, sz, value, n);
+
+                for (int i = 0; i < n; ++i)
+                    result[i] += value[i] * amplitude;
+
+                total += amplitude;
+                frequency *= octaves.lacunarity;
+                amplitude *= octaves.gain;
+            }
+
+            float const normalize = (total > 0.0f) ? 1.0f / total : 0.0f;
+            for (int i = 0; i < n; ++i)
+                result[i] *= normalize;
+        }
+    }
+
+    void ridged(NoiseBasis basis, NoiseOctaves const& octaves, float const* x, float const* y, float const* z, float* out, int count) {
+        float sx[NoiseLanes], sy[NoiseLanes], sz[NoiseLanes], value[NoiseLanes], weight[NoiseLanes];
+
+        for (int start = 0; start < count; start += NoiseLanes) {
+            int const n = minimum(NoiseLanes, count - start);
+            float* const result = out + start;
+
+            for (int i = 0; i < n; ++i) {
+                result[i] = 0.0f;
+                weight[i] = 1.0f;
+            }
+
+            float frequency = 1.0f;
+            float amplitude = 1.0f;
+            float total = 0.0f;
+
+            for (int octave = 0; octave < octaves.octaves; ++octave) {
+                float const shift = octave * OctaveShift;
+                for (int i = 0; i < n; ++i) {
+                    sx[i] = x[start + i] * frequency + shift;
+                    sy[i] = y[start + i] * frequency + shift;
+                    sz[i] = z[start + i] * frequency;
+                }
+
+                noise(basis, sx, sy, sz, value, n);
+
+                // each octave is weighted by the previous one, so detail gathers along the ridges
+                for (int i = 0; i < n; ++i) {
+                    float signal = 1.0f - absolute(value[i]);
+                    signal *= signal * weight[i];
+                    weight[i] = clampTo(signal * 2.0f, 0.0f, 1.0f);
+                    result[i] += signal * amplitude;
+                }
+
+                total += amplitude;
+                frequency *= octaves.lacunarity;
+                amplitude *= octaves.gain;
+            }
+
+            float const normalize = (total > 0.0f) ? 1.0f / total : 0.0f;
+            for (int i = 0; i < n; ++i)
+                result[i] *= normalize;
+        }
+    }
+
+    void domainWarp(NoiseBasis basis, NoiseOctaves const& octaves, float strength, float const* x, float const* y, float const* z, float* out, int count) {
+        float sx[NoiseLanes], sy[NoiseLanes], wx[NoiseLanes], wy[NoiseLanes];
+
+        for (int start = 0; start < count; start += NoiseLanes) {
+            int const n = minimum(NoiseLanes, count - start);
+
+            fbm(basis, octaves, x + start, y + start, z + start, wx, n);
+
+            for (int i = 0; i < n; ++i) {
+                sx[i] = x[start + i] + 5.2f;
+                sy[i] = y[start + i] + 1.3f;
+            }
+            fbm(basis, octaves, sx, sy, z + start, wy, n);
+
+            for (int i = 0; i < n; ++i) {
+                sx[i] = x[start + i] + strength * wx[i];
+                sy[i] = y[start + i] + strength * wy[i];
+            }
+            fbm(basis, octaves, sx, sy, z + start, out + start, n);
+        }
+    }
+
+    //
+    // benchmark
+    //
+    void benchmarkNoise() {
+        constexpr int Width = 320;
+        constexpr int Height = 240;
+        constexpr int Runs = 4;
+
+        std::vector<float> x(Width * Height), y(Width * Height), z(Width * Height, 0.5f), out(Width * Height);
+        for (int j = 0; j != Height; ++j) {
+            for (int i = 0; i != Width; ++i) {
+                x[j * Width + i] = i * 0.05f;
+                y[j * Width + i] = j * 0.05f;
+            }
+        }
+
+        struct Variant {
+            const char* name;
+            std::function<void(NoiseBasis, NoiseOctaves const&)> run;
+        };
+
+        int const count = int(out.size());
+        std::vector<Variant> variants = {
+            { "fbm", [&](NoiseBasis b, NoiseOctaves const& o) { fbm(b, o, x.data(), y.data(), z.data(), out.data(), count); } },
+            { "ridged", [&](NoiseBasis b, NoiseOctaves const& o) { ridged(b, o, x.data(), y.data(), z.data(), out.data(), count); } },
+            { "warp", [&](NoiseBasis b, NoiseOctaves const& o) { domainWarp(b, o, 1.5f, x.data(), y.data(), z.data(), out.data(), count); } },
+        };
+
+        std::pair<const char*, NoiseBasis> bases[] = {
+            { "value", NoiseBasis::Value },
+            { "gradient", NoiseBasis::Gradient },
+            { "simplex", NoiseBasis::Simplex },
+        };
+
+        TraceLog(LOG_INFO, "Noise > ns per point on a %dx%d canvas, octaves 1 to 8", Width, Height);
+        for (auto const& [basis_name, basis] : bases) {
+            for (auto const& variant : variants) {
+                std::string line;
+                for (int octaves = 1; octaves <= 8; ++octaves) {
+                    NoiseOctaves o;
+                    o.octaves = octaves;
+
+                    int64_t start = getCurrentMicroseconds();
+                    for (int run = 0; run != Runs; ++run)
+                        variant.run(basis, o);
+                    double ns = double(getCurrentMicroseconds() - start) * 1000.0 / (double(Runs) * count);
+
+                    line += sfmt(" %7.2f", ns);
+                }
+                TraceLog(LOG_INFO, "Noise > %-8s %-6s%s", basis_name, variant.name, line.c_str());
+            }
+        }
+    }
+}
@@ -0,0 +1,43 @@
+#pragma once
+
+#include "Lang.hpp"
+
+namespace pw {
+
+    //
+    // Coherent 3d noise, values are roughly in [-1.0, 1.0].
+    // The lattice is hashed instead of read from a permutation table and the kernels have no branches,
+    // so the array versions are vectorized by the compiler.
+    //
+    enum class NoiseBasis {
+        Value,
+        Gradient,
+        Simplex
+    };
+
+    struct NoiseOctaves {
+        int octaves = 5;
+        float lacunarity = 2.0f;    // frequency multiplier per octave
+        float gain = 0.5f;          // amplitude multiplier per octave
+    };
+
+    // points processed together, longer arrays are split in runs of this size
+    constexpr int NoiseLanes = 64;
+
+    float noise(NoiseBasis basis, float x, float y, float z);
+
+    // the array versions evaluate count points, out may not alias the inputs
+    void noise(NoiseBasis basis, float const* x, float const* y, float const* z, float* out, int count);
+
+    // sum of octaves, normalized back to [-1.0, 1.0]
+    void fbm(NoiseBasis basis, NoiseOctaves const& octaves, float const* x, float const* y, float const* z, float* out, int count);
+
+    // sharp creases where the noise crosses zero, in [0.0, 1.0]
+    void ridged(NoiseBasis basis, NoiseOctaves const& octaves, float const* x, float const* y, float const* z, float* out, int count);
+
+    // fbm sampled at a position displaced by two other fbm fields
+    void domainWarp(NoiseBasis basis, NoiseOctaves const& octaves, float strength, float const* x, float const* y, float const* z, float* out, int count);
+
+    // logs the cost per point of every basis and variant from 1 to 8 octaves
+    void benchmarkNoise();
+}
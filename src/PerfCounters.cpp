@@ -0,0 +1,165 @@
+#include "PerfCounters.hpp"
+
+#include "raylib.h"
+
+#if defined(__linux__)
+    #include <linux/perf_event.h>
+    #include <sys/syscall.h>
+    #include <sys/ioctl.h>
+    #include <unistd.h>
+    #include <cerrno>
+    #include <cstring>
+#endif
+
+namespace pw {
+
+    const char* perfCounterName(PerfCounter counter) {
+        switch (counter) {
+            case PerfCounter::Cycles: return "cycles";
+            case PerfCounter::Instructions: return "instructions";
+            case PerfCounter::CacheMisses: return "llc_misses";
+            case PerfCounter::BranchMisses: return "branch_misses";
+            default: return "unknown";
+        }
+    }
+
+    PerfCounters::PerfCounters() { }
+
+    PerfCounters::~PerfCounters() {
+#if defined(__linux__)
+        for (auto const& group : m_groups)
+            for (int fd : group.fds)
+                if (fd >= 0)
+                    close(fd);
+#endif
+    }
+
+#if defined(__linux__)
+
+    // thread 0 is the calling thread
+    static int openCounter(uint64_t config, int thread, int group) {
+        perf_event_attr attr;
+        memset(&attr, 0, sizeof(attr));
+        attr.size = sizeof(attr);
+        attr.type = PERF_TYPE_HARDWARE;
+        attr.config = config;
+        attr.disabled = (group == -1) ? 1 : 0;
+        attr.exclude_kernel = 1;        // allowed with the default perf_event_paranoid
+        attr.exclude_hv = 1;
+        attr.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+
+        return int(syscall(SYS_perf_event_open, &attr, thread, -1, group, PERF_FLAG_FD_CLOEXEC));
+    }
+
+    bool PerfCounters::openGroup(int thread, Group& group) {
+        const uint64_t configs[] = {
+            PERF_COUNT_HW_CPU_CYCLES,
+            PERF_COUNT_HW_INSTRUCTIONS,
+            PERF_COUNT_HW_CACHE_MISSES,
+            PERF_COUNT_HW_BRANCH_MISSES
+        };
+
+        group.fds.fill(-1);
+        group.read_index.fill(-1);
+
+        for (size_t i = 0; i != size_t(PerfCounter::Count); ++i) {
+            int fd = openCounter(configs[i], thread, group.leader);
+            if (fd < 0) {
+                if (group.leader < 0) {
+                    TraceLog(LOG_WARNING, "Perf > hardware counters not available on thread %d (%s), check /proc/sys/kernel/perf_event_paranoid", thread, strerror(errno));
+                    return false;
+                }
+
+                // every thread runs on the same cpus, only the first group reports the missing counters
+                if (m_groups.empty())
+                    TraceLog(LOG_WARNING, "Perf > %s counter not available (%s)", perfCounterName(PerfCounter(i)), strerror(errno));
+                continue;
+            }
+
+            if (group.leader < 0)
+                group.leader = fd;
+
+            group.fds[i] = fd;
+            group.read_index[i] = group.opened++;
+        }
+
+        return true;
+    }
+
+    bool PerfCounters::open(std::vector<int> const& threads) {
+        if (!m_groups.empty())
+            return true;
+
+        Group group;
+        if (!openGroup(0, group))
+            return false;
+        m_groups.push_back(group);
+
+        // a worker that can't be counted leaves its share out, the stage values are then only a lower bound
+        for (int thread : threads) {
+            Group worker;
+            if (openGroup(thread, worker))
+                m_groups.push_back(worker);
+        }
+
+        TraceLog(LOG_INFO, "Perf > %d hardware counters on %d of %d threads", m_groups[0].opened, int(m_groups.size()), int(threads.size()) + 1);
+        return true;
+    }
+
+    bool PerfCounters::available() const {
+        return !m_groups.empty();
+    }
+
+    int PerfCounters::threads() const {
+        return int(m_groups.size());
+    }
+
+    void PerfCounters::start() {
+        for (auto const& group : m_groups) {
+            ioctl(group.leader, PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+            ioctl(group.leader, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+        }
+    }
+
+    PerfCounterValues PerfCounters::stop() {
+        PerfCounterValues result;
+
+        for (auto const& group : m_groups)
+            ioctl(group.leader, PERF_EVENT_IOC_DISABLE, PERF_IOC_FLAG_GROUP);
+
+        for (auto const& group : m_groups) {
+            // nr, time_enabled, time_running, values[nr]
+            uint64_t data[3 + size_t(PerfCounter::Count)] = {};
+            if (read(group.leader, data, sizeof(data)) < ssize_t(3 * sizeof(uint64_t)))
+                continue;
+
+            uint64_t enabled = data[1];
+            uint64_t running = data[2];
+            if (running == 0)
+                continue;
+
+            // scaled up when the kernel had to multiplex the counters
+            double scale = double(enabled) / double(running);
+            for (size_t i = 0; i != size_t(PerfCounter::Count); ++i)
+                if (group.read_index[i] >= 0 && uint64_t(group.read_index[i]) < data[0])
+                    result.values[i] = maximum<int64_t>(result.values[i], 0) + int64_t(double(data[3 + group.read_index[i]]) * scale);
+        }
+
+        return result;
+    }
+
+#else
+
+    bool PerfCounters::open(std::vector<int> const&) {
+        TraceLog(LOG_INFO, "Perf > hardware counters are only available on linux");
+        return false;
+    }
+
+    bool PerfCounters::available() const { return false; }
+    int PerfCounters::threads() const { return 0; }
+    void PerfCounters::start() { }
+    PerfCounterValues PerfCounters::stop() { return PerfCounterValues(); }
+
+#endif
+
+}
@@ -0,0 +1,58 @@
+#pragma once
+
+#include "Lang.hpp"
+
+namespace pw {
+
+    enum class PerfCounter {
+        Cycles,
+        Instructions,
+        CacheMisses,        // last level cache on most cpus
+        BranchMisses,
+
+        Count
+    };
+
+    const char* perfCounterName(PerfCounter counter);
+
+    struct PerfCounterValues {
+        std::array<int64_t, size_t(PerfCounter::Count)> values;    // -1 when the counter isn't available
+
+        PerfCounterValues() { values.fill(-1); }
+
+        int64_t operator[](PerfCounter counter) const { return values[size_t(counter)]; }
+    };
+
+    //
+    // Hardware counters of the calling thread and of other threads of the process, through perf_event_open on linux.
+    // Every thread has its own counter group, the values of a stage are the sum of every group.
+    // When the kernel doesn't allow it (perf_event_paranoid, containers, other platforms) nothing is counted.
+    //
+    class PerfCounters {
+    public:
+        PerfCounters();
+        ~PerfCounters();
+
+        // opens the counters on the calling thread and on the given threads (os thread ids), like the job system workers
+        bool open(std::vector<int> const& threads = {});
+        bool available() const;
+
+        // threads that are counted
+        int threads() const;
+
+        void start();
+        PerfCounterValues stop();
+    private:
+        struct Group {
+            int leader = -1;
+            std::array<int, size_t(PerfCounter::Count)> fds;
+            std::array<int, size_t(PerfCounter::Count)> read_index;    // position in the group read, -1 when not opened
+            int opened = 0;
+        };
+
+        std::vector<Group> m_groups;
+
+        bool openGroup(int thread, Group& group);
+    };
+
+}
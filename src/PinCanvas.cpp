@@ -0,0 +1,658 @@
+#include "PinCanvas.hpp"
+#include "Menu.hpp"
+#include "Text.hpp"
+#include "Trace.hpp"
+#include "Jobs.hpp"
+
+#include "rlgl.h"
+
+namespace pw {
+
+    // pins evaluated by one job when a shader runs in parallel
+    constexpr int TileWidth = 64;
+    constexpr int TileHeight = 8;
+
+    static PinRegion tileRegion(int width, int height, int tiles_x, int tile) {
+        int x_begin = (tile % tiles_x) * TileWidth;
+        int y_begin = (tile / tiles_x) * TileHeight;
+        return { x_begin, y_begin, minimum(x_begin + TileWidth, width), minimum(y_begin + TileHeight, height) };
+    }
+
+    static bool emptyRegion(PinRegion const& region) {
+        return region.x_begin >= region.x_end || region.y_begin >= region.y_end;
+    }
+
+    // the box around the parts of the regions inside every tile, empty for the tiles they don't touch. returns the empty tiles
+    static int boundTiles(std::vector<PinRegion> const& regions, int width, int height, std::vector<PinRegion>& tiles) {
+        int tiles_x = (width + TileWidth - 1) / TileWidth;
+        int tiles_y = (height + TileHeight - 1) / TileHeight;
+        tiles.assign(size_t(tiles_x) * tiles_y, { 0, 0, 0, 0 });
+
+        for (PinRegion const& region : regions) {
+            int x_begin = maximum(region.x_begin, 0);
+            int x_end = minimum(region.x_end, width);
+            int y_begin = maximum(region.y_begin, 0);
+            int y_end = minimum(region.y_end, height);
+            if (x_begin >= x_end || y_begin >= y_end)
+                continue;
+
+            for (int ty = y_begin / TileHeight; ty <= (y_end - 1) / TileHeight; ++ty) {
+                for (int tx = x_begin / TileWidth; tx <= (x_end - 1) / TileWidth; ++tx) {
+                    int tile = ty * tiles_x + tx;
+                    PinRegion area = tileRegion(width, height, tiles_x, tile);
+                    PinRegion inside = { maximum(x_begin, area.x_begin), maximum(y_begin, area.y_begin), minimum(x_end, area.x_end), minimum(y_end, area.y_end) };
+
+                    PinRegion& bounds = tiles[tile];
+                    if (emptyRegion(bounds))
+                        bounds = inside;
+                    else
+                        bounds = { minimum(bounds.x_begin, inside.x_begin), minimum(bounds.y_begin, inside.y_begin), maximum(bounds.x_end, inside.x_end), maximum(bounds.y_end, inside.y_end) };
+                }
+            }
+        }
+
+        return int(std::count_if(tiles.begin(), tiles.end(), emptyRegion));
+    }
+
+    // zeroes the pins of area that are outside inside
+    static void clearOutside(float* pins, int width, PinRegion const& area, PinRegion const& inside) {
+        for (int y = area.y_begin; y != area.y_end; ++y) {
+            float* row = pins + y * width;
+            if (y < inside.y_begin || y >= inside.y_end || inside.x_begin >= inside.x_end) {
+                memset(row + area.x_begin, 0, size_t(area.x_end - area.x_begin) * sizeof(float));
+                continue;
+            }
+
+            memset(row + area.x_begin, 0, size_t(inside.x_begin - area.x_begin) * sizeof(float));
+            memset(row + inside.x_end, 0, size_t(area.x_end - inside.x_end) * sizeof(float));
+        }
+    }
+
+    bool validCanvasDivisor(int divisor) {
+        return divisor == 1 || divisor == 2 || divisor == 4 || divisor == 8;
+    }
+
+    bool parseCanvasOptions(std::string const& spec, PinCanvasOptions& options) {
+        for (auto entry : split(spec, ",")) {
+            trim(entry);
+            if (entry.empty())
+                continue;
+
+            auto equal = entry.find('=');
+            if (equal == std::string::npos)
+                return false;
+
+            std::string key = entry.substr(0, equal);
+            std::string value = entry.substr(equal + 1);
+            trim(key);
+            trim(value);
+
+            if (key == "shader") {
+                options.shader = value;
+            } else if (key == "size") {
+                options.divisor = lexical_cast<int>(value, 0);
+                if (!validCanvasDivisor(options.divisor))
+                    return false;
+            } else if (key == "speed") {
+                options.speed = lexical_cast<float>(value, -1.0f);
+                if (options.speed < 0.0f)
+                    return false;
+            } else if (key == "mask") {
+                options.mask = value;
+            } else if (key == "sink") {
+                options.sink = value;
+            } else {
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    PinCanvas::PinCanvas()
+        :m_divisor(1), m_width(0), m_height(0), m_speed(1.0f), m_start_time(0.0), m_shader_scale(1), m_shader_ms(0.0f),
+        m_budget_ms(AdaptiveResolution::FrameBudgetMs), m_empty_tiles(0),
+        m_content_rows_begin(0), m_content_rows_end(0), m_uploaded_rows_begin(0), m_uploaded_rows_end(0)
+    {
+        m_camera = { 0 };
+        m_camera.position = { 10.0f, 5.0f, 5.0f };  // Camera position
+        m_camera.target = { 0.0f, 0.0f, 0.0f };      // Camera looking at point
+        m_camera.up = { 0.0f, 1.0f, 0.0f };          // Camera up vector (rotation towards target)
+        m_camera.fovy = 45.0f;                       // Camera field-of-view Y
+        m_camera.projection = CAMERA_PERSPECTIVE;    // Camera mode type
+
+        m_viewport = { 0.0f, 0.0f, 0.0f, 0.0f };
+        memset(&m_target, 0, sizeof(m_target));
+        memset(&m_pin_mesh, 0, sizeof(m_pin_mesh));
+
+        float margin_factor = 0.0f;//0.05f;
+        m_pin_size_with_margins = 1.0f;
+        m_pin_height = 2.0f;
+        m_pin_size = m_pin_size_with_margins * (1.0f - 2.0f * margin_factor);
+    }
+
+    PinCanvas::~PinCanvas() {
+        m_keyframes.reset();
+    }
+
+    bool PinCanvas::loadMask(std::string const& filepath) {
+        return m_pin_mask.load(filepath);
+    }
+
+    bool PinCanvas::startSink(std::string const& address) {
+        return m_pin_sink.start(address);
+    }
+
+    void PinCanvas::stopSink() {
+        m_pin_sink.stop();
+    }
+
+    void PinCanvas::setSpeed(float speed) {
+        m_speed = speed;
+    }
+
+    void PinCanvas::setDivisor(int divisor) {
+        m_divisor = divisor;
+        m_pins.clear();
+        m_keyframes.reset();
+    }
+
+    int PinCanvas::divisor() const {
+        return m_divisor;
+    }
+
+    int PinCanvas::width() const {
+        return m_width;
+    }
+
+    int PinCanvas::height() const {
+        return m_height;
+    }
+
+    std::vector<float> const& PinCanvas::pins() const {
+        return m_pins;
+    }
+
+    MetaShaderContext& PinCanvas::context() {
+        return m_meta_shader_context;
+    }
+
+    std::string const& PinCanvas::shaderName() const {
+        return m_meta_shader_context.shader.name;
+    }
+
+    void PinCanvas::shareShaders(MetaShaderContext const& source) {
+        m_keyframes.wait();
+        shareMetaShaderContext(m_meta_shader_context, source);
+    }
+
+    bool PinCanvas::selectShader(std::string const& name) {
+        auto const& shaders = m_meta_shader_context.shaders;
+        auto found = std::find_if(shaders.begin(), shaders.end(), [&name](auto const& current) { return current.name == name; });
+        if (found == shaders.end())
+            return false;
+
+        selectShader(*found);
+        return true;
+    }
+
+    void PinCanvas::selectShader(MetaShaderInfo const& shader) {
+        m_keyframes.reset();
+        m_meta_shader_context.shader = shader;
+    }
+
+    void PinCanvas::restart(double time) {
+        m_start_time = time;
+        m_keyframes.reset();
+    }
+
+    Keyframes& PinCanvas::keyframes() {
+        return m_keyframes;
+    }
+
+    CameraDetail& PinCanvas::cameraDetail() {
+        return m_camera_detail;
+    }
+
+    Camera3D& PinCanvas::camera() {
+        return m_camera;
+    }
+
+    void PinCanvas::setViewport(Rectangle const& viewport, bool offscreen) {
+        m_viewport = viewport;
+
+        int width = maximum(1, int(viewport.width));
+        int height = maximum(1, int(viewport.height));
+        if (offscreen && m_target.id != 0 && m_target.texture.width == width && m_target.texture.height == height)
+            return;
+
+        if (m_target.id != 0) {
+            UnloadRenderTexture(m_target);
+            memset(&m_target, 0, sizeof(m_target));
+        }
+
+        // the target follows the viewport size
+        if (offscreen)
+            m_target = LoadRenderTexture(width, height);
+    }
+
+    Rectangle const& PinCanvas::viewport() const {
+        return m_viewport;
+    }
+
+    RenderTexture2D const& PinCanvas::target() const {
+        return m_target;
+    }
+
+    float PinCanvas::canvasTime(double time) const {
+        return float((time - m_start_time) * m_speed);
+    }
+
+    void PinCanvas::canvasStart(float& x_start, float& y_start) const {
+        x_start = m_width * m_pin_size_with_margins / 2.0f;
+        x_start -= m_pin_size_with_margins / 2.0f; // center the first pin
+
+        y_start = m_height * m_pin_size_with_margins / 2.0f;
+        y_start -= m_pin_size_with_margins / 2.0f; // center the first pin
+    }
+
+    void PinCanvas::computeSizes(double time, Material const* material) {
+        if (!m_pins.empty())
+            return;
+
+        m_width = CANVAS_WIDTH / m_divisor;
+        m_height = CANVAS_HEIGHT / m_divisor;
+        TraceLog(LOG_DEBUG, "Canvas=%dx%d", m_width, m_height);
+
+        // the pins stay allocated for the largest canvas, size changes don't reallocate them
+        int total = m_width * m_height;
+        m_pins.reserve(CANVAS_WIDTH * CANVAS_HEIGHT);
+        m_pins.resize(total, 0.0f);
+        m_start_time = time;
+        m_pin_mask.fit(m_width, m_height);
+
+        // the new vertex buffer starts from the pins as they are
+        m_content_rows_begin = m_uploaded_rows_begin = 0;
+        m_content_rows_end = m_uploaded_rows_end = m_height;
+
+        // nothing is drawn
+        if (!material)
+            return;
+
+        float x_start = 0.0f;
+        float y_start = 0.0f;
+        canvasStart(x_start, y_start);
+
+        // the mesh and the instance buffers are made once for the largest canvas,
+        // a size change only updates the uniforms and the start of the buffers
+        if (m_pin_mesh.vertexCount == 0) {
+            m_pin_mesh = GenMeshCube(m_pin_size, m_pin_height, m_pin_size);
+            loadPinInstances(m_pin_mesh, *material, CANVAS_WIDTH * CANVAS_HEIGHT);
+        }
+
+        m_pin_chunks.build(m_pin_mask, m_width, m_height);
+        m_pin_chunks.gather(m_pins.data(), 0, m_height, m_active_pins);
+
+        updatePinCanvas(
+            m_pin_mesh, *material,
+            m_active_pins, m_pin_chunks.instances(),
+            m_width, m_height,
+            x_start, y_start,
+            m_pin_size_with_margins
+        );
+
+        float max_dimension = maximum(m_width, m_height) * m_pin_size_with_margins;
+        m_camera.position = { 0.0f, max_dimension / 2.0f, max_dimension / 1.5f };  // Camera position
+    }
+
+    CanvasLayout PinCanvas::canvasLayout() const {
+        CanvasLayout layout;
+        layout.width = m_width;
+        layout.height = m_height;
+        layout.tile_width = TileWidth;
+        layout.tile_height = TileHeight;
+        layout.pin_size = m_pin_size_with_margins;
+        layout.min_y = -m_pin_height / 2.0f;
+        layout.max_y = m_pin_size_with_margins * 10.0f + m_pin_height / 2.0f;
+        layout.travel = m_pin_size_with_margins * 10.0f;
+        return layout;
+    }
+
+    void PinCanvas::update(PinCanvasFrame const& frame) {
+        FrameProfiler& profiler = frame.profiler;
+        m_budget_ms = frame.budget_ms;
+
+        // every row may change unless the shader bounds say otherwise
+        m_content_rows_begin = 0;
+        m_content_rows_end = m_height;
+        m_empty_tiles = 0;
+
+        //
+        // Run Meta Shader at a lower rate in the background, the pins are interpolated between keyframes
+        //
+        if (m_keyframes.enabled()) {
+            {
+                ScopedStageTimer timer(profiler, FrameStage::Shader);
+                PW_TRACE_ZONE("keyframes");
+
+                // adaptive resolution is for shaders that run every frame
+                m_shader_scale = 1;
+
+                int width = m_width;
+                int height = m_height;
+                float time = canvasTime(frame.time);
+                m_keyframes.update(m_pins, time, [this, width, height](float* pins, float time) {
+                    updateContextState(m_meta_shader_context, width, height, time);
+                    evaluateShader(pins, width, height);
+                });
+            }
+
+            {
+                ScopedStageTimer timer(profiler, FrameStage::Clamp);
+                for (float& pin : m_pins)
+                    pin = clampTo(pin, 0.0f, 1.0f);
+            }
+            return;
+        }
+
+        //
+        // Run Meta Shader on each pin
+        //
+        std::string const& shader_name = m_meta_shader_context.shader.name;
+        int shader_width = m_width;
+        int shader_height = m_height;
+        bool use_detail = false;
+        bool bounded = false;
+
+        {
+            ScopedStageTimer timer(profiler, FrameStage::Context);
+
+            m_shader_scale = frame.resolution.scale(m_resolution, shader_name, m_width * m_height, frame.budget_ms);
+            shader_width = maximum(1, m_width / m_shader_scale);
+            shader_height = maximum(1, m_height / m_shader_scale);
+
+            // the tiles follow the camera on the full canvas, headless output doesn't depend on a camera
+            use_detail = m_camera_detail.enabled() && !frame.headless && m_shader_scale == 1;
+            if (use_detail) {
+                m_camera_detail.update(m_camera, m_viewport.width, m_viewport.height, canvasLayout());
+            }
+
+            float time = canvasTime(frame.time);
+            updateContextState(m_meta_shader_context, shader_width, shader_height, time);
+
+            m_shader_regions.clear();
+            bounded = m_meta_shader_context.shader.bounds && !m_meta_shader_context.shader.stencil;
+            if (bounded) {
+                m_meta_shader_context.shader.bounds(m_meta_shader_context, shader_width, shader_height, m_shader_regions);
+                m_empty_tiles = boundTiles(m_shader_regions, shader_width, shader_height, m_tile_bounds);
+
+                // the pins outside the regions are zero, the rows around them don't need uploading again
+                if (m_shader_scale == 1) {
+                    m_content_rows_begin = m_height;
+                    m_content_rows_end = 0;
+                    for (PinRegion const& region : m_shader_regions) {
+                        if (emptyRegion(region))
+                            continue;
+                        m_content_rows_begin = minimum(m_content_rows_begin, region.y_begin);
+                        m_content_rows_end = maximum(m_content_rows_end, region.y_end);
+                    }
+                }
+            }
+        }
+
+        {
+            ScopedStageTimer timer(profiler, FrameStage::Shader);
+            ScopedStageCounters counters(profiler, FrameStage::Shader, shader_name);
+            PW_TRACE_ZONE(shader_name.c_str());
+
+            float* pins = m_pins.data();
+            if (m_shader_scale == 1) {
+                m_shader_pins.clear();
+            } else {
+                // the shader carries on from the current pins when its scale changes
+                size_t count = size_t(shader_width) * shader_height;
+                if (m_shader_pins.size() != count) {
+                    m_shader_pins.resize(count);
+                    resizePins(m_pins.data(), m_width, m_height, m_shader_pins.data(), shader_width, shader_height);
+                }
+                pins = m_shader_pins.data();
+            }
+
+            int64_t start = getCurrentMicroseconds();
+            evaluateShader(pins, shader_width, shader_height, use_detail ? &m_camera_detail : nullptr, bounded ? &m_tile_bounds : nullptr);
+            int64_t elapsed = getCurrentMicroseconds() - start;
+            frame.resolution.record(shader_name, shader_width * shader_height, elapsed);
+            m_shader_ms = elapsed / 1000.0f;
+
+            if (m_shader_scale != 1)
+                resizePins(m_shader_pins.data(), shader_width, shader_height, m_pins.data(), m_width, m_height);
+        }
+
+        {
+            ScopedStageTimer timer(profiler, FrameStage::Clamp);
+            for (float& pin : m_pins)
+                pin = clampTo(pin, 0.0f, 1.0f);
+        }
+    }
+
+    void PinCanvas::evaluateShader(float* pins, int width, int height, CameraDetail const* detail, std::vector<PinRegion> const* tile_bounds) {
+        MetaShaderBatchFunction batch = m_meta_shader_context.shader.batch;
+        int tiles_x = (width + TileWidth - 1) / TileWidth;
+        int tiles_y = (height + TileHeight - 1) / TileHeight;
+
+        // the mask is laid over the canvas, a shader at a lower resolution runs on every pin
+        PinMask const* mask = (m_pin_mask.enabled() && width == m_width && height == m_height) ? &m_pin_mask : nullptr;
+
+        // only the pins inside the shader bounds are evaluated, at the camera detail
+        auto runTile = [this, pins, width, height, tiles_x, detail, tile_bounds, mask](int tile) {
+            PW_TRACE_ZONE("tile");
+            PinRegion area = tileRegion(width, height, tiles_x, tile);
+            if (tile_bounds) {
+                PinRegion const& inside = (*tile_bounds)[tile];
+                clearOutside(pins, width, area, inside);
+                if (emptyRegion(inside))
+                    return;
+                area = inside;
+            }
+            evaluateTile(pins, width, area, detail ? detail->rowStep(tile) : 1, mask);
+        };
+
+        // simulations step the whole canvas, every pin depends on its neighbours
+        if (m_meta_shader_context.shader.stencil) {
+            evaluateStencilMetaShader(m_meta_shader_context, pins, width, height);
+        } else if (batch && m_meta_shader_context.shader.parallel) {
+            parallelFor(JobSystem::shared(), tiles_x * tiles_y, runTile);
+        } else if (detail || tile_bounds || mask) {
+            for (int tile = 0; tile != tiles_x * tiles_y; ++tile)
+                runTile(tile);
+        } else if (batch) {
+            for (int y = 0; y != height; ++y)
+                batch(m_meta_shader_context, y, 0, width, pins + y * width);
+        } else {
+            Vector2 pin;
+            for (int y = 0; y != height; ++y) {
+                pin.y = float(y);
+                for (int x = 0; x != width; ++x) {
+                    int index = y * width + x;
+                    pin.x = float(x);
+                    pins[index] = m_meta_shader_context.shader.function(m_meta_shader_context, index, pin, pins[index]);
+                }
+            }
+        }
+    }
+
+    void PinCanvas::evaluateTile(float* pins, int width, PinRegion const& area, int row_step, PinMask const* mask) {
+        // the tile keeps its pins this frame
+        if (row_step == 0)
+            return;
+
+        int x_begin = area.x_begin;
+        int x_end = area.x_end;
+        int y_begin = area.y_begin;
+        int y_end = area.y_end;
+
+        MetaShaderInfo const& shader = m_meta_shader_context.shader;
+        auto evaluateRun = [this, &shader, pins, width](int y, int x_begin, int x_end) {
+            if (shader.batch) {
+                shader.batch(m_meta_shader_context, y, x_begin, x_end, pins + y * width);
+                return;
+            }
+
+            Vector2 pin;
+            pin.y = float(y);
+            for (int x = x_begin; x != x_end; ++x) {
+                int index = y * width + x;
+                pin.x = float(x);
+                pins[index] = shader.function(m_meta_shader_context, index, pin, pins[index]);
+            }
+        };
+
+        // the inactive pins of a masked row are skipped
+        auto evaluateRow = [&evaluateRun, mask, x_begin, x_end](int y) {
+            if (!mask) {
+                evaluateRun(y, x_begin, x_end);
+                return;
+            }
+
+            for (PinSpan const* span = mask->rowBegin(y); span != mask->rowEnd(y); ++span) {
+                int begin = maximum(span->x_begin, x_begin);
+                int end = minimum(span->x_end, x_end);
+                if (begin < end)
+                    evaluateRun(y, begin, end);
+            }
+        };
+
+        // the first and last rows are always evaluated, the skipped rows are interpolated between their neighbours.
+        // a shader reading its pins would carry the interpolation over to the next frames, its skipped rows keep their pins
+        int previous = y_begin;
+        evaluateRow(previous);
+
+        while (previous != y_end - 1) {
+            int row = minimum(previous + row_step, y_end - 1);
+            evaluateRow(row);
+
+            if (shader.feedback) {
+                previous = row;
+                continue;
+            }
+
+            float const* a = pins + previous * width;
+            float const* b = pins + row * width;
+            for (int between = previous + 1; between < row; ++between) {
+                float t = float(between - previous) / float(row - previous);
+                float* out = pins + between * width;
+                for (int x = x_begin; x != x_end; ++x)
+                    out[x] = a[x] + (b[x] - a[x]) * t;
+            }
+
+            previous = row;
+        }
+    }
+
+    void PinCanvas::sendPins(FrameProfiler& profiler) {
+        if (!m_pin_sink.enabled())
+            return;
+
+        ScopedStageTimer timer(profiler, FrameStage::Sink);
+        PW_TRACE_ZONE("sink");
+        m_pin_sink.send(m_pins.data(), m_width, m_height);
+    }
+
+    void PinCanvas::uploadPins() {
+        // the rows outside both ranges are zero on the canvas and already zero in the buffer
+        int begin = minimum(m_content_rows_begin, m_uploaded_rows_begin);
+        int end = maximum(m_content_rows_end, m_uploaded_rows_end);
+        if (begin < end) {
+            // the buffer holds the active pins chunk by chunk, the rows go out with the rest of their chunks
+            int first = m_pin_chunks.gather(m_pins.data(), begin, end, m_active_pins);
+            int count = int(m_active_pins.size());
+            if (count > 0)
+                rlUpdateVertexBuffer(m_pin_mesh.vboId[VBO_PIN], m_active_pins.data(), int(count * sizeof(float)), int(first * sizeof(float)));
+        }
+
+        m_uploaded_rows_begin = m_content_rows_begin;
+        m_uploaded_rows_end = m_content_rows_end;
+    }
+
+    void PinCanvas::renderPins(Material const& material, PinAttributes const& attributes) {
+        Mesh& mesh = m_pin_mesh;
+
+        // the program is shared by the canvases
+        float x_start = 0.0f;
+        float y_start = 0.0f;
+        canvasStart(x_start, y_start);
+        setPinCanvasUniforms(material, m_width, m_height, x_start, y_start, m_pin_size_with_margins);
+
+        rlEnableShader(material.shader.id);
+
+        rlSetUniformMatrix(material.shader.locs[SHADER_LOC_MATRIX_VIEW], rlGetMatrixModelview());
+        rlSetUniformMatrix(material.shader.locs[SHADER_LOC_MATRIX_PROJECTION], rlGetMatrixProjection());
+
+        // the chunks in view, nearest first so the depth test drops the pins they hide
+        m_pin_chunks.cull(m_camera, m_viewport.width, m_viewport.height, canvasLayout());
+
+        // Try binding vertex array objects (VAO)
+        rlEnableVertexArray(mesh.vaoId);
+
+        // there is no base instance draw on GL 3.3 and ES, the instance attributes start at the chunk instead
+        int const loc_id = attributes.vertex_id;
+        int const loc_pin = attributes.vertex_pin;
+        for (int index : m_pin_chunks.visible()) {
+            PinChunk const& chunk = m_pin_chunks.chunk(index);
+            size_t offset = size_t(chunk.first) * sizeof(float);
+
+            rlEnableVertexBuffer(mesh.vboId[VBO_IDS]);
+            rlSetVertexAttribute(loc_id, 1, RL_FLOAT, 0, 0, (void*)offset);
+            rlEnableVertexBuffer(mesh.vboId[VBO_PIN]);
+            rlSetVertexAttribute(loc_pin, 1, RL_FLOAT, 0, 0, (void*)offset);
+
+            rlDrawVertexArrayElementsInstanced(0, mesh.triangleCount * 3, 0, chunk.count);
+        }
+
+        rlEnableVertexBuffer(mesh.vboId[VBO_IDS]);
+        rlSetVertexAttribute(loc_id, 1, RL_FLOAT, 0, 0, 0);
+        rlEnableVertexBuffer(mesh.vboId[VBO_PIN]);
+        rlSetVertexAttribute(loc_pin, 1, RL_FLOAT, 0, 0, 0);
+        rlDisableVertexBuffer();
+
+        rlDisableVertexArray();
+
+        rlDisableShader();
+    }
+
+    std::string PinCanvas::statusText() const {
+        std::string text;
+        if (m_shader_scale > 1)
+            text += sfmt(", shader at 1/%d resolution", m_shader_scale);
+        if (m_camera_detail.enabled() && m_camera_detail.reducedTiles() > 0 && !m_keyframes.enabled() && m_shader_scale == 1)
+            text += sfmt(", %d tiles at lower detail", m_camera_detail.reducedTiles());
+        if (m_empty_tiles > 0)
+            text += sfmt(", %d empty tiles skipped", m_empty_tiles);
+        if (m_pin_chunks.visiblePins() < m_pin_chunks.totalPins())
+            text += sfmt(", %d of %d pins drawn", m_pin_chunks.visiblePins(), m_pin_chunks.totalPins());
+        if (m_keyframes.enabled())
+            text += sfmt(", shader keyframes at %.0f Hz", Keyframes::Rate);
+        return text;
+    }
+
+    float PinCanvas::shaderMs() const {
+        return m_shader_ms;
+    }
+
+    float PinCanvas::budgetMs() const {
+        return m_budget_ms;
+    }
+
+    void PinCanvas::unload() {
+        m_keyframes.reset();
+
+        if (m_pin_mesh.vertexCount != 0)
+            UnloadMesh(m_pin_mesh);
+        memset(&m_pin_mesh, 0, sizeof(m_pin_mesh));
+
+        if (m_target.id != 0)
+            UnloadRenderTexture(m_target);
+        memset(&m_target, 0, sizeof(m_target));
+    }
+
+}
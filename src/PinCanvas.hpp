@@ -0,0 +1,159 @@
+#pragma once
+
+#include "Lang.hpp"
+#include "MetaShader.hpp"
+#include "FrameProfiler.hpp"
+#include "AdaptiveResolution.hpp"
+#include "Keyframes.hpp"
+#include "CameraDetail.hpp"
+#include "PinMask.hpp"
+#include "PinChunks.hpp"
+#include "PinMaterial.hpp"
+#include "PinSink.hpp"
+
+namespace pw {
+
+    // one wall, given on the command line as --canvas shader=Water,size=2,speed=0.5,mask=wall.png,sink=host:port
+    struct PinCanvasOptions {
+        std::string shader;         // empty runs the default shader
+        int divisor = 1;            // canvas size divisor, like the menu size option
+        float speed = 1.0f;         // rate of the canvas clock
+        std::string mask;           // png, only the pins under the bright pixels are evaluated and drawn
+        std::string sink;           // host[:port] the pins of every frame are sent to
+    };
+
+    // returns false when the spec has an unknown key or a value that doesn't parse
+    bool parseCanvasOptions(std::string const& spec, PinCanvasOptions& options);
+
+    // the canvas sizes of the menu, 1, 2, 4 or 8
+    bool validCanvasDivisor(int divisor);
+
+    // what the world gives every canvas for a frame
+    struct PinCanvasFrame {
+        double time;                        // world clock, the canvas clock runs from it
+        float budget_ms;                    // share of the frame the canvas shader may take
+        bool headless;
+        AdaptiveResolution& resolution;     // shader costs of every canvas
+        FrameProfiler& profiler;
+    };
+
+    //
+    // Pins of one wall, with its own size, shader, clock and output.
+    // The shaders of a canvas are shared with the other canvases of the world, only the per frame state is its own,
+    // so the canvases are evaluated one after the other and each one spreads its tiles over the shared job system.
+    //
+    class PinCanvas {
+    public:
+        PinCanvas();
+        ~PinCanvas();
+
+        bool loadMask(std::string const& filepath);
+        bool startSink(std::string const& address);
+        void stopSink();
+
+        void setSpeed(float speed);
+
+        // the canvas starts over at the new size on the next computeSizes
+        void setDivisor(int divisor);
+        int divisor() const;
+
+        int width() const;
+        int height() const;
+        std::vector<float> const& pins() const;
+
+        MetaShaderContext& context();
+        std::string const& shaderName() const;
+
+        // takes the shaders of the world context, call when they changed
+        void shareShaders(MetaShaderContext const& source);
+        bool selectShader(std::string const& name);
+        void selectShader(MetaShaderInfo const& shader);
+
+        // the canvas clock starts at time
+        void restart(double time);
+
+        Keyframes& keyframes();
+        CameraDetail& cameraDetail();
+        Camera3D& camera();
+
+        // the area of the window the canvas is drawn in, through a render target when it doesn't cover the whole window
+        void setViewport(Rectangle const& viewport, bool offscreen);
+        Rectangle const& viewport() const;
+        RenderTexture2D const& target() const;
+
+        // allocates the canvas on the first frame and after a size change. the mesh uses material, nothing is drawn without one
+        void computeSizes(double time, Material const* material);
+
+        void update(PinCanvasFrame const& frame);
+        void sendPins(FrameProfiler& profiler);
+
+        void uploadPins();
+        void renderPins(Material const& material, PinAttributes const& attributes);
+
+        // the parts of the status line about this canvas
+        std::string statusText() const;
+
+        // shader milliseconds of the last frame against the canvas budget
+        float shaderMs() const;
+        float budgetMs() const;
+
+        // draw resources, call while the window is open
+        void unload();
+    private:
+        int m_divisor;
+        int m_width;
+        int m_height;
+        float m_pin_size;
+        float m_pin_size_with_margins;
+        float m_pin_height;
+
+        float m_speed;
+        double m_start_time;
+
+        Camera3D m_camera;
+        Rectangle m_viewport;
+        RenderTexture2D m_target;
+
+        std::vector<float> m_pins;
+        Mesh m_pin_mesh;
+        PinMask m_pin_mask;
+
+        // the active pins are drawn by chunks, the ones outside the camera are skipped
+        PinChunks m_pin_chunks;
+        std::vector<float> m_active_pins;       // upload staging in instance order
+
+        // the shader runs on a canvas divided by m_shader_scale when it can't fit its share of the frame
+        AdaptiveResolution::Decision m_resolution;
+        std::vector<float> m_shader_pins;
+        int m_shader_scale;
+        float m_shader_ms;
+        float m_budget_ms;
+
+        // distant and hidden tiles are evaluated at fewer rows
+        CameraDetail m_camera_detail;
+
+        // the pins outside the shader bounds are cleared instead of evaluated
+        std::vector<PinRegion> m_shader_regions;
+        std::vector<PinRegion> m_tile_bounds;
+        int m_empty_tiles;
+
+        // rows that may hold non-zero pins, on the canvas and in the pins vertex buffer
+        int m_content_rows_begin, m_content_rows_end;
+        int m_uploaded_rows_begin, m_uploaded_rows_end;
+
+        MetaShaderContext m_meta_shader_context;
+
+        // pins of every frame to the wall controllers
+        PinSink m_pin_sink;
+
+        // declared after the context, the keyframe in flight finishes before the context goes away
+        Keyframes m_keyframes;
+
+        void evaluateShader(float* pins, int width, int height, CameraDetail const* detail = nullptr, std::vector<PinRegion> const* tile_bounds = nullptr);
+        void evaluateTile(float* pins, int width, PinRegion const& area, int row_step, PinMask const* mask);
+        CanvasLayout canvasLayout() const;
+        float canvasTime(double time) const;
+        void canvasStart(float& x_start, float& y_start) const;
+    };
+
+}
@@ -0,0 +1,125 @@
+#include "PinChunks.hpp"
+
+namespace pw {
+
+    PinChunks::PinChunks()
+        :m_width(0), m_height(0), m_visible_pins(0)
+    { }
+
+    void PinChunks::build(PinMask const& mask, int width, int height) {
+        m_width = width;
+        m_height = height;
+        m_instances.clear();
+        m_chunks.clear();
+        m_row_firsts.clear();
+        m_visible.clear();
+        m_visible_pins = 0;
+
+        for (int y_begin = 0; y_begin < height; y_begin += ChunkHeight) {
+            int y_end = minimum(y_begin + ChunkHeight, height);
+            m_row_firsts.push_back(int(m_instances.size()));
+
+            for (int x_begin = 0; x_begin < width; x_begin += ChunkWidth) {
+                int x_end = minimum(x_begin + ChunkWidth, width);
+
+                PinChunk chunk = { x_begin, y_begin, x_end, y_end, int(m_instances.size()), 0, 1.0f };
+                for (int y = y_begin; y != y_end; ++y) {
+                    for (PinSpan const* span = mask.rowBegin(y); span != mask.rowEnd(y); ++span) {
+                        for (int x = maximum(span->x_begin, x_begin); x < minimum(span->x_end, x_end); ++x)
+                            m_instances.push_back(uint32_t(y * width + x));
+                    }
+                }
+
+                chunk.count = int(m_instances.size()) - chunk.first;
+                if (chunk.count > 0)
+                    m_chunks.push_back(chunk);
+            }
+        }
+
+        m_row_firsts.push_back(int(m_instances.size()));
+    }
+
+    std::vector<uint32_t> const& PinChunks::instances() const {
+        return m_instances;
+    }
+
+    int PinChunks::gather(float const* pins, int y_begin, int y_end, std::vector<float>& out) {
+        out.clear();
+        if (y_begin >= y_end)
+            return 0;
+
+        int first = m_row_firsts[y_begin / ChunkHeight];
+        int last = m_row_firsts[(y_end - 1) / ChunkHeight + 1];
+        out.resize(size_t(last - first));
+
+        for (PinChunk& chunk : m_chunks) {
+            if (chunk.first < first || chunk.first >= last)
+                continue;
+
+            float highest = 0.0f;
+            float* copy = out.data() + (chunk.first - first);
+            for (int i = 0; i != chunk.count; ++i) {
+                float pin = pins[m_instances[chunk.first + i]];
+                copy[i] = pin;
+                highest = maximum(highest, pin);
+            }
+            chunk.highest = highest;
+        }
+
+        return first;
+    }
+
+    void PinChunks::cull(Camera3D const& camera, float screen_width, float screen_height, CanvasLayout const& layout) {
+        m_visible.clear();
+        m_visible_pins = 0;
+        if (screen_width <= 0.0f || screen_height <= 0.0f)
+            return;
+
+        Matrix view_projection = cameraViewProjection(camera, screen_width, screen_height);
+
+        float const s = layout.pin_size;
+        float const x_start = layout.width * s / 2.0f - s / 2.0f;
+        float const z_start = layout.height * s / 2.0f - s / 2.0f;
+
+        m_distances.resize(m_chunks.size());
+        for (int index = 0; index != int(m_chunks.size()); ++index) {
+            PinChunk const& chunk = m_chunks[index];
+
+            Vector3 min = { chunk.x_begin * s - x_start - s / 2.0f, layout.min_y, chunk.y_begin * s - z_start - s / 2.0f };
+            Vector3 max = { (chunk.x_end - 1) * s - x_start + s / 2.0f, layout.max_y - layout.travel * (1.0f - chunk.highest), (chunk.y_end - 1) * s - z_start + s / 2.0f };
+            if (boxOutsideFrustum(view_projection, min, max))
+                continue;
+
+            float dx = (min.x + max.x) / 2.0f - camera.position.x;
+            float dy = (min.y + max.y) / 2.0f - camera.position.y;
+            float dz = (min.z + max.z) / 2.0f - camera.position.z;
+            m_distances[index] = dx * dx + dy * dy + dz * dz;
+
+            m_visible.push_back(index);
+            m_visible_pins += chunk.count;
+        }
+
+        std::sort(m_visible.begin(), m_visible.end(), [this](int a, int b) { return m_distances[a] < m_distances[b]; });
+    }
+
+    std::vector<int> const& PinChunks::visible() const {
+        return m_visible;
+    }
+
+    PinChunk const& PinChunks::chunk(int index) const {
+        return m_chunks[index];
+    }
+
+    int PinChunks::chunkCount() const {
+        return int(m_chunks.size());
+    }
+
+    int PinChunks::visiblePins() const {
+        return m_visible_pins;
+    }
+
+    int PinChunks::totalPins() const {
+        return int(m_instances.size());
+    }
+
+}
@@ -0,0 +1,62 @@
+#pragma once
+
+#include "Lang.hpp"
+#include "PinMask.hpp"
+#include "CameraDetail.hpp"
+
+#include "raylib.h"
+
+namespace pw {
+
+    // a block of pins drawn by one instanced call
+    struct PinChunk {
+        int x_begin, y_begin;       // canvas pins
+        int x_end, y_end;
+        int first;                  // first instance
+        int count;                  // active pins
+        float highest;              // highest pin at the last gather
+    };
+
+    //
+    // The active pins laid out chunk by chunk for drawing, rows of chunks one after the other.
+    // Every frame the chunks outside the camera frustum are dropped and the others are drawn nearest first,
+    // so the depth test rejects most of the hidden fragments. The boxes follow the highest pin of each chunk.
+    //
+    class PinChunks {
+    public:
+        static constexpr int ChunkWidth = 32;
+        static constexpr int ChunkHeight = 32;
+
+        PinChunks();
+
+        void build(PinMask const& mask, int width, int height);
+
+        // canvas index of every instance
+        std::vector<uint32_t> const& instances() const;
+
+        // copies the pins of the chunk rows over [y_begin, y_end) to out in instance order and keeps their highest pins.
+        // returns the first instance copied
+        int gather(float const* pins, int y_begin, int y_end, std::vector<float>& out);
+
+        // picks the chunks to draw this frame, call once per frame
+        void cull(Camera3D const& camera, float screen_width, float screen_height, CanvasLayout const& layout);
+
+        // chunks to draw, nearest first
+        std::vector<int> const& visible() const;
+        PinChunk const& chunk(int index) const;
+
+        int chunkCount() const;
+        int visiblePins() const;
+        int totalPins() const;
+    private:
+        int m_width;
+        int m_height;
+        std::vector<uint32_t> m_instances;
+        std::vector<PinChunk> m_chunks;
+        std::vector<int> m_row_firsts;      // first instance of every row of chunks, and the instances count
+        std::vector<int> m_visible;
+        std::vector<float> m_distances;
+        int m_visible_pins;
+    };
+
+}
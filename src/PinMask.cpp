@@ -0,0 +1,91 @@
+#include "PinMask.hpp"
+
+#include "raylib.h"
+
+namespace pw {
+
+    PinMask::PinMask()
+        :m_bitmap_width(0), m_bitmap_height(0), m_width(0), m_height(0), m_count(0)
+    { }
+
+    bool PinMask::load(std::string const& filepath) {
+        Image image = LoadImage(filepath.c_str());
+        if (!IsImageReady(image)) {
+            TraceLog(LOG_ERROR, "PinMask > unable to load %s", filepath.c_str());
+            return false;
+        }
+
+        Color* colors = LoadImageColors(image);
+        m_bitmap_width = image.width;
+        m_bitmap_height = image.height;
+        m_bitmap.resize(size_t(image.width) * image.height);
+        for (size_t i = 0; i != m_bitmap.size(); ++i) {
+            Color const& c = colors[i];
+            m_bitmap[i] = (int(c.r) + int(c.g) + int(c.b)) * int(c.a) > 3 * 255 * 128 ? 1 : 0;
+        }
+        UnloadImageColors(colors);
+        UnloadImage(image);
+
+        TraceLog(LOG_INFO, "PinMask > %s %dx%d", filepath.c_str(), m_bitmap_width, m_bitmap_height);
+
+        // refits the current canvas
+        if (m_width > 0 && m_height > 0)
+            fit(m_width, m_height);
+        return true;
+    }
+
+    void PinMask::fit(int width, int height) {
+        m_width = width;
+        m_height = height;
+        m_count = 0;
+        m_spans.clear();
+        m_row_spans.assign(size_t(height) + 1, 0);
+
+        for (int y = 0; y != height; ++y) {
+            m_row_spans[y] = int(m_spans.size());
+
+            // nearest pixel under the pin center
+            int by = m_bitmap.empty() ? 0 : minimum(int((y + 0.5f) * m_bitmap_height / height), m_bitmap_height - 1);
+
+            int span_begin = -1;
+            for (int x = 0; x <= width; ++x) {
+                bool active = false;
+                if (x < width) {
+                    int bx = m_bitmap.empty() ? 0 : minimum(int((x + 0.5f) * m_bitmap_width / width), m_bitmap_width - 1);
+                    active = m_bitmap.empty() || m_bitmap[size_t(by) * m_bitmap_width + bx];
+                }
+
+                if (active) {
+                    ++m_count;
+                    if (span_begin < 0)
+                        span_begin = x;
+                } else if (span_begin >= 0) {
+                    m_spans.push_back({ span_begin, x });
+                    span_begin = -1;
+                }
+            }
+        }
+
+        m_row_spans[height] = int(m_spans.size());
+
+        if (enabled())
+            TraceLog(LOG_INFO, "PinMask > %d of %d pins active in %d spans", count(), width * height, int(m_spans.size()));
+    }
+
+    bool PinMask::enabled() const {
+        return m_count != m_width * m_height;
+    }
+
+    int PinMask::count() const {
+        return m_count;
+    }
+
+    PinSpan const* PinMask::rowBegin(int y) const {
+        return m_spans.data() + m_row_spans[y];
+    }
+
+    PinSpan const* PinMask::rowEnd(int y) const {
+        return m_spans.data() + m_row_spans[y + 1];
+    }
+
+}
@@ -0,0 +1,49 @@
+#pragma once
+
+#include "Lang.hpp"
+
+namespace pw {
+
+    // pins [x_begin, x_end) of a canvas row
+    struct PinSpan {
+        int x_begin;
+        int x_end;
+    };
+
+    //
+    // The pins of an installation that isn't a full rectangle, around columns, doors and curved edges.
+    // A bitmap stretched over the canvas, the pins under pixels brighter than half are active.
+    // The active pins are compacted in spans per row, the shaders run over them and PinChunks lays them out for drawing.
+    //
+    class PinMask {
+    public:
+        PinMask();
+
+        // the bitmap is kept and fitted to every canvas size, returns false when it doesn't load
+        bool load(std::string const& filepath);
+
+        // builds the active pins of a canvas, every pin is active without a bitmap
+        void fit(int width, int height);
+
+        // some pins are inactive
+        bool enabled() const;
+
+        // active pins
+        int count() const;
+
+        // the active spans of row y
+        PinSpan const* rowBegin(int y) const;
+        PinSpan const* rowEnd(int y) const;
+    private:
+        std::vector<uint8_t> m_bitmap;      // 1 for the active pixels
+        int m_bitmap_width;
+        int m_bitmap_height;
+
+        int m_width;
+        int m_height;
+        int m_count;
+        std::vector<PinSpan> m_spans;
+        std::vector<int> m_row_spans;       // height + 1
+    };
+
+}
@@ -1,6 +1,7 @@
 #include "Text.hpp"
 
 #include "PinMaterial.hpp"
+#include "ProgramCache.hpp"
 #include "raylib.h"
 #include "rlgl.h"
 #include "config.h"
@@ -111,28 +112,47 @@ std::string ps = R"V0G0N(
 
 namespace pw {
 
-    Material loadPinMaterial(
-        Mesh& mesh, std::vector<float>& pins,
-        int w, int h, 
-        float x_start, float y_start, 
-        float pin_size
-    ) {
-        int count = int(pins.size());
-
+    Material loadPinMaterial(std::string const& cache_filepath) {
         Material material;
         material.maps = (MaterialMap*)calloc(MAX_MATERIAL_MAPS, sizeof(MaterialMap));
 
         const auto [vs, ps] = buildCode();
-        material.shader = LoadShaderFromMemory(vs.c_str(), ps.c_str());
+        material.shader = loadCachedShader(vs, ps, cache_filepath);
 
-        int loc_vertex_id = rlGetLocationAttrib(material.shader.id, "vertexId");
-        int loc_vertex_pin = rlGetLocationAttrib(material.shader.id, "vertexPin");
+        material.maps[MATERIAL_MAP_DIFFUSE].color = RED; 
+
+        return material;
+    }
 
+    void loadPinInstances(Mesh& mesh, Material const& material, int capacity) {
+        auto [loc_vertex_id, loc_vertex_pin] = pinAttributes(material);
+
+        //
+        // setup ids, the canvas position of every instance
+        //
+        rlEnableVertexArray(mesh.vaoId);
+            mesh.vboId[VBO_IDS] = rlLoadVertexBuffer(nullptr, capacity * 1 * sizeof(float), true);
+            rlSetVertexAttribute(loc_vertex_id, 1, RL_FLOAT, 0, 0, 0);
+            rlEnableVertexAttribute(loc_vertex_id);
+            rlSetVertexAttributeDivisor(loc_vertex_id, 1);
+        rlDisableVertexArray();
+
+        //
+        // setup pins
+        //
+        rlEnableVertexArray(mesh.vaoId);
+            mesh.vboId[VBO_PIN] = rlLoadVertexBuffer(nullptr, capacity * 1 * sizeof(float), true);
+            rlSetVertexAttribute(loc_vertex_pin, 1, RL_FLOAT, 0, 0, 0);
+            rlEnableVertexAttribute(loc_vertex_pin);
+            rlSetVertexAttributeDivisor(loc_vertex_pin, 1);
+        rlDisableVertexArray();
+    }
+
+    void setPinCanvasUniforms(Material const& material, int w, int h, float x_start, float y_start, float pin_size) {
         int loc_canvas_size = rlGetLocationUniform(material.shader.id, "canvasSize");
         int loc_canvas_start_position = rlGetLocationUniform(material.shader.id, "canvasStartPosition");
         int loc_canvas_pin_size = rlGetLocationUniform(material.shader.id, "canvasPinSize");
 
-
         // setup the uniforms
         rlEnableShader(material.shader.id);
             float canvas_size[] = { float(w), float(h) };
@@ -143,39 +163,34 @@ namespace pw {
 
             rlSetUniform(loc_canvas_pin_size, &pin_size, RL_SHADER_UNIFORM_FLOAT, 1);
         rlDisableShader();
+    }
 
-        material.maps[MATERIAL_MAP_DIFFUSE].color = RED; 
-
-        //
-        // setup ids
-        //
-        {
-            std::vector<float> ids(count, 0.0f);
+    void updatePinCanvas(
+        Mesh& mesh, Material const& material,
+        std::vector<float> const& pins, std::vector<uint32_t> const& instances,
+        int w, int h, 
+        float x_start, float y_start, 
+        float pin_size
+    ) {
+        int count = int(instances.size());
 
-            for (size_t i = 0; i != ids.size(); ++i)
-                ids[i] = float(i);
+        setPinCanvasUniforms(material, w, h, x_start, y_start, pin_size);
 
-            rlEnableVertexArray(mesh.vaoId);
-                mesh.vboId[VBO_IDS] = rlLoadVertexBuffer(ids.data(), count * 1 * sizeof(float), false);
-                rlSetVertexAttribute(loc_vertex_id, 1, RL_FLOAT, 0, 0, 0);
-                rlEnableVertexAttribute(loc_vertex_id);
-                rlSetVertexAttributeDivisor(loc_vertex_id, 1);
-            rlDisableVertexArray();
-        }
+        if (count == 0)
+            return;
 
+        std::vector<float> ids(count, 0.0f);
+        for (size_t i = 0; i != ids.size(); ++i)
+            ids[i] = float(instances[i]);
 
-        //
-        // setup pins
-        //
-        {
-            rlEnableVertexArray(mesh.vaoId);
-                mesh.vboId[VBO_PIN] = rlLoadVertexBuffer(pins.data(), count * 1 * sizeof(float), true);
-                rlSetVertexAttribute(loc_vertex_pin, 1, RL_FLOAT, 0, 0, 0);
-                rlEnableVertexAttribute(loc_vertex_pin);
-                rlSetVertexAttributeDivisor(loc_vertex_pin, 1);
-            rlDisableVertexArray();
-        }
+        rlUpdateVertexBuffer(mesh.vboId[VBO_IDS], ids.data(), count * 1 * sizeof(float), 0);
+        rlUpdateVertexBuffer(mesh.vboId[VBO_PIN], pins.data(), count * 1 * sizeof(float), 0);
+    }
 
-        return material;
+    PinAttributes pinAttributes(Material const& material) {
+        return {
+            rlGetLocationAttrib(material.shader.id, "vertexId"),
+            rlGetLocationAttrib(material.shader.id, "vertexPin")
+        };
     }
 }
\ No newline at end of file
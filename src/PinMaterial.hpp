@@ -6,15 +6,34 @@
 namespace pw {
 
     constexpr int VBO_IDS = 3;
-    constexpr int VBO_PIN = 3;
+    constexpr int VBO_PIN = 4;
 
-    Material loadPinMaterial(
-        Mesh& mesh, std::vector<float>& pins,
+    // per instance attributes of the pin material
+    struct PinAttributes {
+        int vertex_id;
+        int vertex_pin;
+    };
+
+    // compiles the pin program, or loads it from the binary the last session saved in cache_filepath
+    Material loadPinMaterial(std::string const& cache_filepath);
+
+    // instance buffers for up to capacity pins, they are kept over canvas changes
+    void loadPinInstances(Mesh& mesh, Material const& material, int capacity);
+
+    // the canvas the program draws, the canvases that share the program set it before their draws
+    void setPinCanvasUniforms(Material const& material, int w, int h, float x_start, float y_start, float pin_size);
+
+    // one instance per entry of instances, the canvas index of the pin it draws.
+    // pins holds the pins in the same order
+    void updatePinCanvas(
+        Mesh& mesh, Material const& material,
+        std::vector<float> const& pins, std::vector<uint32_t> const& instances,
         int w, int h, 
         float x_start, float y_start, 
         float pin_size
     );
 
+    PinAttributes pinAttributes(Material const& material);
 
  
 }
\ No newline at end of file
@@ -0,0 +1,261 @@
+#include "PinSink.hpp"
+#include "PinWorldSink.h"
+#include "Trace.hpp"
+
+#include "raylib.h"
+
+#if !defined(_WIN32) && !defined(__EMSCRIPTEN__)
+#include <netdb.h>
+#include <sys/socket.h>
+#include <sys/types.h>
+#include <unistd.h>
+#define PW_SINK_SOCKETS
+#endif
+
+namespace pw {
+
+    // datagrams per sendmmsg call
+    constexpr int SinkBatch = 64;
+
+    PinSink::PinSink()
+        :m_socket(-1), m_pending_width(0), m_pending_height(0), m_has_pending(false), m_quit(false), m_sent_frames(0), m_skipped_frames(0),
+        m_sent_width(0), m_sent_height(0), m_frame(0), m_packet(0), m_frames_since_keyframe(0)
+    { }
+
+    PinSink::~PinSink() {
+        stop();
+    }
+
+    bool PinSink::start(std::string const& address) {
+        stop();
+
+#if defined(PW_SINK_SOCKETS)
+        std::string host = address;
+        std::string port = std::to_string(PINWORLD_SINK_DEFAULT_PORT);
+        size_t colon = address.rfind(':');
+        if (colon != std::string::npos) {
+            host = address.substr(0, colon);
+            port = address.substr(colon + 1);
+        }
+
+        addrinfo hints{};
+        hints.ai_family = AF_UNSPEC;
+        hints.ai_socktype = SOCK_DGRAM;
+
+        addrinfo* found = nullptr;
+        if (getaddrinfo(host.c_str(), port.c_str(), &hints, &found) != 0 || !found) {
+            TraceLog(LOG_ERROR, "Sink > unable to resolve %s", address.c_str());
+            return false;
+        }
+
+        m_socket = socket(found->ai_family, found->ai_socktype, found->ai_protocol);
+        m_address.assign((uint8_t const*)found->ai_addr, (uint8_t const*)found->ai_addr + found->ai_addrlen);
+        freeaddrinfo(found);
+
+        if (m_socket < 0) {
+            TraceLog(LOG_ERROR, "Sink > unable to open a socket for %s", address.c_str());
+            return false;
+        }
+
+        // a keyframe of the largest canvas goes out in one burst
+        int buffer_size = 1 << 20;
+        setsockopt(m_socket, SOL_SOCKET, SO_SNDBUF, &buffer_size, sizeof(buffer_size));
+
+        m_quit = false;
+        m_has_pending = false;
+        m_sent_width = m_sent_height = 0;
+        m_thread = std::thread([this]() { run(); });
+
+        TraceLog(LOG_INFO, "Sink > sending pins to %s:%s", host.c_str(), port.c_str());
+        return true;
+#else
+        TraceLog(LOG_ERROR, "Sink > UDP output isn't available on this platform");
+        return false;
+#endif
+    }
+
+    void PinSink::stop() {
+        if (m_thread.joinable()) {
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                m_quit = true;
+            }
+            m_condition.notify_one();
+            m_thread.join();
+        }
+
+#if defined(PW_SINK_SOCKETS)
+        if (m_socket >= 0)
+            close(m_socket);
+#endif
+        m_socket = -1;
+    }
+
+    bool PinSink::enabled() const {
+        return m_socket >= 0;
+    }
+
+    void PinSink::send(float const* pins, int width, int height) {
+        if (!enabled())
+            return;
+
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (m_has_pending)
+                m_skipped_frames++;
+
+            size_t count = size_t(width) * height;
+            m_pending.resize(count);
+            for (size_t i = 0; i != count; ++i)
+                m_pending[i] = uint8_t(clampTo(pins[i], 0.0f, 1.0f) * 255.0f + 0.5f);
+
+            m_pending_width = width;
+            m_pending_height = height;
+            m_has_pending = true;
+        }
+        m_condition.notify_one();
+    }
+
+    uint64_t PinSink::sentFrames() const {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_sent_frames;
+    }
+
+    uint64_t PinSink::skippedFrames() const {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_skipped_frames;
+    }
+
+    void PinSink::run() {
+        traceThreadName("sink");
+
+        for (;;) {
+            int width = 0;
+            int height = 0;
+            {
+                std::unique_lock<std::mutex> lock(m_mutex);
+                m_condition.wait(lock, [this]() { return m_quit || m_has_pending; });
+
+                // the last frame still goes out, the wall stops on it
+                if (!m_has_pending)
+                    return;
+
+                std::swap(m_current, m_pending);
+                width = m_pending_width;
+                height = m_pending_height;
+                m_has_pending = false;
+            }
+
+            {
+                PW_TRACE_ZONE("sink");
+                sendFrame(width, height);
+            }
+
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_sent_frames++;
+        }
+    }
+
+    void PinSink::sendFrame(int width, int height) {
+        bool keyframe = width != m_sent_width || height != m_sent_height || m_frames_since_keyframe >= PINWORLD_SINK_KEYFRAME_INTERVAL;
+        uint16_t flags = keyframe ? PINWORLD_SINK_KEYFRAME : 0;
+        int rows_per_packet = pinworld_sink_rows_per_packet(width, 1);
+
+        m_datagram_sizes.clear();
+
+        // runs of changed rows, split at the datagram size
+        int run_begin = -1;
+        for (int y = 0; y != height; ++y) {
+            size_t first = size_t(y) * width;
+            bool changed = keyframe || memcmp(m_current.data() + first, m_sent.data() + first, size_t(width)) != 0;
+
+            if (changed && run_begin < 0)
+                run_begin = y;
+
+            if (run_begin >= 0 && (!changed || y + 1 - run_begin == rows_per_packet)) {
+                int run_end = changed ? y + 1 : y;
+                addDatagram(width, height, run_begin, run_end - run_begin, flags);
+                run_begin = -1;
+            }
+        }
+        if (run_begin >= 0)
+            addDatagram(width, height, run_begin, height - run_begin, flags);
+
+        // a frame without changes still tells the receiver it is complete
+        if (m_datagram_sizes.empty())
+            addDatagram(width, height, 0, 0, flags);
+
+        PinWorldSinkPacket* last = (PinWorldSinkPacket*)(m_datagrams.data() + (m_datagram_sizes.size() - 1) * PINWORLD_SINK_MAX_DATAGRAM);
+        last->flags |= PINWORLD_SINK_END_OF_FRAME;
+
+        flushDatagrams();
+
+        std::swap(m_sent, m_current);
+        m_sent_width = width;
+        m_sent_height = height;
+        m_frame++;
+        m_frames_since_keyframe = keyframe ? 1 : m_frames_since_keyframe + 1;
+    }
+
+    void PinSink::addDatagram(int width, int height, int row_begin, int row_count, uint16_t flags) {
+        size_t index = m_datagram_sizes.size();
+        m_datagrams.resize((index + 1) * PINWORLD_SINK_MAX_DATAGRAM);
+        uint8_t* datagram = m_datagrams.data() + index * PINWORLD_SINK_MAX_DATAGRAM;
+
+        PinWorldSinkPacket packet{};
+        packet.magic = PINWORLD_SINK_MAGIC;
+        packet.version = PINWORLD_SINK_VERSION;
+        packet.flags = flags;
+        packet.packet = m_packet++;
+        packet.frame = m_frame;
+        packet.width = uint16_t(width);
+        packet.height = uint16_t(height);
+        packet.row_begin = uint16_t(row_begin);
+        packet.row_count = uint16_t(row_count);
+        packet.format = PINWORLD_SINK_UINT8;
+        memcpy(datagram, &packet, sizeof(packet));
+
+        size_t pins = size_t(row_count) * width;
+        memcpy(datagram + sizeof(packet), m_current.data() + size_t(row_begin) * width, pins);
+        m_datagram_sizes.push_back(int(sizeof(packet) + pins));
+    }
+
+    void PinSink::flushDatagrams() {
+#if defined(PW_SINK_SOCKETS)
+        int count = int(m_datagram_sizes.size());
+        sockaddr const* address = (sockaddr const*)m_address.data();
+        socklen_t address_size = socklen_t(m_address.size());
+
+#if defined(__linux__)
+        // one system call per batch of datagrams
+        mmsghdr messages[SinkBatch];
+        iovec buffers[SinkBatch];
+
+        for (int first = 0; first < count; ) {
+            int batch = minimum(SinkBatch, count - first);
+            for (int i = 0; i != batch; ++i) {
+                buffers[i].iov_base = m_datagrams.data() + size_t(first + i) * PINWORLD_SINK_MAX_DATAGRAM;
+                buffers[i].iov_len = size_t(m_datagram_sizes[first + i]);
+
+                messages[i] = mmsghdr{};
+                messages[i].msg_hdr.msg_name = (void*)address;
+                messages[i].msg_hdr.msg_namelen = address_size;
+                messages[i].msg_hdr.msg_iov = &buffers[i];
+                messages[i].msg_hdr.msg_iovlen = 1;
+            }
+
+            int sent = sendmmsg(m_socket, messages, unsigned(batch), 0);
+            if (sent <= 0)
+                break;
+            first += sent;
+        }
+#else
+        for (int i = 0; i != count; ++i) {
+            if (sendto(m_socket, m_datagrams.data() + size_t(i) * PINWORLD_SINK_MAX_DATAGRAM, size_t(m_datagram_sizes[i]), 0, address, address_size) < 0)
+                break;
+        }
+#endif
+#endif
+    }
+
+}
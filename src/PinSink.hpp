@@ -0,0 +1,67 @@
+#pragma once
+
+#include "Lang.hpp"
+
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+namespace pw {
+
+    //
+    // Sends the pins of every frame over UDP to the controllers of a physical pin wall, see PinWorldSink.h.
+    // The frame thread only quantizes the pins, a sender thread finds the rows that changed, packs them in datagrams
+    // and sends them in batches. A sender that falls behind skips to the newest frame, the rows are compared
+    // with the last frame it sent so no change is lost.
+    //
+    class PinSink {
+    public:
+        PinSink();
+        ~PinSink();
+
+        // address is host or host:port, returns false when it doesn't resolve or sockets aren't available
+        bool start(std::string const& address);
+        void stop();
+
+        bool enabled() const;
+
+        // quantizes the pins for the sender, never waits for the network
+        void send(float const* pins, int width, int height);
+
+        // frames sent, and frames replaced by a newer one before they were sent
+        uint64_t sentFrames() const;
+        uint64_t skippedFrames() const;
+    private:
+        int m_socket;
+        std::vector<uint8_t> m_address;     // sockaddr of the destination
+        std::thread m_thread;
+
+        // the newest frame, handed from send to the sender
+        mutable std::mutex m_mutex;
+        std::condition_variable m_condition;
+        std::vector<uint8_t> m_pending;
+        int m_pending_width;
+        int m_pending_height;
+        bool m_has_pending;
+        bool m_quit;
+        uint64_t m_sent_frames;
+        uint64_t m_skipped_frames;
+
+        // sender thread state
+        std::vector<uint8_t> m_current;
+        std::vector<uint8_t> m_sent;        // last frame sent
+        int m_sent_width;
+        int m_sent_height;
+        uint32_t m_frame;
+        uint32_t m_packet;
+        int m_frames_since_keyframe;
+        std::vector<uint8_t> m_datagrams;   // one MTU sized buffer per datagram of the frame
+        std::vector<int> m_datagram_sizes;
+
+        void run();
+        void sendFrame(int width, int height);
+        void addDatagram(int width, int height, int row_begin, int row_count, uint16_t flags);
+        void flushDatagrams();
+    };
+
+}
@@ -1,5 +1,7 @@
 #include "PinWorld.hpp"
 #include "PinMaterial.hpp"
+#include "Trace.hpp"
+#include "Jobs.hpp"
 
 #include "rlgl.h"
 #include "raymath.h"
@@ -19,29 +21,43 @@ static void DrawFPSWithText(int posX, int posY, std::string const& text) {
 
 namespace pw {
 
+    // how much history the profiler dump key writes
+    constexpr int64_t ProfilerDumpSeconds = 10;
+
+    // measured cost of each shader, picks the shader resolution on the first frame of the next session
+    constexpr const char* ShaderCostsFile = "pinworld_shader_costs.txt";
+
+    // linked pin program of the last session, only used by the driver that saved it
+    constexpr const char* PinProgramFile = "pinworld_pin_program.bin";
+
+    // how far apart the canvases are drawn in the window
+    constexpr float ViewportMargin = 2.0f;
+
     PinWorld::PinWorld()
-        :m_window_width(0.0f), m_window_height(0.0f), m_start_time(0.0)
+        :m_window_width(0.0f), m_window_height(0.0f), m_headless(false), m_headless_time(0.0), m_profiler_overlay(false), m_focus(0), m_first_canvas(0)
     {
-        m_camera = { 0 };
-        m_camera.position = { 10.0f, 5.0f, 5.0f };  // Camera position
-        m_camera.target = { 0.0f, 0.0f, 0.0f };      // Camera looking at point
-        m_camera.up = { 0.0f, 1.0f, 0.0f };          // Camera up vector (rotation towards target)
-        m_camera.fovy = 45.0f;                       // Camera field-of-view Y
-        m_camera.projection = CAMERA_PERSPECTIVE;    // Camera mode type
-
-        memset(&m_pin_mesh, 0, sizeof(m_pin_mesh));
         memset(&m_pin_material, 0, sizeof(m_pin_material));
+        m_pin_attributes = { -1, -1 };
+    }
 
-        m_canvas_divisor = 1;
+    PinWorld::~PinWorld() {
 
-        float margin_factor = 0.0f;//0.05f;
-        m_pin_size_with_margins = 1.0f;
-        m_pin_height = 2.0f;
-        m_pin_size = m_pin_size_with_margins * (1.0f - 2.0f * margin_factor);
     }
 
-    PinWorld::~PinWorld() {
+    bool PinWorld::addCanvas(PinCanvasOptions const& options) {
+        auto canvas = std::make_unique<PinCanvas>();
+        canvas->setDivisor(options.divisor);
+        canvas->setSpeed(options.speed);
+
+        if (!options.mask.empty() && !canvas->loadMask(options.mask))
+            return false;
 
+        if (!options.sink.empty() && !canvas->startSink(options.sink))
+            return false;
+
+        m_canvases.push_back(std::move(canvas));
+        m_pending_shaders.push_back(options.shader);
+        return true;
     }
 
 	void PinWorld::setup() {
@@ -73,22 +89,55 @@ namespace pw {
 
 		//DisableCursor();                // Limit cursor to relative movement inside the window
 
+        if (m_canvases.empty()) {
+            PinCanvasOptions options;
+            options.divisor = 2;    // the menu default size
+            addCanvas(options);
+        }
+
 		computeSizes();
 
 		SetTraceLogLevel(LOG_DEBUG);
 
-        setupMetaShaders(m_meta_shader_context);
+		traceThreadName("main");
+		m_profiler.setup();
+		if (const char* frames = getenv("PINWORLD_TRACE_FRAMES"))
+			traceStart(atoi(frames));
 
+        m_adaptive_resolution.load(ShaderCostsFile);
+
+        // the first frame shows up as soon as the default shader is ready
+        setupMetaShaders(m_meta_shader_context, false);
+        m_meta_shader_watcher.start();
+        shareShaders();
+
+        // the canvases start from their options, not from the menu defaults
         m_menu.setup(m_meta_shader_context);
+        m_menu.takeActions();
+        m_menu.focusCanvas(m_canvases[m_focus]->context(), m_canvases[m_focus]->divisor());
 	}
 
     void PinWorld::shutdown() {
-        m_menu.shutdown();
+        waitKeyframes();
+        m_meta_shader_watcher.stop();
+        for (auto& canvas : m_canvases)
+            canvas->stopSink();
+
+        if (!m_headless) {
+            m_adaptive_resolution.save();
+            m_menu.shutdown();
 
-        UnloadMesh(m_pin_mesh);
-        UnloadMaterial(m_pin_material);
+            for (auto& canvas : m_canvases)
+                canvas->unload();
+            UnloadMaterial(m_pin_material);
+        }
 
-        CloseWindow();        // Close window and OpenGL context
+        // the python vms free into the pocketpy memory pools, which are static and may go before the world
+        m_canvases.clear();
+        m_meta_shader_context = MetaShaderContext();
+
+        if (!m_headless)
+            CloseWindow();        // Close window and OpenGL context
     }
     
     void PinWorld::run() {
@@ -96,25 +145,217 @@ namespace pw {
             step();
     }
 
+    int PinWorld::runHeadless(HeadlessOptions const& options) {
+        m_headless = true;
+        m_headless_time = 0.0;
+
+        if (m_canvases.empty())
+            addCanvas(PinCanvasOptions());
+
+        // the scale would depend on the machine speed
+        m_adaptive_resolution.setEnabled(false);
+
+        SetTraceLogLevel(LOG_INFO);
+        traceThreadName("main");
+        seedRandom(options.seed);
+
+        setupMetaShaders(m_meta_shader_context);
+
+        for (std::string const& shader : m_pending_shaders) {
+            bool found = shader.empty() || std::any_of(m_meta_shader_context.shaders.begin(), m_meta_shader_context.shaders.end(),
+                [&shader](auto const& current) { return current.name == shader; });
+
+            if (!found) {
+                TraceLog(LOG_ERROR, "Headless > shader '%s' not found, available:", shader.c_str());
+                for (auto const& current : m_meta_shader_context.shaders)
+                    TraceLog(LOG_ERROR, "Headless >   %s", current.name.c_str());
+                return 1;
+            }
+        }
+
+        shareShaders();
+
+        bool dump = !options.output.empty() && (options.png || options.raw);
+        if (dump && fileType(options.output) != FileType::FileDirectory && !makeDirectory(options.output)) {
+            TraceLog(LOG_ERROR, "Headless > unable to create %s", options.output.c_str());
+            return 1;
+        }
+
+        computeSizes();
+
+        // the checksum covers every frame, two runs with the same options give the same value
+        std::vector<uint64_t> checksums(m_canvases.size(), 0xcbf29ce484222325ull);
+        int64_t start = getCurrentMicroseconds();
+
+        for (int frame = 0; frame != options.frames; ++frame) {
+            m_headless_time = frame / double(options.fps);
+
+            {
+                PW_TRACE_ZONE("update");
+                update();
+            }
+
+            for (size_t i = 0; i != m_canvases.size(); ++i) {
+                uint64_t& checksum = checksums[i];
+                for (float pin : m_canvases[i]->pins()) {
+                    uint32_t bits;
+                    memcpy(&bits, &pin, sizeof(bits));
+                    checksum = (checksum ^ bits) * 0x100000001b3ull;
+                }
+
+                if (dump && !dumpPins(options, int(i), frame))
+                    return 1;
+            }
+
+            traceFrame();
+        }
+
+        double elapsed = (getCurrentMicroseconds() - start) / 1000000.0;
+        if (m_canvases.size() == 1) {
+            PinCanvas const& canvas = *m_canvases[0];
+            TraceLog(LOG_INFO, "Headless > %d frames of '%s' at %dx%d in %.3f s (%.3f ms per frame)", options.frames,
+                canvas.shaderName().c_str(), canvas.width(), canvas.height(), elapsed, 1000.0 * elapsed / maximum(1, options.frames));
+            TraceLog(LOG_INFO, "Headless > checksum %016llx", (unsigned long long)checksums[0]);
+            return 0;
+        }
+
+        TraceLog(LOG_INFO, "Headless > %d frames of %d canvases in %.3f s (%.3f ms per frame)", options.frames,
+            int(m_canvases.size()), elapsed, 1000.0 * elapsed / maximum(1, options.frames));
+        for (size_t i = 0; i != m_canvases.size(); ++i) {
+            PinCanvas const& canvas = *m_canvases[i];
+            TraceLog(LOG_INFO, "Headless > canvas %d '%s' at %dx%d checksum %016llx", int(i),
+                canvas.shaderName().c_str(), canvas.width(), canvas.height(), (unsigned long long)checksums[i]);
+        }
+
+        return 0;
+    }
+
+    bool PinWorld::dumpPins(HeadlessOptions const& options, int canvas, int frame) {
+        PinCanvas const& source = *m_canvases[canvas];
+        std::vector<float> const& pins = source.pins();
+
+        std::string name = m_canvases.size() == 1 ? sfmt("frame_%05d", frame) : sfmt("canvas_%d_frame_%05d", canvas, frame);
+        std::string base = mergePaths(options.output, name);
+
+        if (options.raw) {
+            std::vector<uint8_t> data(pins.size() * sizeof(float));
+            memcpy(data.data(), pins.data(), data.size());
+            if (!writeRawBinary(base + ".pins", data)) {
+                TraceLog(LOG_ERROR, "Headless > unable to write %s.pins", base.c_str());
+                return false;
+            }
+        }
+
+        if (options.png) {
+            std::vector<uint8_t> pixels(pins.size());
+            for (size_t i = 0; i != pins.size(); ++i)
+                pixels[i] = uint8_t(pins[i] * 255.0f + 0.5f);
+
+            Image image = { pixels.data(), source.width(), source.height(), 1, PIXELFORMAT_UNCOMPRESSED_GRAYSCALE };
+            if (!ExportImage(image, (base + ".png").c_str())) {
+                TraceLog(LOG_ERROR, "Headless > unable to write %s.png", base.c_str());
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    double PinWorld::currentTime() const {
+        return m_headless ? m_headless_time : GetTime();
+    }
+
     void PinWorld::step() {
-        update();
-        render();
+        {
+            PW_TRACE_ZONE("update");
+            update();
+        }
+
+        {
+            PW_TRACE_ZONE("render");
+            render();
+        }
+
+        traceFrame();
     }
     
     void PinWorld::render() {
-        BeginDrawing();
-            renderBackground();
+        PinCanvas& focus = *m_canvases[m_focus];
+        bool offscreen = m_canvases.size() > 1;
+
+        {
+            ScopedStageTimer timer(m_profiler, FrameStage::Upload);
+            for (auto& canvas : m_canvases) {
+                ScopedStageCounters counters(m_profiler, FrameStage::Upload, canvas->shaderName());
+                canvas->uploadPins();
+            }
+        }
+
+        // every canvas is drawn into its own target, with its own camera
+        if (offscreen) {
+            ScopedStageTimer timer(m_profiler, FrameStage::Draw);
+            for (auto& canvas : m_canvases) {
+                RenderTexture2D const& target = canvas->target();
+                BeginTextureMode(target);
+                    renderBackground(canvas->camera(), target.texture.width, target.texture.height);
+
+                    BeginMode3D(canvas->camera());
+                        canvas->renderPins(m_pin_material, m_pin_attributes);
+                    EndMode3D();
+                EndTextureMode();
+            }
+        }
 
-            BeginMode3D(m_camera);
-                renderPins();
-                //DrawGrid(std::max(m_canvas_width, m_canvas_height) + 10, 1.0f);
-            EndMode3D();
+        BeginDrawing();
+        {
+            ScopedStageTimer timer(m_profiler, FrameStage::Draw);
+            if (offscreen) {
+                ClearBackground(DARKGRAY);
+
+                // render targets are upside down
+                for (auto& canvas : m_canvases) {
+                    RenderTexture2D const& target = canvas->target();
+                    Rectangle source = { 0.0f, 0.0f, float(target.texture.width), -float(target.texture.height) };
+                    DrawTextureRec(target.texture, source, { canvas->viewport().x, canvas->viewport().y }, WHITE);
+                }
+            } else {
+                renderBackground(focus.camera(), GetRenderWidth(), GetRenderHeight());
+
+                BeginMode3D(focus.camera());
+                    focus.renderPins(m_pin_material, m_pin_attributes);
+                    //DrawGrid(std::max(m_canvas_width, m_canvas_height) + 10, 1.0f);
+                EndMode3D();
+            }
+        }
 
-            if (m_menu.showing())
-                DrawFPSWithText(5, 5, "'m' for cookies");
+        {
+            ScopedStageTimer timer(m_profiler, FrameStage::Gui);
+            if (m_menu.showing()) {
+                std::string text = "'m' for cookies";
+                if (offscreen)
+                    text += sfmt(", canvas %d of %d ('tab' for the next)", m_focus + 1, int(m_canvases.size()));
+                text += focus.statusText();
+                DrawFPSWithText(5, 5, text);
+
+                // what every wall shows and how much of its share of the frame the shader takes
+                if (offscreen) {
+                    for (size_t i = 0; i != m_canvases.size(); ++i) {
+                        PinCanvas const& canvas = *m_canvases[i];
+                        Rectangle const& viewport = canvas.viewport();
+                        Color color = canvas.shaderMs() > canvas.budgetMs() ? RED : DARKGRAY;
+                        DrawText(TextFormat("%s %dx%d, %.1f of %.1f ms", canvas.shaderName().c_str(), canvas.width(), canvas.height(), canvas.shaderMs(), canvas.budgetMs()),
+                            int(viewport.x) + 5, int(viewport.y + viewport.height) - 25, 20, color);
+                        if (int(i) == m_focus)
+                            DrawRectangleLinesEx(viewport, 2.0f, LIME);
+                    }
+                }
+            }
 
+            if (m_profiler_overlay)
+                m_profiler.renderOverlay(5, 30, focus.shaderName());
 
             m_menu.render();
+        }
         EndDrawing();
     }
 
@@ -148,14 +389,14 @@ namespace pw {
         return color;
     }
 
-    void PinWorld::renderBackground() {
+    void PinWorld::renderBackground(Camera3D& camera, int width, int height) {
         ClearBackground(RAYWHITE);
 
         constexpr const Vector3 up = { 0.0f, 1.0f, 0.0f };
         constexpr const Vector3 right = { 1.0f, 0.0f, 0.0f };
 
-        const float pitch = Vector3Angle(up, GetCameraForward(&m_camera));
-        const float yaw = Vector3Angle(right, GetCameraRight(&m_camera));
+        const float pitch = Vector3Angle(up, GetCameraForward(&camera));
+        const float yaw = Vector3Angle(right, GetCameraRight(&camera));
 
         {
             //
@@ -167,7 +408,7 @@ namespace pw {
             const Color b = RAYWHITE; //RAYWHITE
             const Color start_color = colorPallete(yaw_factor, a, b);
             const Color end_color = colorPallete(yaw_factor + color_spacing, a, b);
-            DrawRectangleGradientH(0, 0, GetRenderWidth(), GetRenderHeight(), start_color, end_color);
+            DrawRectangleGradientH(0, 0, width, height, start_color, end_color);
         }
 
         {
@@ -184,125 +425,190 @@ namespace pw {
             if (pitch_factor > dead_zone) {
 
                 float alpha = (pitch_factor - dead_zone) / live_zone;
-                DrawRectangle(0, 0, GetRenderWidth(), GetRenderHeight(), Fade(BROWN, alpha * max_alpha));
+                DrawRectangle(0, 0, width, height, Fade(BROWN, alpha * max_alpha));
 
             }  else if (pitch_factor < -dead_zone) {
 
                 float alpha = (-pitch_factor - dead_zone) / live_zone;
-                DrawRectangle(0, 0, GetRenderWidth(), GetRenderHeight(), Fade(BLUE, alpha * max_alpha));
+                DrawRectangle(0, 0, width, height, Fade(BLUE, alpha * max_alpha));
 
             }
         }
    
     }
 
-    void PinWorld::renderPins() {
-        Material& material = m_pin_material;
-        Mesh& mesh = m_pin_mesh;
-
-        rlUpdateVertexBuffer(mesh.vboId[VBO_PIN], m_pins.data(), int(m_pins.size() * sizeof(float)), 0);
-
-        rlEnableShader(material.shader.id);
+    void PinWorld::update() {
+        {
+            ScopedStageTimer timer(m_profiler, FrameStage::Actions);
 
-        rlSetUniformMatrix(material.shader.locs[SHADER_LOC_MATRIX_VIEW], rlGetMatrixModelview());
-        rlSetUniformMatrix(material.shader.locs[SHADER_LOC_MATRIX_PROJECTION], rlGetMatrixProjection());
+            MenuActions actions = m_menu.takeActions();
 
-        // Try binding vertex array objects (VAO) 
-        rlEnableVertexArray(mesh.vaoId);
+            // the context only changes while no keyframe is evaluated, swaps that show up after this wait for the next frame
+            bool swaps_pending = m_meta_shader_watcher.pending();
+            bool plugins_changed = pluginMetaShadersChanged(m_meta_shader_context);
+            if (swaps_pending || plugins_changed || m_meta_shader_context.loading || !actions.empty())
+                waitKeyframes();
 
-        int instances = m_canvas_width * m_canvas_height;
-        rlDrawVertexArrayElementsInstanced(0, mesh.triangleCount * 3, 0, instances);
+            if (plugins_changed)
+                reloadPluginMetaShaders(m_meta_shader_context);
 
-        rlDisableVertexArray();
+            //
+            // shaders that finished loading or changed on disk
+            //
+            bool shaders_updated = finishMetaShaders(m_meta_shader_context);
 
-        rlDisableShader();
-    }
+            // changes wait for the initial load, they may target kinds that aren't there yet
+            if (!m_meta_shader_context.loading && swaps_pending && m_meta_shader_watcher.apply(m_meta_shader_context))
+                shaders_updated = true;
 
-    void PinWorld::update() {
-        //
-        // dispatch actions
-        //
-        MenuActions actions = m_menu.takeActions();
-        for (auto& action : actions) {
-            if (action.kind == MenuActionKind::ShaderChange) {
-                m_meta_shader_context.shader = action.shader;
-            } else if (action.kind == MenuActionKind::SizeChange) {
-                m_canvas_divisor = action.size;
-                m_pins.clear();
-            } else if (action.kind == MenuActionKind::RestartAnimation) {
-                m_start_time = GetTime();
-            } else if (action.kind == MenuActionKind::ReloadShaders) {
-                setupMetaShaders(m_meta_shader_context);
-                m_menu.setup(m_meta_shader_context);
+            if (shaders_updated) {
+                shareShaders();
+                m_menu.updateShaders(m_canvases[m_focus]->context());
             }
-        }
 
-        computeSizes();
+            //
+            // dispatch actions, to the focused canvas unless they are settings of the world
+            //
+            for (auto& action : actions) {
+                PinCanvas& focus = *m_canvases[m_focus];
+
+                if (action.kind == MenuActionKind::ShaderChange) {
+                    focus.selectShader(action.shader);
+                } else if (action.kind == MenuActionKind::SizeChange) {
+                    focus.setDivisor(action.size);
+                } else if (action.kind == MenuActionKind::RestartAnimation) {
+                    focus.restart(currentTime());
+                } else if (action.kind == MenuActionKind::ReloadShaders) {
+                    for (auto& canvas : m_canvases)
+                        canvas->keyframes().reset();
+                    setupMetaShaders(m_meta_shader_context);
+                    shareShaders();
+                    m_menu.setup(m_meta_shader_context);
+                    m_menu.focusCanvas(focus.context(), focus.divisor());
+                } else if (action.kind == MenuActionKind::ToggleProfiler) {
+                    m_profiler_overlay = !m_profiler_overlay;
+                } else if (action.kind == MenuActionKind::DumpProfiler) {
+                    m_profiler.dump(ProfilerDumpSeconds);
+                } else if (action.kind == MenuActionKind::ToggleAdaptiveResolution) {
+                    m_adaptive_resolution.setEnabled(!m_adaptive_resolution.enabled());
+                    TraceLog(LOG_INFO, "Resolution > adaptive %s", m_adaptive_resolution.enabled() ? "on" : "off");
+                } else if (action.kind == MenuActionKind::ToggleKeyframes) {
+                    bool enabled = !focus.keyframes().enabled();
+                    for (auto& canvas : m_canvases)
+                        canvas->keyframes().setEnabled(enabled);
+                    TraceLog(LOG_INFO, "Keyframes > %s", enabled ? sfmt("on at %.0f Hz", Keyframes::Rate).c_str() : "off");
+                } else if (action.kind == MenuActionKind::ToggleCameraDetail) {
+                    bool enabled = !focus.cameraDetail().enabled();
+                    for (auto& canvas : m_canvases)
+                        canvas->cameraDetail().setEnabled(enabled);
+                    TraceLog(LOG_INFO, "Detail > camera detail %s", enabled ? "on" : "off");
+                } else if (action.kind == MenuActionKind::ToggleTrace) {
+                    if (traceRecording()) traceStop();
+                    else traceStart();
+                } else if (action.kind == MenuActionKind::NextCanvas) {
+                    m_focus = (m_focus + 1) % int(m_canvases.size());
+                    PinCanvas& next = *m_canvases[m_focus];
+                    m_menu.focusCanvas(next.context(), next.divisor());
+                    TraceLog(LOG_INFO, "Canvas > %d of %d, %s", m_focus + 1, int(m_canvases.size()), next.shaderName().c_str());
+                }
+            }
 
-        updateCamera();
+            if (!m_headless)
+                updateCamera();
+        }
 
+        {
+            ScopedStageTimer timer(m_profiler, FrameStage::Sizes);
+            computeSizes();
+        }
 
-        // don't updated pins
-        if (!m_menu.animationRunning())
+        // don't updated pins, the walls keep showing them
+        if (!m_menu.animationRunning()) {
+            for (auto& canvas : m_canvases)
+                canvas->sendPins(m_profiler);
             return;
+        }
 
         //
-        // Run Meta Shader on each pin
+        // The canvases are evaluated in turn and each one spreads its tiles over the shared job system.
+        // Every canvas gets the same share of the shader budget and its pins go out as soon as they are ready,
+        // the first canvas changes every frame so no wall always waits for the others
         //
-        float time = float(GetTime() - m_start_time);
-        updateContextState(m_meta_shader_context, m_canvas_width, m_canvas_height, time);
-        
-        Vector2 pin;
-        for (int y = 0; y != m_canvas_height; ++y) {
-            pin.y = float(y);
-            for (int x = 0; x != m_canvas_width; ++x) {
-                int index = y * m_canvas_width + x;
-                pin.x = float(x);
-                m_pins[index] = clampTo(m_meta_shader_context.shader.function(m_meta_shader_context, index, pin, m_pins[index]), 0.0f, 1.0f);
-            }
+        int count = int(m_canvases.size());
+        PinCanvasFrame frame = { currentTime(), AdaptiveResolution::FrameBudgetMs / float(count), m_headless, m_adaptive_resolution, m_profiler };
+
+        for (int i = 0; i != count; ++i) {
+            int index = (m_first_canvas + i) % count;
+            PinCanvas& canvas = *m_canvases[index];
+            canvas.update(frame);
+            canvas.sendPins(m_profiler);
         }
-    }
 
-    void PinWorld::computeSizes() {
-        m_window_width = float(GetScreenWidth());
-        m_window_height = float(GetScreenHeight());
-
-        //
-        // initialization code
-        //
-        if (m_pins.empty()) {
-            m_canvas_width = CANVAS_WIDTH / m_canvas_divisor;
-            m_canvas_height = CANVAS_HEIGHT / m_canvas_divisor;
-            TraceLog(LOG_DEBUG, "Canvas=%dx%d", m_canvas_width, m_canvas_height);
+        m_first_canvas = (m_first_canvas + 1) % count;
+    }
 
-            int total = m_canvas_width * m_canvas_height;
-            m_pins.resize(total, 0.0f);
+    void PinWorld::shareShaders() {
+        for (size_t i = 0; i != m_canvases.size(); ++i) {
+            PinCanvas& canvas = *m_canvases[i];
+            canvas.shareShaders(m_meta_shader_context);
+
+            // the shader may be of a kind that is still loading
+            std::string& pending = m_pending_shaders[i];
+            if (pending.empty())
+                continue;
+
+            if (canvas.selectShader(pending)) {
+                pending.clear();
+            } else if (!m_meta_shader_context.loading) {
+                TraceLog(LOG_WARNING, "Canvas > shader '%s' not found", pending.c_str());
+                pending.clear();
+            }
+        }
+    }
 
-            float x_start = m_canvas_width * m_pin_size_with_margins / 2.0f;
-            x_start -= m_pin_size_with_margins / 2.0f; // center the first pin
+    void PinWorld::waitKeyframes() {
+        for (auto& canvas : m_canvases)
+            canvas->keyframes().wait();
+    }
 
-            float y_start = m_canvas_height * m_pin_size_with_margins / 2.0f;
-            y_start -= m_pin_size_with_margins / 2.0f; // center the first pin
+    void PinWorld::computeSizes() {
+        if (!m_headless) {
+            m_window_width = float(GetScreenWidth());
+            m_window_height = float(GetScreenHeight());
+
+            // made once and shared by the canvases
+            if (m_pin_material.shader.id == 0) {
+                m_pin_material = loadPinMaterial(PinProgramFile);
+                m_pin_attributes = pinAttributes(m_pin_material);
+            }
+        }
 
-            // Regenerate mesh
-            UnloadMesh(m_pin_mesh);
-            m_pin_mesh = GenMeshCube(m_pin_size, m_pin_height, m_pin_size);
+        // the canvases on a grid that covers the window
+        int count = int(m_canvases.size());
+        int columns = int(std::ceil(std::sqrt(float(count))));
+        int rows = (count + columns - 1) / columns;
+        float cell_width = m_window_width / float(columns);
+        float cell_height = m_window_height / float(rows);
+
+        for (int i = 0; i != count; ++i) {
+            PinCanvas& canvas = *m_canvases[i];
+
+            if (!m_headless) {
+                Rectangle viewport = { 0.0f, 0.0f, m_window_width, m_window_height };
+                if (count > 1) {
+                    viewport = { (i % columns) * cell_width + ViewportMargin, (i / columns) * cell_height + ViewportMargin,
+                        cell_width - 2.0f * ViewportMargin, cell_height - 2.0f * ViewportMargin };
+                }
+                canvas.setViewport(viewport, count > 1);
+            }
 
-            UnloadMaterial(m_pin_material);
-            m_pin_material = loadPinMaterial(
-                m_pin_mesh, m_pins,
-                m_canvas_width, m_canvas_height, 
-                x_start, y_start, 
-                m_pin_size_with_margins
-            );
-
-            float max_dimension = maximum(m_canvas_width, m_canvas_height) * m_pin_size_with_margins;
-            m_camera.position = { 0.0f, max_dimension / 2.0f, max_dimension / 1.5f };  // Camera position
-            m_start_time = GetTime();
+            canvas.computeSizes(currentTime(), m_headless ? nullptr : &m_pin_material);
         }
     }
 
     void PinWorld::updateCamera() {
+        Camera3D& camera = m_canvases[m_focus]->camera();
+
         bool u_k = m_menu.isMoveUpPressed();
         bool d_k = m_menu.isMoveDownPressed();
         bool l_k = m_menu.isMoveLeftPressed();
@@ -314,7 +620,7 @@ namespace pw {
         bool key_pressed = u_k || d_k || l_k || r_k || f_k || b_k || has_mouse_wheel;
 
         if (key_pressed) {
-            //UpdateCamera(&m_camera);
+            //UpdateCamera(&camera);
             //TraceLog(LOG_DEBUG, "Up='%d' Down='%d' Left='%d' Right='%d' Forward='%d' Backward='%d'", u_k, d_k, l_k, r_k, f_k, b_k);
             const float camera_orbit_speed = 0.5f * GetFrameTime(); // degrees per second
             const float camera_move_speed = 0.25f;
@@ -329,10 +635,10 @@ namespace pw {
             if (has_mouse_wheel)
                 move = mouse_wheel * keypad_zoom_speed;
 
-            CameraPitch(&m_camera, pitch, lockView, rotateAroundTarget, false);
-            CameraYaw(&m_camera, yaw, rotateAroundTarget);
+            CameraPitch(&camera, pitch, lockView, rotateAroundTarget, false);
+            CameraYaw(&camera, yaw, rotateAroundTarget);
 
-            CameraMoveToTarget(&m_camera, move);
+            CameraMoveToTarget(&camera, move);
         }
 
     }
@@ -3,11 +3,31 @@
 #include "Lang.hpp"
 #include "Text.hpp"
 #include "MetaShader.hpp"
+#include "MetaShaderWatcher.hpp"
 #include "Menu.hpp"
+#include "FrameProfiler.hpp"
+#include "AdaptiveResolution.hpp"
+#include "PinMaterial.hpp"
+#include "PinCanvas.hpp"
 
 
 namespace pw {
 
+	// offline run without a window, time advances by a fixed step so the output only depends on the options
+	struct HeadlessOptions {
+		int frames = 60;
+		float fps = 60.0f;			// simulated frame rate
+		unsigned int seed = 0;
+		std::string output;			// folder for the dumped frames
+		bool png = false;			// height map png per frame
+		bool raw = false;			// raw float32 pins per frame
+	};
+
+	//
+	// Hosts the canvases of every wall in one process.
+	// The shaders are loaded once and shared by the canvases, each canvas has its own size, shader, clock and sink.
+	// The canvases are drawn side by side in the window, the menu and the camera keys act on the focused one.
+	//
 	class PinWorld {
 	public:
 		PinWorld();
@@ -17,35 +37,50 @@ namespace pw {
 		void run();
 		void step();
 		void shutdown();
+
+		// returns the process exit code
+		int runHeadless(HeadlessOptions const& options);
+
+		// call before setup or runHeadless, without any canvas the world runs a single one with the default options
+		bool addCanvas(PinCanvasOptions const& options);
 	private:
 		float m_window_width;
 		float m_window_height;
 
-		int m_canvas_divisor;
-		int m_canvas_width;
-		int m_canvas_height;
-		float m_pin_size;
-		float m_pin_size_with_margins;
-		float m_pin_height;
-
-		Camera3D m_camera;
 		Menu m_menu;
 
-		std::vector<float> m_pins;
-		Mesh m_pin_mesh;
+		// the pin program is shared by the canvases
 		Material m_pin_material;
+		PinAttributes m_pin_attributes;
+
+		bool m_headless;
+		double m_headless_time;
 
-		double m_start_time;
+		FrameProfiler m_profiler;
+		bool m_profiler_overlay;
 
-		// helpers for internal meta shader
+		// shader costs of every canvas, each canvas picks its own resolution in its share of the frame
+		AdaptiveResolution m_adaptive_resolution;
+
+		// the shaders every canvas shares
 		MetaShaderContext m_meta_shader_context;
+		MetaShaderWatcher m_meta_shader_watcher;
+
+		// declared after the context, the keyframes in flight finish before the shared shaders go away
+		std::vector<std::unique_ptr<PinCanvas>> m_canvases;
+		std::vector<std::string> m_pending_shaders;		// shaders asked for that didn't load yet
+		int m_focus;				// canvas the menu and the camera keys act on
+		int m_first_canvas;			// canvas evaluated first this frame
 
 		void render();
-		void renderBackground();
-		void renderPins();
+		void renderBackground(Camera3D& camera, int width, int height);
 		void update();
 		void computeSizes();
+		void shareShaders();
+		void waitKeyframes();
 		void updateCamera();
+		double currentTime() const;
+		bool dumpPins(HeadlessOptions const& options, int canvas, int frame);
 	};
 
 }
\ No newline at end of file
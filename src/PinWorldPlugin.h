@@ -0,0 +1,62 @@
+#pragma once
+
+//
+// PinWorld native plugin shaders
+//
+// A plugin is a shared library placed in the plugin folder that exports pinworld_plugin().
+// Plugins are reloaded when the library file changes, without restarting PinWorld.
+// This header is plain C so plugins can be built with any compiler.
+//
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#if defined(_WIN32)
+    #define PINWORLD_PLUGIN_EXPORT __declspec(dllexport)
+#else
+    #define PINWORLD_PLUGIN_EXPORT __attribute__((visibility("default")))
+#endif
+
+#define PINWORLD_PLUGIN_VERSION 1
+
+// info that is constant during a frame run
+typedef struct PinWorldFrame {
+    float size_x;           // size of the canvas
+    float size_y;
+    float half_size_x;      // half size of the canvas
+    float half_size_y;
+    float time;             // time in seconds
+} PinWorldFrame;
+
+typedef struct PinWorldShader {
+    const char* name;
+
+    // optional, state is created once when the plugin is loaded and destroyed before it is unloaded.
+    // every canvas shares it and shade may run for several canvases at once, so shaders only read it
+    void* (*create)(void);
+    void (*destroy)(void* state);
+
+    // evaluates one pin, returns its height in [0.0, 1.0]
+    float (*shade)(void* state, const PinWorldFrame* frame, int pin_index, float pin_x, float pin_y, float pin_value);
+
+    // optional, evaluates the pins [x_begin, x_end) of row y, row[x] holds the previous value of pin x
+    void (*shade_row)(void* state, const PinWorldFrame* frame, int y, int x_begin, int x_end, float* row);
+} PinWorldShader;
+
+typedef struct PinWorldPlugin {
+    uint32_t version;       // PINWORLD_PLUGIN_VERSION
+    uint32_t shader_count;
+    const PinWorldShader* shaders;
+} PinWorldPlugin;
+
+typedef const PinWorldPlugin* (*PinWorldPluginEntry)(void);
+
+// every plugin exports this symbol
+#define PINWORLD_PLUGIN_ENTRY "pinworld_plugin"
+
+#ifdef __cplusplus
+}
+#endif
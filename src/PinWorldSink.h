@@ -0,0 +1,62 @@
+#pragma once
+
+//
+// PinWorld pin frames over UDP
+//
+// PinWorld sends every frame of pins to the address given with --sink, for the controllers of a physical pin wall.
+// Every datagram holds a range of whole rows and fits a 1500 bytes ethernet MTU:
+//   - keyframes hold every row, they are sent every PINWORLD_SINK_KEYFRAME_INTERVAL frames and when the canvas changes
+//   - the frames in between only hold the rows that changed since the frame before
+//   - the last datagram of a frame has PINWORLD_SINK_END_OF_FRAME, a frame without changes is a single empty datagram
+// The packet sequence has no gaps on the sender side, a receiver that sees one lost rows and waits for the next keyframe.
+//
+// This header is plain C so receivers can be built with any compiler.
+// Every field is little endian.
+//
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define PINWORLD_SINK_MAGIC 0x4b4e4950u      // PINK
+#define PINWORLD_SINK_VERSION 1
+#define PINWORLD_SINK_DEFAULT_PORT 7777
+
+// UDP payload that fits a 1500 bytes MTU without fragmenting, after the IPv4 and UDP headers
+#define PINWORLD_SINK_MAX_DATAGRAM 1472
+
+// frames between two keyframes
+#define PINWORLD_SINK_KEYFRAME_INTERVAL 60
+
+// flags
+#define PINWORLD_SINK_KEYFRAME 0x1
+#define PINWORLD_SINK_END_OF_FRAME 0x2
+
+// pin formats
+#define PINWORLD_SINK_UINT8 1              // height 0.0 to 1.0 as 0 to 255
+
+typedef struct PinWorldSinkPacket {
+    uint32_t magic;             // PINWORLD_SINK_MAGIC
+    uint16_t version;           // PINWORLD_SINK_VERSION
+    uint16_t flags;
+    uint32_t packet;            // datagrams sent before this one
+    uint32_t frame;             // frames sent before this one
+    uint16_t width;             // canvas pins
+    uint16_t height;
+    uint16_t row_begin;         // first row in the datagram
+    uint16_t row_count;         // rows that follow the header, width pins each
+    uint8_t format;
+    uint8_t reserved[7];
+} PinWorldSinkPacket;
+
+// rows that fit in a datagram, every datagram holds at least one row
+static inline int pinworld_sink_rows_per_packet(int width, int pin_size) {
+    int rows = (PINWORLD_SINK_MAX_DATAGRAM - (int)sizeof(PinWorldSinkPacket)) / (width * pin_size);
+    return rows > 0 ? rows : 1;
+}
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,211 @@
+#pragma once
+
+//
+// PinWorld pin streams
+//
+// Another process writes pin frames into a POSIX shared memory object and the Stream shader shows the newest one.
+// The object holds a header and a ring of slots, one frame per slot. There is a single producer and a single consumer:
+//   - the producer writes a frame into a slot that is neither the newest frame nor the one the consumer holds,
+//     then publishes it in latest
+//   - the consumer claims the newest frame in reading and reads it in place until it claims the next one
+// With 3 slots or more the producer always finds a free slot and neither side ever waits for the other.
+//
+// This header is plain C so producers can be built with any compiler, the producer functions are POSIX only.
+// A producer is a few lines:
+//
+//     PinWorldStream stream;
+//     pinworld_stream_create(&stream, "/pinworld", 320, 240, PINWORLD_STREAM_UINT8, 3);
+//     for (;;) {
+//         uint8_t* pins = (uint8_t*)pinworld_stream_begin(&stream);
+//         ... write width * height pins, row after row ...
+//         pinworld_stream_commit(&stream);
+//     }
+//     pinworld_stream_destroy(&stream);
+//
+
+#include <stdint.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define PINWORLD_STREAM_MAGIC 0x4d525453u     // STRM
+#define PINWORLD_STREAM_VERSION 1
+#define PINWORLD_STREAM_MIN_SLOTS 3
+#define PINWORLD_STREAM_MAX_SLOTS 255
+
+// shared memory object the Stream shader attaches to, unless PINWORLD_STREAM names another one
+#define PINWORLD_STREAM_DEFAULT_NAME "/pinworld"
+
+// pin formats, every format maps to heights in [0.0, 1.0]
+typedef enum PinWorldStreamFormat {
+    PINWORLD_STREAM_FLOAT32 = 0,     // 0.0 to 1.0
+    PINWORLD_STREAM_UINT8 = 1,      // 0 to 255
+    PINWORLD_STREAM_UINT16 = 2      // 0 to 65535
+} PinWorldStreamFormat;
+
+// start of the shared memory object, the slots follow at data_offset
+typedef struct PinWorldStreamHeader {
+    uint32_t magic;             // PINWORLD_STREAM_MAGIC once the header is complete
+    uint32_t version;           // PINWORLD_STREAM_VERSION
+    uint32_t width;             // pins
+    uint32_t height;
+    uint32_t format;            // PinWorldStreamFormat
+    uint32_t slot_count;
+    uint64_t slot_size;         // bytes between two slots, a multiple of 64
+    uint64_t data_offset;       // bytes from the header to the first slot
+    uint64_t reserved[3];
+
+    // written by the producer on its own cache line, frame sequence << 8 | slot, 0 before the first frame
+    uint64_t latest;
+    uint64_t producer_padding[7];
+
+    // written by the consumer on its own cache line, slot + 1 of the frame it reads, 0 for none
+    uint64_t reading;
+    uint64_t consumer_padding[7];
+} PinWorldStreamHeader;
+
+static inline uint64_t pinworld_stream_sequence(uint64_t latest) { return latest >> 8; }
+static inline uint32_t pinworld_stream_slot(uint64_t latest) { return (uint32_t)(latest & 0xff); }
+
+static inline size_t pinworld_stream_pin_size(uint32_t format) {
+    return format == PINWORLD_STREAM_UINT8 ? 1 : (format == PINWORLD_STREAM_UINT16 ? 2 : 4);
+}
+
+static inline uint64_t pinworld_stream_data_offset(void) {
+    return (sizeof(PinWorldStreamHeader) + 63) & ~(uint64_t)63;
+}
+
+static inline uint64_t pinworld_stream_slot_size(uint32_t width, uint32_t height, uint32_t format) {
+    return ((uint64_t)width * height * pinworld_stream_pin_size(format) + 63) & ~(uint64_t)63;
+}
+
+static inline void* pinworld_stream_slot_data(PinWorldStreamHeader* header, uint32_t slot) {
+    return (uint8_t*)header + header->data_offset + slot * header->slot_size;
+}
+
+//
+// Consumer side
+// claims the newest frame, returns its latest value or 0 when there is none.
+// the frame stays valid until the next claim or release
+//
+static inline uint64_t pinworld_stream_claim(PinWorldStreamHeader* header) {
+    // only fails when the producer publishes several frames while the claim is checked
+    for (int attempt = 0; attempt != 64; ++attempt) {
+        uint64_t latest = __atomic_load_n(&header->latest, __ATOMIC_ACQUIRE);
+        if (latest == 0)
+            break;
+
+        __atomic_store_n(&header->reading, (uint64_t)pinworld_stream_slot(latest) + 1, __ATOMIC_SEQ_CST);
+        if (__atomic_load_n(&header->latest, __ATOMIC_SEQ_CST) == latest)
+            return latest;
+    }
+
+    __atomic_store_n(&header->reading, 0, __ATOMIC_SEQ_CST);
+    return 0;
+}
+
+static inline void pinworld_stream_release(PinWorldStreamHeader* header) {
+    __atomic_store_n(&header->reading, 0, __ATOMIC_SEQ_CST);
+}
+
+#if !defined(_WIN32)
+
+#include <fcntl.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+//
+// Producer side
+//
+typedef struct PinWorldStream {
+    PinWorldStreamHeader* header;
+    size_t size;
+    uint64_t sequence;          // frames committed
+    uint32_t slot;              // slot of the frame being written
+    char name[64];
+} PinWorldStream;
+
+// creates or replaces the named shared memory object, returns 0 on success
+static inline int pinworld_stream_create(PinWorldStream* stream, const char* name, uint32_t width, uint32_t height, uint32_t format, uint32_t slot_count) {
+    memset(stream, 0, sizeof(*stream));
+    if (width == 0 || height == 0 || slot_count < PINWORLD_STREAM_MIN_SLOTS || slot_count > PINWORLD_STREAM_MAX_SLOTS || strlen(name) >= sizeof(stream->name))
+        return -1;
+
+    // a consumer still attached to an older object notices it was unlinked and attaches to the new one
+    shm_unlink(name);
+    int fd = shm_open(name, O_CREAT | O_EXCL | O_RDWR, 0666);
+    if (fd < 0)
+        return -1;
+
+    uint64_t slot_size = pinworld_stream_slot_size(width, height, format);
+    size_t size = (size_t)(pinworld_stream_data_offset() + slot_size * slot_count);
+    void* memory = MAP_FAILED;
+    if (ftruncate(fd, (off_t)size) == 0)
+        memory = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+
+    if (memory == MAP_FAILED) {
+        shm_unlink(name);
+        return -1;
+    }
+
+    PinWorldStreamHeader* header = (PinWorldStreamHeader*)memory;
+    header->version = PINWORLD_STREAM_VERSION;
+    header->width = width;
+    header->height = height;
+    header->format = format;
+    header->slot_count = slot_count;
+    header->slot_size = slot_size;
+    header->data_offset = pinworld_stream_data_offset();
+    __atomic_store_n(&header->magic, PINWORLD_STREAM_MAGIC, __ATOMIC_RELEASE);
+
+    stream->header = header;
+    stream->size = size;
+    strcpy(stream->name, name);
+    return 0;
+}
+
+// the slot to write the next frame into, width * height pins row after row
+static inline void* pinworld_stream_begin(PinWorldStream* stream) {
+    PinWorldStreamHeader* header = stream->header;
+    uint64_t latest = __atomic_load_n(&header->latest, __ATOMIC_RELAXED);
+    uint64_t reading = __atomic_load_n(&header->reading, __ATOMIC_SEQ_CST);
+
+    // the next slot around the ring that isn't the newest frame or the one being read
+    for (uint32_t i = 1; i <= header->slot_count; ++i) {
+        uint32_t slot = (stream->slot + i) % header->slot_count;
+        if (latest != 0 && slot == pinworld_stream_slot(latest))
+            continue;
+        if (slot + 1 == reading)
+            continue;
+
+        stream->slot = slot;
+        break;
+    }
+
+    return pinworld_stream_slot_data(header, stream->slot);
+}
+
+// publishes the frame written since pinworld_stream_begin
+static inline void pinworld_stream_commit(PinWorldStream* stream) {
+    stream->sequence++;
+    __atomic_store_n(&stream->header->latest, (stream->sequence << 8) | stream->slot, __ATOMIC_SEQ_CST);
+}
+
+static inline void pinworld_stream_destroy(PinWorldStream* stream) {
+    if (stream->header) {
+        munmap(stream->header, stream->size);
+        shm_unlink(stream->name);
+    }
+    memset(stream, 0, sizeof(*stream));
+}
+
+#endif
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,189 @@
+#include "ProgramCache.hpp"
+
+#include "raylib.h"
+#include "rlgl.h"
+
+// program binaries need GL 4.1 or ARB_get_program_binary, rlgl doesn't expose them
+#if !defined(PLATFORM_WEB) && !defined(GRAPHICS_API_OPENGL_ES2)
+#define PW_PROGRAM_BINARY
+#endif
+
+#if defined(PW_PROGRAM_BINARY)
+
+#if defined(_WIN32)
+#define PW_GL_API __stdcall
+#else
+#define PW_GL_API
+#endif
+
+// raylib is linked with glfw on desktop
+extern "C" void (*glfwGetProcAddress(const char* procname))(void);
+
+namespace {
+    constexpr unsigned int GL_VENDOR = 0x1F00;
+    constexpr unsigned int GL_RENDERER = 0x1F01;
+    constexpr unsigned int GL_VERSION = 0x1F02;
+    constexpr unsigned int GL_LINK_STATUS = 0x8B82;
+    constexpr unsigned int GL_PROGRAM_BINARY_LENGTH = 0x8741;
+    constexpr unsigned int GL_NUM_PROGRAM_BINARY_FORMATS = 0x87FE;
+
+    typedef const unsigned char* (PW_GL_API *GetStringProc)(unsigned int name);
+    typedef void (PW_GL_API *GetIntegervProc)(unsigned int name, int* data);
+    typedef unsigned int (PW_GL_API *CreateProgramProc)(void);
+    typedef void (PW_GL_API *DeleteProgramProc)(unsigned int program);
+    typedef void (PW_GL_API *GetProgramivProc)(unsigned int program, unsigned int name, int* params);
+    typedef void (PW_GL_API *GetProgramBinaryProc)(unsigned int program, int size, int* length, unsigned int* format, void* binary);
+    typedef void (PW_GL_API *ProgramBinaryProc)(unsigned int program, unsigned int format, const void* binary, int length);
+
+    struct ProgramBinaryApi {
+        GetStringProc getString = nullptr;
+        GetIntegervProc getIntegerv = nullptr;
+        CreateProgramProc createProgram = nullptr;
+        DeleteProgramProc deleteProgram = nullptr;
+        GetProgramivProc getProgramiv = nullptr;
+        GetProgramBinaryProc getProgramBinary = nullptr;
+        ProgramBinaryProc programBinary = nullptr;
+    };
+
+    // start of the cache file, the binary follows
+    struct ProgramCacheHeader {
+        uint32_t magic;
+        uint32_t format;
+        uint64_t key;           // sources and driver the binary was built from
+        uint32_t length;
+        uint32_t reserved;
+    };
+
+    constexpr uint32_t ProgramCacheMagic = 0x31424750; // PGB1
+
+    // false when the driver has no program binary formats
+    bool loadApi(ProgramBinaryApi& api) {
+        api.getString = (GetStringProc)glfwGetProcAddress("glGetString");
+        api.getIntegerv = (GetIntegervProc)glfwGetProcAddress("glGetIntegerv");
+        api.createProgram = (CreateProgramProc)glfwGetProcAddress("glCreateProgram");
+        api.deleteProgram = (DeleteProgramProc)glfwGetProcAddress("glDeleteProgram");
+        api.getProgramiv = (GetProgramivProc)glfwGetProcAddress("glGetProgramiv");
+        api.getProgramBinary = (GetProgramBinaryProc)glfwGetProcAddress("glGetProgramBinary");
+        api.programBinary = (ProgramBinaryProc)glfwGetProcAddress("glProgramBinary");
+
+        if (!api.getString || !api.getIntegerv || !api.createProgram || !api.deleteProgram || !api.getProgramiv || !api.getProgramBinary || !api.programBinary)
+            return false;
+
+        int formats = 0;
+        api.getIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formats);
+        return formats > 0;
+    }
+
+    // fnv-1a
+    uint64_t hashText(uint64_t hash, const char* text) {
+        for (; text && *text; ++text) {
+            hash ^= uint8_t(*text);
+            hash *= 0x100000001b3ull;
+        }
+        return hash;
+    }
+
+    uint64_t programKey(ProgramBinaryApi const& api, std::string const& vs, std::string const& ps) {
+        uint64_t key = 0xcbf29ce484222325ull;
+        key = hashText(key, vs.c_str());
+        key = hashText(key, ps.c_str());
+        key = hashText(key, (const char*)api.getString(GL_VENDOR));
+        key = hashText(key, (const char*)api.getString(GL_RENDERER));
+        key = hashText(key, (const char*)api.getString(GL_VERSION));
+        return key;
+    }
+
+    // the program in the cache file, 0 when it is missing, stale or rejected by the driver
+    unsigned int loadProgram(ProgramBinaryApi const& api, uint64_t key, std::string const& filepath) {
+        std::vector<uint8_t> buffer;
+        if (!pw::readRawBinary(filepath, buffer) || buffer.size() < sizeof(ProgramCacheHeader))
+            return 0;
+
+        ProgramCacheHeader header;
+        memcpy(&header, buffer.data(), sizeof(header));
+        if (header.magic != ProgramCacheMagic || header.key != key || header.length != buffer.size() - sizeof(header))
+            return 0;
+
+        unsigned int program = api.createProgram();
+        api.programBinary(program, header.format, buffer.data() + sizeof(header), int(header.length));
+
+        int linked = 0;
+        api.getProgramiv(program, GL_LINK_STATUS, &linked);
+        if (!linked) {
+            api.deleteProgram(program);
+            return 0;
+        }
+
+        return program;
+    }
+
+    void saveProgram(ProgramBinaryApi const& api, unsigned int program, uint64_t key, std::string const& filepath) {
+        int length = 0;
+        api.getProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+        if (length <= 0)
+            return;
+
+        std::vector<uint8_t> buffer(sizeof(ProgramCacheHeader) + size_t(length));
+        ProgramCacheHeader header = { ProgramCacheMagic, 0, key, uint32_t(length), 0 };
+        api.getProgramBinary(program, length, &length, &header.format, buffer.data() + sizeof(header));
+        memcpy(buffer.data(), &header, sizeof(header));
+
+        if (!pw::writeRawBinary(filepath, buffer))
+            TraceLog(LOG_WARNING, "PROGRAM: [%s] Failed to save the program binary", filepath.c_str());
+    }
+
+    // the locations LoadShaderFromMemory looks up, the attributes keep the bindings they were linked with
+    Shader shaderFromProgram(unsigned int program) {
+        Shader shader{};
+        shader.id = program;
+        shader.locs = (int*)calloc(RL_MAX_SHADER_LOCATIONS, sizeof(int));
+        for (int i = 0; i != RL_MAX_SHADER_LOCATIONS; ++i)
+            shader.locs[i] = -1;
+
+        shader.locs[SHADER_LOC_VERTEX_POSITION] = rlGetLocationAttrib(program, RL_DEFAULT_SHADER_ATTRIB_NAME_POSITION);
+        shader.locs[SHADER_LOC_VERTEX_TEXCOORD01] = rlGetLocationAttrib(program, RL_DEFAULT_SHADER_ATTRIB_NAME_TEXCOORD);
+        shader.locs[SHADER_LOC_VERTEX_TEXCOORD02] = rlGetLocationAttrib(program, RL_DEFAULT_SHADER_ATTRIB_NAME_TEXCOORD2);
+        shader.locs[SHADER_LOC_VERTEX_NORMAL] = rlGetLocationAttrib(program, RL_DEFAULT_SHADER_ATTRIB_NAME_NORMAL);
+        shader.locs[SHADER_LOC_VERTEX_TANGENT] = rlGetLocationAttrib(program, RL_DEFAULT_SHADER_ATTRIB_NAME_TANGENT);
+        shader.locs[SHADER_LOC_VERTEX_COLOR] = rlGetLocationAttrib(program, RL_DEFAULT_SHADER_ATTRIB_NAME_COLOR);
+
+        shader.locs[SHADER_LOC_MATRIX_MVP] = rlGetLocationUniform(program, RL_DEFAULT_SHADER_UNIFORM_NAME_MVP);
+        shader.locs[SHADER_LOC_MATRIX_VIEW] = rlGetLocationUniform(program, RL_DEFAULT_SHADER_UNIFORM_NAME_VIEW);
+        shader.locs[SHADER_LOC_MATRIX_PROJECTION] = rlGetLocationUniform(program, RL_DEFAULT_SHADER_UNIFORM_NAME_PROJECTION);
+        shader.locs[SHADER_LOC_MATRIX_MODEL] = rlGetLocationUniform(program, RL_DEFAULT_SHADER_UNIFORM_NAME_MODEL);
+        shader.locs[SHADER_LOC_MATRIX_NORMAL] = rlGetLocationUniform(program, RL_DEFAULT_SHADER_UNIFORM_NAME_NORMAL);
+        shader.locs[SHADER_LOC_COLOR_DIFFUSE] = rlGetLocationUniform(program, RL_DEFAULT_SHADER_UNIFORM_NAME_COLOR);
+        shader.locs[SHADER_LOC_MAP_DIFFUSE] = rlGetLocationUniform(program, RL_DEFAULT_SHADER_SAMPLER2D_NAME_TEXTURE0);
+        shader.locs[SHADER_LOC_MAP_SPECULAR] = rlGetLocationUniform(program, RL_DEFAULT_SHADER_SAMPLER2D_NAME_TEXTURE1);
+        shader.locs[SHADER_LOC_MAP_NORMAL] = rlGetLocationUniform(program, RL_DEFAULT_SHADER_SAMPLER2D_NAME_TEXTURE2);
+
+        return shader;
+    }
+}
+
+#endif
+
+namespace pw {
+
+    Shader loadCachedShader(std::string const& vs, std::string const& ps, std::string const& filepath) {
+#if defined(PW_PROGRAM_BINARY)
+        ProgramBinaryApi api;
+        if (!loadApi(api))
+            return LoadShaderFromMemory(vs.c_str(), ps.c_str());
+
+        uint64_t key = programKey(api, vs, ps);
+        if (unsigned int program = loadProgram(api, key, filepath)) {
+            TraceLog(LOG_INFO, "PROGRAM: [%s] Program loaded from its binary", filepath.c_str());
+            return shaderFromProgram(program);
+        }
+
+        Shader shader = LoadShaderFromMemory(vs.c_str(), ps.c_str());
+        if (shader.id != rlGetShaderIdDefault())
+            saveProgram(api, shader.id, key, filepath);
+        return shader;
+#else
+        return LoadShaderFromMemory(vs.c_str(), ps.c_str());
+#endif
+    }
+
+}
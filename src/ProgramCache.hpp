@@ -0,0 +1,17 @@
+#pragma once
+
+#include "Lang.hpp"
+
+#include "raylib.h"
+
+namespace pw {
+
+    //
+    // Linked GL programs kept on disk between sessions.
+    // The first run compiles the program and saves the driver binary, the next runs load the binary instead of compiling.
+    // The binary is only used by the same driver and sources that produced it, and it falls back to compiling
+    // where program binaries aren't supported (web, ES, drivers without binary formats).
+    //
+    Shader loadCachedShader(std::string const& vs, std::string const& ps, std::string const& filepath);
+
+}
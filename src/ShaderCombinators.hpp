@@ -0,0 +1,226 @@
+#pragma once
+
+#include "Lang.hpp"
+
+#include "raylib.h"
+
+namespace pw {
+
+    //
+    // Shader combinators
+    // Small constexpr pieces that nest into a single type, the compiler inlines the whole tree into the pin loop
+    // so a composition runs like a hand-written shader without the normalize/smoothstep/scale boilerplate.
+    //
+    //   // a ring of radius 0.7 pulsing around 0.5, the Circle shader
+    //   constexpr auto PulsingRing = Remap{ Animate{ Smoothstep{ Abs{ Circle{ Centered{}, 0.7f } }, 0.3f, 0.0f }, Sine{ 1.0f } }, 0.5f, 1.0f };
+    //
+    // Coordinates turn a pin position into a Vector2, the other pieces return a float.
+    // Every piece is called with the pin position and the frame state.
+    //
+    namespace combinators {
+
+        // state that is constant during a frame
+        struct Frame {
+            Vector2 size;           // canvas size
+            Vector2 half_size;
+            float time;             // seconds
+        };
+
+        //
+        // Coordinates
+        //
+
+        // the pin position in pins
+        struct Pins {
+            constexpr Vector2 operator()(Vector2 const& pin, Frame const&) const { return pin; }
+        };
+
+        // [-1.0, 1.0] on both axes
+        struct Normalized {
+            constexpr Vector2 operator()(Vector2 const& pin, Frame const& frame) const {
+                return { pin.x / frame.size.x * 2.0f - 1.0f, pin.y / frame.size.y * 2.0f - 1.0f };
+            }
+        };
+
+        // [-1.0, 1.0] vertically from the canvas center, the horizontal axis keeps the same scale
+        struct Centered {
+            constexpr Vector2 operator()(Vector2 const& pin, Frame const& frame) const {
+                float scale = 1.0f / frame.half_size.y;
+                return { (pin.x - frame.half_size.x) * scale, (pin.y - frame.half_size.y) * scale };
+            }
+        };
+
+        template<typename C> struct Scale {
+            C coordinates;
+            Vector2 factor;
+
+            constexpr Vector2 operator()(Vector2 const& pin, Frame const& frame) const {
+                Vector2 p = coordinates(pin, frame);
+                return { p.x * factor.x, p.y * factor.y };
+            }
+        };
+        template<typename C> Scale(C, Vector2) -> Scale<C>;
+
+        template<typename C> struct Translate {
+            C coordinates;
+            Vector2 offset;
+
+            constexpr Vector2 operator()(Vector2 const& pin, Frame const& frame) const {
+                Vector2 p = coordinates(pin, frame);
+                return { p.x + offset.x, p.y + offset.y };
+            }
+        };
+        template<typename C> Translate(C, Vector2) -> Translate<C>;
+
+        // moves by velocity units per second
+        template<typename C> struct Scroll {
+            C coordinates;
+            Vector2 velocity;
+
+            constexpr Vector2 operator()(Vector2 const& pin, Frame const& frame) const {
+                Vector2 p = coordinates(pin, frame);
+                return { p.x + velocity.x * frame.time, p.y + velocity.y * frame.time };
+            }
+        };
+        template<typename C> Scroll(C, Vector2) -> Scroll<C>;
+
+        // tiles the space in cells of period size, each cell is centered on its own origin
+        template<typename C> struct Repeat {
+            C coordinates;
+            Vector2 period;
+
+            constexpr Vector2 operator()(Vector2 const& pin, Frame const& frame) const {
+                Vector2 p = coordinates(pin, frame);
+                return { p.x - period.x * std::floor(p.x / period.x + 0.5f), p.y - period.y * std::floor(p.y / period.y + 0.5f) };
+            }
+        };
+        template<typename C> Repeat(C, Vector2) -> Repeat<C>;
+
+        //
+        // Signed distances, negative inside
+        //
+        template<typename C> struct Circle {
+            C coordinates;
+            float radius;
+
+            constexpr float operator()(Vector2 const& pin, Frame const& frame) const {
+                Vector2 p = coordinates(pin, frame);
+                return std::sqrt(p.x * p.x + p.y * p.y) - radius;
+            }
+        };
+        template<typename C> Circle(C, float) -> Circle<C>;
+
+        template<typename C> struct Box {
+            C coordinates;
+            Vector2 half_size;
+
+            constexpr float operator()(Vector2 const& pin, Frame const& frame) const {
+                Vector2 p = coordinates(pin, frame);
+                float dx = absolute(p.x) - half_size.x;
+                float dy = absolute(p.y) - half_size.y;
+                float ox = maximum(dx, 0.0f);
+                float oy = maximum(dy, 0.0f);
+                return std::sqrt(ox * ox + oy * oy) + minimum(maximum(dx, dy), 0.0f);
+            }
+        };
+        template<typename C> Box(C, Vector2) -> Box<C>;
+
+        // line through the origin, normal is unit length
+        template<typename C> struct Line {
+            C coordinates;
+            Vector2 normal;
+
+            constexpr float operator()(Vector2 const& pin, Frame const& frame) const {
+                Vector2 p = coordinates(pin, frame);
+                return p.x * normal.x + p.y * normal.y;
+            }
+        };
+        template<typename C> Line(C, Vector2) -> Line<C>;
+
+        //
+        // Values
+        //
+
+        // distance to the edge of a shape, on both sides
+        template<typename F> struct Abs {
+            F field;
+
+            constexpr float operator()(Vector2 const& pin, Frame const& frame) const { return absolute(field(pin, frame)); }
+        };
+        template<typename F> Abs(F) -> Abs<F>;
+
+        template<typename F> struct Smoothstep {
+            F field;
+            float edge0;
+            float edge1;
+
+            constexpr float operator()(Vector2 const& pin, Frame const& frame) const { return smoothstep(edge0, edge1, field(pin, frame)); }
+        };
+        template<typename F> Smoothstep(F, float, float) -> Smoothstep<F>;
+
+        // [0.0, 1.0] to [low, high]
+        template<typename F> struct Remap {
+            F field;
+            float low;
+            float high;
+
+            constexpr float operator()(Vector2 const& pin, Frame const& frame) const { return low + field(pin, frame) * (high - low); }
+        };
+        template<typename F> Remap(F, float, float) -> Remap<F>;
+
+        template<typename A, typename B> struct Add {
+            A a;
+            B b;
+
+            constexpr float operator()(Vector2 const& pin, Frame const& frame) const { return a(pin, frame) + b(pin, frame); }
+        };
+        template<typename A, typename B> Add(A, B) -> Add<A, B>;
+
+        template<typename A, typename B> struct Max {
+            A a;
+            B b;
+
+            constexpr float operator()(Vector2 const& pin, Frame const& frame) const { return maximum(a(pin, frame), b(pin, frame)); }
+        };
+        template<typename A, typename B> Max(A, B) -> Max<A, B>;
+
+        //
+        // Animation, a motion is a gain that only depends on the time
+        //
+
+        // [-1.0, 1.0]
+        struct Sine {
+            float speed;
+
+            float operator()(float time) const { return fastSin(time * speed); }
+        };
+
+        // [0.0, 1.0) ramps
+        struct Saw {
+            float speed;
+
+            float operator()(float time) const { return fract(time * speed); }
+        };
+
+        template<typename F, typename M> struct Animate {
+            F field;
+            M motion;
+
+            constexpr float operator()(Vector2 const& pin, Frame const& frame) const { return field(pin, frame) * motion(frame.time); }
+        };
+        template<typename F, typename M> Animate(F, M) -> Animate<F, M>;
+
+        //
+        // Evaluation
+        //
+
+        // the pins [x_begin, x_end) of row y, the whole composition is inlined in the loop
+        template<typename S> inline void evaluateRow(S const& shader, Frame const& frame, int y, int x_begin, int x_end, float* row) {
+            Vector2 pin = { 0.0f, float(y) };
+            for (int x = x_begin; x != x_end; ++x) {
+                pin.x = float(x);
+                row[x] = shader(pin, frame);
+            }
+        }
+    }
+}
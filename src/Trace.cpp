@@ -0,0 +1,163 @@
+#include "Trace.hpp"
+#include "Text.hpp"
+
+#include "raylib.h"
+
+#if defined(PINWORLD_TRACE)
+	#include <atomic>
+	#include <mutex>
+	#include <cstring>
+#endif
+
+namespace pw {
+
+#if defined(PINWORLD_TRACE)
+
+	struct TraceEvent {
+		char name[32];
+		int64_t start;			// microseconds
+		int64_t duration;
+	};
+
+	// written by its thread, only locked against the writer of the trace file
+	struct TraceBuffer {
+		std::mutex mutex;
+		int tid = 0;
+		std::string name;
+		std::vector<TraceEvent> events;
+	};
+
+	static std::atomic<bool> s_recording(false);
+	static std::atomic<int> s_frames_left(0);
+
+	static std::mutex s_buffers_mutex;
+	static std::vector<std::shared_ptr<TraceBuffer>> s_buffers;
+
+	// zone and thread names come from shader and file names, they may have quotes, backslashes or control characters
+	static std::string escapeJson(const char* text) {
+		std::string escaped;
+		for (const char* c = text; *c; ++c) {
+			if (*c == '"' || *c == '\\') {
+				escaped += '\\';
+				escaped += *c;
+			} else if ((unsigned char)*c < 0x20) {
+				escaped += sfmt("\\u%04x", int(*c));
+			} else {
+				escaped += *c;
+			}
+		}
+		return escaped;
+	}
+
+	static TraceBuffer& threadBuffer() {
+		thread_local std::shared_ptr<TraceBuffer> buffer;
+		if (!buffer) {
+			buffer = std::make_shared<TraceBuffer>();
+
+			std::lock_guard<std::mutex> lock(s_buffers_mutex);
+			buffer->tid = int(s_buffers.size()) + 1;
+			s_buffers.push_back(buffer);
+		}
+		return *buffer;
+	}
+
+	void traceStart(int frames) {
+		{
+			std::lock_guard<std::mutex> lock(s_buffers_mutex);
+			for (auto& buffer : s_buffers) {
+				std::lock_guard<std::mutex> buffer_lock(buffer->mutex);
+				buffer->events.clear();
+			}
+		}
+
+		s_frames_left = frames;
+		s_recording = true;
+
+		if (frames > 0) TraceLog(LOG_INFO, "Trace > recording %d frames", frames);
+		else TraceLog(LOG_INFO, "Trace > recording");
+	}
+
+	void traceStop() {
+		if (!s_recording.exchange(false))
+			return;
+
+		std::string json = "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [\n";
+		bool first = true;
+		int count = 0;
+
+		std::lock_guard<std::mutex> lock(s_buffers_mutex);
+		for (auto& buffer : s_buffers) {
+			std::lock_guard<std::mutex> buffer_lock(buffer->mutex);
+
+			if (!buffer->name.empty()) {
+				json += sfmt("%s{\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": 1, \"tid\": %d, \"args\": {\"name\": \"%s\"}}",
+					first ? "" : ",\n", buffer->tid, escapeJson(buffer->name.c_str()));
+				first = false;
+			}
+
+			for (auto const& event : buffer->events) {
+				json += sfmt("%s{\"name\": \"%s\", \"ph\": \"X\", \"pid\": 1, \"tid\": %d, \"ts\": %lld, \"dur\": %lld}",
+					first ? "" : ",\n", escapeJson(event.name), buffer->tid, (long long)event.start, (long long)event.duration);
+				first = false;
+			}
+
+			count += int(buffer->events.size());
+			buffer->events.clear();
+		}
+		json += "\n]}\n";
+
+		std::string filename = "pinworld_trace_" + datetimeMarker() + ".json";
+		if (writeRawText(filename, json))
+			TraceLog(LOG_INFO, "Trace > %d zones written to %s", count, filename.c_str());
+		else
+			TraceLog(LOG_ERROR, "Trace > unable to write %s", filename.c_str());
+	}
+
+	bool traceRecording() {
+		return s_recording;
+	}
+
+	void traceFrame() {
+		if (s_recording && s_frames_left > 0 && --s_frames_left == 0)
+			traceStop();
+	}
+
+	void traceThreadName(std::string const& name) {
+		TraceBuffer& buffer = threadBuffer();
+		std::lock_guard<std::mutex> lock(buffer.mutex);
+		buffer.name = name;
+	}
+
+	TraceZone::TraceZone(const char* name)
+		:m_name(name), m_start(s_recording.load(std::memory_order_relaxed) ? getCurrentMicroseconds() : -1)
+	{ }
+
+	TraceZone::~TraceZone() {
+		if (m_start < 0 || !s_recording.load(std::memory_order_relaxed))
+			return;
+
+		TraceEvent event;
+		strncpy(event.name, m_name, sizeof(event.name) - 1);
+		event.name[sizeof(event.name) - 1] = 0;
+		event.start = m_start;
+		event.duration = getCurrentMicroseconds() - m_start;
+
+		TraceBuffer& buffer = threadBuffer();
+		std::lock_guard<std::mutex> lock(buffer.mutex);
+		buffer.events.push_back(event);
+	}
+
+#else
+
+	void traceStart(int) {
+		TraceLog(LOG_WARNING, "Trace > not available, build with PINWORLD_TRACE enabled");
+	}
+
+	void traceStop() { }
+	bool traceRecording() { return false; }
+	void traceFrame() { }
+	void traceThreadName(std::string const&) { }
+
+#endif
+
+}
@@ -0,0 +1,46 @@
+#pragma once
+
+#include "Lang.hpp"
+
+//
+// Zones recorded per thread and written as chrome trace event json, open it in chrome://tracing or ui.perfetto.dev.
+// Zones are compiled out unless PINWORLD_TRACE is defined.
+//
+#define PW_TRACE_CONCAT_(a, b) a##b
+#define PW_TRACE_CONCAT(a, b) PW_TRACE_CONCAT_(a, b)
+
+#if defined(PINWORLD_TRACE)
+	#define PW_TRACE_ZONE(name) pw::TraceZone PW_TRACE_CONCAT(pw_trace_zone_, __LINE__)(name)
+#else
+	#define PW_TRACE_ZONE(name) do { } while (0)
+#endif
+
+namespace pw {
+
+	// starts recording, with frames > 0 it stops and writes after that many frames, otherwise it records until traceStop
+	void traceStart(int frames = 0);
+
+	// writes the recorded zones to pinworld_trace_<date>.json
+	void traceStop();
+
+	bool traceRecording();
+
+	// called once per frame
+	void traceFrame();
+
+	// names the calling thread in the trace
+	void traceThreadName(std::string const& name);
+
+#if defined(PINWORLD_TRACE)
+	// the name is copied when the zone ends, it only has to outlive the zone
+	class TraceZone {
+	public:
+		explicit TraceZone(const char* name);
+		~TraceZone();
+	private:
+		const char* m_name;
+		int64_t m_start;
+	};
+#endif
+
+}
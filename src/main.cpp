@@ -1,4 +1,7 @@
 #include "PinWorld.hpp"
+#include "Text.hpp"
+#include "Noise.hpp"
+#include "MetaShader.hpp"
 
 pw::PinWorld pin_world;
 
@@ -9,8 +12,120 @@ pw::PinWorld pin_world;
     }
 #endif
 
-int main(void)
+static void printUsage() {
+    printf("usage: PinWorld [--headless [options]] [--mask <png>] [--sink <host[:port]>] [--canvas <spec>]... [--bench-noise] [--bench-combinators] [--check-math] [--check-compositions]\n");
+    printf("  --headless          runs without a window, as fast as possible\n");
+    printf("  --frames <n>        frames to run (60)\n");
+    printf("  --fps <f>           simulated frame rate (60)\n");
+    printf("  --shader <name>     shader to run (the default shader)\n");
+    printf("  --size <divisor>    canvas size divisor 1, 2, 4 or 8 (1 headless, 2 with a window)\n");
+    printf("  --seed <n>          random seed (0)\n");
+    printf("  --output <folder>   folder for the dumped frames\n");
+    printf("  --png               dump a height map png per frame\n");
+    printf("  --raw               dump the raw float32 pins per frame\n");
+    printf("  --mask <png>        only the pins under the bright pixels are evaluated and drawn\n");
+    printf("  --sink <host[:port]> sends the pins of every frame over UDP (port 7777)\n");
+    printf("  --canvas <spec>     adds a canvas, repeat for more, replaces --shader, --size, --mask and --sink\n");
+    printf("                      spec is shader=<name>,size=<divisor>,speed=<rate>,mask=<png>,sink=<host[:port]>, every key optional\n");
+    printf("  --bench-noise       logs the cost of the noise functions per octave and exits\n");
+    printf("  --bench-combinators compares hand-written and combinator shaders and exits\n");
+    printf("  --check-math        compares the fast math functions with the standard library and exits\n");
+    printf("  --check-compositions runs the compositions mixing a gif with other shaders and a negative multiply, checks their pins and exits\n");
+}
+
+// returns false when the arguments are invalid
+static bool parseArguments(int argc, char** argv, bool& headless, bool& bench_noise, bool& bench_combinators, bool& check_math, bool& check_compositions, pw::PinCanvasOptions& single, std::vector<pw::PinCanvasOptions>& canvases, pw::HeadlessOptions& options) {
+    headless = false;
+    bench_noise = false;
+    bench_combinators = false;
+    check_math = false;
+    check_compositions = false;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string argument = argv[i];
+        bool has_value = (i + 1) < argc;
+
+        if (argument == "--headless") headless = true;
+        else if (argument == "--bench-noise") bench_noise = true;
+        else if (argument == "--bench-combinators") bench_combinators = true;
+        else if (argument == "--check-math") check_math = true;
+        else if (argument == "--check-compositions") check_compositions = true;
+        else if (argument == "--png") options.png = true;
+        else if (argument == "--raw") options.raw = true;
+        else if (argument == "--frames" && has_value) options.frames = std::max(0, atoi(argv[++i]));
+        else if (argument == "--fps" && has_value) options.fps = std::max(1.0f, float(atof(argv[++i])));
+        else if (argument == "--shader" && has_value) single.shader = argv[++i];
+        else if (argument == "--size" && has_value) {
+            single.divisor = atoi(argv[++i]);
+            if (!pw::validCanvasDivisor(single.divisor))
+                return false;
+        }
+        else if (argument == "--seed" && has_value) options.seed = (unsigned int)strtoul(argv[++i], nullptr, 10);
+        else if (argument == "--output" && has_value) options.output = argv[++i];
+        else if (argument == "--mask" && has_value) single.mask = argv[++i];
+        else if (argument == "--sink" && has_value) single.sink = argv[++i];
+        else if (argument == "--canvas" && has_value) {
+            pw::PinCanvasOptions canvas;
+            if (!pw::parseCanvasOptions(argv[++i], canvas))
+                return false;
+            canvases.push_back(canvas);
+        }
+        else return false;
+    }
+
+    return true;
+}
+
+int main(int argc, char** argv)
 {
+    bool headless = false;
+    bool bench_noise = false;
+    bool bench_combinators = false;
+    bool check_math = false;
+    bool check_compositions = false;
+    pw::PinCanvasOptions single;
+    single.divisor = 0;
+    std::vector<pw::PinCanvasOptions> canvases;
+    pw::HeadlessOptions options;
+    if (!parseArguments(argc, argv, headless, bench_noise, bench_combinators, check_math, check_compositions, single, canvases, options)) {
+        printUsage();
+        return 1;
+    }
+
+    // the window starts at the menu default size
+    if (single.divisor == 0)
+        single.divisor = headless ? 1 : 2;
+
+    if (bench_noise) {
+        pw::benchmarkNoise();
+        return 0;
+    }
+
+    if (bench_combinators) {
+        pw::benchmarkCombinators();
+        return 0;
+    }
+
+    if (check_math)
+        return pw::checkFastMath() ? 0 : 1;
+
+    if (check_compositions)
+        return pw::checkCompositions() ? 0 : 1;
+
+    if (canvases.empty())
+        canvases.push_back(single);
+
+    for (auto const& canvas : canvases) {
+        if (!pin_world.addCanvas(canvas))
+            return 1;
+    }
+
+    if (headless) {
+        int result = pin_world.runHeadless(options);
+        pin_world.shutdown();
+        return result;
+    }
+
     pin_world.setup();
 
 #if defined(PLATFORM_WEB)
@@ -22,4 +137,4 @@ int main(void)
     pin_world.shutdown();  
 
     return 0;
-}
\ No newline at end of file
+}
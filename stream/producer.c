@@ -0,0 +1,95 @@
+//
+// Test producer for the PinWorld Stream shader
+// build it with the PinWorld project, or by hand:
+//     cc -O2 -I../src producer.c -o producer -lm -lrt
+// then pick the Stream shader in PinWorld.
+//
+//     producer [name] [width] [height] [u8|u16|f32] [fps] [frames]
+//
+// Writes two bumps orbiting the center until it is stopped, or for the given number of frames.
+//
+#include "PinWorldStream.h"
+
+#include <math.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+static volatile sig_atomic_t running = 1;
+
+static void stop(int signum) {
+    (void)signum;
+    running = 0;
+}
+
+static float bumps(float x, float y, float width, float height, float time) {
+    // normalized with correct aspect [-x, -1.0] -> [+x, 1.0]
+    float nx = (x - width * 0.5f) / (height * 0.5f);
+    float ny = (y - height * 0.5f) / (height * 0.5f);
+
+    float value = 0.0f;
+    for (int i = 0; i != 2; ++i) {
+        float angle = time * 0.8f + i * 3.14159265f;
+        float dx = nx - cosf(angle) * 0.6f;
+        float dy = ny - sinf(angle) * 0.6f;
+        value += expf(-(dx * dx + dy * dy) * 8.0f);
+    }
+    return value > 1.0f ? 1.0f : value;
+}
+
+static void writeFrame(void* pins, uint32_t width, uint32_t height, uint32_t format, float time) {
+    for (uint32_t y = 0; y != height; ++y) {
+        for (uint32_t x = 0; x != width; ++x) {
+            float value = bumps((float)x, (float)y, (float)width, (float)height, time);
+            size_t index = (size_t)y * width + x;
+
+            if (format == PINWORLD_STREAM_UINT8)
+                ((uint8_t*)pins)[index] = (uint8_t)(value * 255.0f + 0.5f);
+            else if (format == PINWORLD_STREAM_UINT16)
+                ((uint16_t*)pins)[index] = (uint16_t)(value * 65535.0f + 0.5f);
+            else
+                ((float*)pins)[index] = value;
+        }
+    }
+}
+
+int main(int argc, char** argv) {
+    const char* name = argc > 1 ? argv[1] : PINWORLD_STREAM_DEFAULT_NAME;
+    uint32_t width = argc > 2 ? (uint32_t)atoi(argv[2]) : 320;
+    uint32_t height = argc > 3 ? (uint32_t)atoi(argv[3]) : 240;
+    const char* format_name = argc > 4 ? argv[4] : "u8";
+    float fps = argc > 5 ? (float)atof(argv[5]) : 60.0f;
+    long frames = argc > 6 ? atol(argv[6]) : 0;
+
+    uint32_t format = PINWORLD_STREAM_UINT8;
+    if (format_name[0] == 'f')
+        format = PINWORLD_STREAM_FLOAT32;
+    else if (format_name[1] == '1')
+        format = PINWORLD_STREAM_UINT16;
+    if (fps <= 0.0f)
+        fps = 60.0f;
+
+    PinWorldStream stream;
+    if (pinworld_stream_create(&stream, name, width, height, format, 3) != 0) {
+        fprintf(stderr, "unable to create stream %s\n", name);
+        return 1;
+    }
+
+    signal(SIGINT, stop);
+    signal(SIGTERM, stop);
+    printf("streaming %ux%u %s pins to %s at %.0f fps\n", width, height, format_name, name, fps);
+
+    struct timespec pause;
+    pause.tv_sec = 0;
+    pause.tv_nsec = (long)(1e9f / fps);
+
+    for (long frame = 0; running && (frames == 0 || frame < frames); ++frame) {
+        writeFrame(pinworld_stream_begin(&stream), width, height, format, frame / fps);
+        pinworld_stream_commit(&stream);
+        nanosleep(&pause, NULL);
+    }
+
+    pinworld_stream_destroy(&stream);
+    return 0;
+}
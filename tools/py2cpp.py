@@ -0,0 +1,436 @@
+# py2cpp.py
+#
+# Ahead of time transpiler for python meta shaders.
+# Translates py/*.py scripts that only do scalar math over vec2 into native C++ batch kernels.
+# Scripts outside the supported subset are skipped and keep running on the pocketpy interpreter.
+#
+# usage: python3 py2cpp.py --output MetaShaderPyNative.cpp py/py_circle.py py/py_wipe.py ...
+import argparse
+import ast
+import os
+import re
+import sys
+
+CONTEXT_VARIABLES = ("c_size", "c_half_size", "c_time")
+PARAMETERS = ("pin_index", "pin_pos", "pin_value")
+
+# imported name -> (module, c++ expression template, arguments count)
+FUNCTIONS = {
+    "sin": ("math", "std::sin({0})", 1),
+    "cos": ("math", "std::cos({0})", 1),
+    "sqrt": ("math", "std::sqrt({0})", 1),
+    "fabs": ("math", "std::fabs({0})", 1),
+    "smoothstep": ("pinworld", "smoothstep({0}, {1}, {2})", 3),
+    "fract": ("pinworld", "fract({0})", 1),
+}
+
+BUILTINS = {
+    "abs": ("std::fabs({0})", 1),
+    "int": ("std::trunc({0})", 1),
+    "float": ("{0}", 1),
+}
+
+SCALAR = "scalar"
+VEC2 = "vec2"
+
+ATOM = re.compile(r"^-?[A-Za-z_0-9.]+f?$")
+IDENTIFIER = re.compile(r"[A-Za-z_][A-Za-z_0-9]*")
+
+
+class Unsupported(Exception):
+    pass
+
+
+def fnv1a(data):
+    value = 0xcbf29ce484222325
+    for byte in data:
+        value ^= byte
+        value = (value * 0x100000001b3) & 0xFFFFFFFFFFFFFFFF
+    return value
+
+
+def number(value):
+    text = repr(float(value))
+    if "e" not in text and "." not in text:
+        text += ".0"
+    return text + "f"
+
+
+class Value:
+    # a scalar holds one c++ expression, a vec2 holds two (x, y)
+    def __init__(self, kind, parts, uniform):
+        self.kind = kind
+        self.parts = parts
+        self.uniform = uniform
+
+    @property
+    def x(self):
+        return self.parts[0]
+
+    @property
+    def y(self):
+        return self.parts[1]
+
+
+class Transpiler:
+    def __init__(self, file, tree):
+        self.file = file
+        self.tree = tree
+        self.imports = {}
+        self.variables = {}
+        self.versions = {}
+        self.temporaries = 0
+        self.code = []  # (identifier, expression, uniform)
+
+    def fail(self, node, message):
+        line = getattr(node, "lineno", 0)
+        raise Unsupported(f"{self.file}:{line} {message}")
+
+    #
+    # module level
+    #
+    def run(self):
+        meta_shade = None
+        context = set()
+
+        for node in self.tree.body:
+            if isinstance(node, ast.ImportFrom):
+                for alias in node.names:
+                    self.imports[alias.asname or alias.name] = (node.module, alias.name)
+            elif isinstance(node, ast.Import):
+                continue
+            elif isinstance(node, ast.FunctionDef):
+                if node.name == "meta_shade":
+                    meta_shade = node
+            elif isinstance(node, ast.Assign):
+                for target in node.targets:
+                    if isinstance(target, ast.Name) and target.id in CONTEXT_VARIABLES:
+                        context.add(target.id)
+            elif isinstance(node, ast.Expr):
+                # module level calls only run once when the script is loaded
+                continue
+            else:
+                self.fail(node, "unsupported module statement")
+
+        if meta_shade is None:
+            raise Unsupported(f"{self.file} meta_shade not found")
+
+        for variable in CONTEXT_VARIABLES:
+            if variable not in context:
+                raise Unsupported(f"{self.file} {variable} not found")
+
+        return self.function(meta_shade)
+
+    def function(self, node):
+        arguments = [a.arg for a in node.args.args]
+        if tuple(arguments) != PARAMETERS or node.args.vararg or node.args.kwarg or node.decorator_list:
+            self.fail(node, "meta_shade must be meta_shade(pin_index, pin_pos, pin_value)")
+
+        self.variables["pin_index"] = Value(SCALAR, ["pin_index"], False)
+        self.variables["pin_pos"] = Value(VEC2, ["pin_pos_x", "pin_pos_y"], False)
+        self.variables["pin_value"] = Value(SCALAR, ["pin_value"], False)
+        self.variables["c_size"] = Value(VEC2, ["c_size_x", "c_size_y"], True)
+        self.variables["c_half_size"] = Value(VEC2, ["c_half_size_x", "c_half_size_y"], True)
+        self.variables["c_time"] = Value(SCALAR, ["c_time"], True)
+
+        body = list(node.body)
+        if body and isinstance(body[0], ast.Expr) and isinstance(body[0].value, ast.Constant):
+            body = body[1:]  # docstring
+
+        if not body or not isinstance(body[-1], ast.Return) or body[-1].value is None:
+            self.fail(node, "meta_shade must end with a return")
+
+        for statement in body[:-1]:
+            self.statement(statement)
+
+        result = self.expression(body[-1].value)
+        if result.kind != SCALAR:
+            self.fail(body[-1], "meta_shade must return a scalar")
+
+        return result
+
+    #
+    # statements
+    #
+    def statement(self, node):
+        if isinstance(node, ast.Pass):
+            return
+
+        if isinstance(node, ast.Assign):
+            if len(node.targets) != 1 or not isinstance(node.targets[0], ast.Name):
+                self.fail(node, "only simple assignments are supported")
+            self.assign(node.targets[0].id, self.expression(node.value))
+            return
+
+        if isinstance(node, ast.AugAssign):
+            if not isinstance(node.target, ast.Name):
+                self.fail(node, "only simple assignments are supported")
+            left = self.name(node.target)
+            self.assign(node.target.id, self.binary(node, node.op, left, self.expression(node.value)))
+            return
+
+        self.fail(node, f"unsupported statement {type(node).__name__}")
+
+    def assign(self, name, value):
+        if name in PARAMETERS or name in CONTEXT_VARIABLES:
+            self.fail(None, f"assignment to {name} is not supported")
+
+        # every assignment creates a new ssa version, so uniform values can be hoisted out of the pin loop
+        version = self.versions.get(name, 0)
+        self.versions[name] = version + 1
+        identifier = f"{name}_{version}"
+
+        if value.kind == SCALAR:
+            self.code.append((identifier, value.x, value.uniform))
+            self.variables[name] = Value(SCALAR, [identifier], value.uniform)
+        else:
+            self.code.append((f"{identifier}_x", value.x, value.uniform))
+            self.code.append((f"{identifier}_y", value.y, value.uniform))
+            self.variables[name] = Value(VEC2, [f"{identifier}_x", f"{identifier}_y"], value.uniform)
+
+    def hoist(self, value):
+        # uniform sub expressions used by per pin code are computed once per row
+        if not value.uniform:
+            return value
+
+        parts = []
+        for part in value.parts:
+            if ATOM.match(part):
+                parts.append(part)
+            else:
+                identifier = f"u_{self.temporaries}"
+                self.temporaries += 1
+                self.code.append((identifier, part, True))
+                parts.append(identifier)
+
+        return Value(value.kind, parts, True)
+
+    #
+    # expressions
+    #
+    def expression(self, node):
+        if isinstance(node, ast.Constant):
+            if isinstance(node.value, bool) or not isinstance(node.value, (int, float)):
+                self.fail(node, "only numeric constants are supported")
+            return Value(SCALAR, [number(node.value)], True)
+
+        if isinstance(node, ast.Name):
+            return self.name(node)
+
+        if isinstance(node, ast.UnaryOp):
+            operand = self.expression(node.operand)
+            if isinstance(node.op, ast.UAdd):
+                return operand
+            if isinstance(node.op, ast.USub):
+                return Value(operand.kind, [f"(-{p})" for p in operand.parts], operand.uniform)
+            self.fail(node, "unsupported unary operator")
+
+        if isinstance(node, ast.BinOp):
+            return self.binary(node, node.op, self.expression(node.left), self.expression(node.right))
+
+        if isinstance(node, ast.Attribute):
+            value = self.expression(node.value)
+            if value.kind != VEC2 or node.attr not in ("x", "y"):
+                self.fail(node, f"unsupported attribute {node.attr}")
+            return Value(SCALAR, [value.x if node.attr == "x" else value.y], value.uniform)
+
+        if isinstance(node, ast.Call):
+            return self.call(node)
+
+        self.fail(node, f"unsupported expression {type(node).__name__}")
+
+    def name(self, node):
+        if node.id in self.variables:
+            return self.variables[node.id]
+        self.fail(node, f"unknown name {node.id}")
+
+    def binary(self, node, op, left, right):
+        uniform = left.uniform and right.uniform
+        symbol = {ast.Add: "+", ast.Sub: "-", ast.Mult: "*", ast.Div: "/"}.get(type(op))
+        if symbol is None:
+            self.fail(node, "unsupported binary operator")
+
+        if not uniform:
+            left = self.hoist(left)
+            right = self.hoist(right)
+
+        if left.kind == SCALAR and right.kind == SCALAR:
+            return Value(SCALAR, [f"({left.x} {symbol} {right.x})"], uniform)
+
+        if left.kind == VEC2 and right.kind == VEC2 and symbol in ("+", "-"):
+            return Value(VEC2, [f"({left.x} {symbol} {right.x})", f"({left.y} {symbol} {right.y})"], uniform)
+
+        if left.kind == VEC2 and right.kind == SCALAR and symbol in ("*", "/"):
+            return Value(VEC2, [f"({left.x} {symbol} {right.x})", f"({left.y} {symbol} {right.x})"], uniform)
+
+        if left.kind == SCALAR and right.kind == VEC2 and symbol == "*":
+            return Value(VEC2, [f"({left.x} * {right.x})", f"({left.x} * {right.y})"], uniform)
+
+        self.fail(node, f"unsupported operation {left.kind} {symbol} {right.kind}")
+
+    def call(self, node):
+        if node.keywords:
+            self.fail(node, "keyword arguments are not supported")
+
+        # vec2 methods
+        if isinstance(node.func, ast.Attribute):
+            value = self.expression(node.func.value)
+            method = node.func.attr
+            if value.kind != VEC2:
+                self.fail(node, f"unsupported method {method}")
+
+            if method in ("length", "length_squared") and not node.args:
+                squared = f"({value.x} * {value.x} + {value.y} * {value.y})"
+                code = f"std::sqrt{squared}" if method == "length" else squared
+                return Value(SCALAR, [code], value.uniform)
+
+            if method == "dot" and len(node.args) == 1:
+                other = self.expression(node.args[0])
+                if other.kind != VEC2:
+                    self.fail(node, "dot expects a vec2")
+                if value.uniform != other.uniform:
+                    value, other = self.hoist(value), self.hoist(other)
+                return Value(SCALAR, [f"({value.x} * {other.x} + {value.y} * {other.y})"], value.uniform and other.uniform)
+
+            self.fail(node, f"unsupported method {method}")
+
+        if not isinstance(node.func, ast.Name):
+            self.fail(node, "unsupported call")
+
+        function = node.func.id
+        arguments = [self.expression(a) for a in node.args]
+        uniform = all(a.uniform for a in arguments)
+        if not uniform:
+            arguments = [self.hoist(a) for a in arguments]
+
+        if any(a.kind != SCALAR for a in arguments) and self.imports.get(function) != ("linalg", "vec2"):
+            self.fail(node, f"{function} expects scalar arguments")
+
+        if function in self.imports:
+            module, original = self.imports[function]
+
+            if (module, original) == ("linalg", "vec2"):
+                if len(arguments) != 2 or any(a.kind != SCALAR for a in arguments):
+                    self.fail(node, "vec2 expects 2 scalars")
+                return Value(VEC2, [arguments[0].x, arguments[1].x], uniform)
+
+            if original in FUNCTIONS and FUNCTIONS[original][0] == module:
+                _, template, count = FUNCTIONS[original]
+                if len(arguments) != count:
+                    self.fail(node, f"{function} expects {count} arguments")
+                return Value(SCALAR, [template.format(*[a.x for a in arguments])], uniform)
+
+            self.fail(node, f"unsupported function {module}.{original}")
+
+        if function in BUILTINS:
+            template, count = BUILTINS[function]
+            if len(arguments) != count:
+                self.fail(node, f"{function} expects {count} arguments")
+            return Value(SCALAR, [template.format(*[a.x for a in arguments])], uniform)
+
+        self.fail(node, f"unsupported function {function}")
+
+
+def kernel(name, transpiler, result):
+    # dead code elimination, walk back from the result keeping what is referenced
+    live = set(IDENTIFIER.findall(result.x))
+    code = []
+    for identifier, expression, uniform in reversed(transpiler.code):
+        if identifier in live:
+            live.update(IDENTIFIER.findall(expression))
+            code.insert(0, (identifier, expression, uniform))
+
+    inputs = [
+        ("c_size_x", "s.size.x"),
+        ("c_size_y", "s.size.y"),
+        ("c_half_size_x", "s.half_size.x"),
+        ("c_half_size_y", "s.half_size.y"),
+        ("c_time", "s.time"),
+        ("pin_pos_y", "float(y)"),
+    ]
+
+    # the row and the state are only named when the kernel reads them, unnamed they don't warn
+    reads_y = "pin_pos_y" in live or "pin_index" in live
+    reads_state = "pin_index" in live or any(identifier in live for identifier, _ in inputs if identifier != "pin_pos_y")
+    state = "PyNativeState const& s" if reads_state else "PyNativeState const&"
+    row_y = "int const y" if reads_y else "int const"
+
+    lines = []
+    lines.append(f"    static void {name}({state}, {row_y}, int const x_begin, int const x_end, float* const row) {{")
+    for identifier, expression in inputs:
+        if identifier in live:
+            lines.append(f"        const float {identifier} = {expression};")
+    if "pin_index" in live:
+        lines.append("        const int row_start = y * int(s.size.x);")
+    for identifier, expression, uniform in code:
+        if uniform:
+            lines.append(f"        const float {identifier} = {expression};")
+    lines.append("")
+    lines.append("        for (int x = x_begin; x != x_end; ++x) {")
+    if "pin_pos_x" in live:
+        lines.append("            const float pin_pos_x = float(x);")
+    if "pin_index" in live:
+        lines.append("            const float pin_index = float(row_start + x);")
+    if "pin_value" in live:
+        lines.append("            const float pin_value = row[x];")
+    for identifier, expression, uniform in code:
+        if not uniform:
+            lines.append(f"            const float {identifier} = {expression};")
+    lines.append(f"            row[x] = {result.x};")
+    lines.append("        }")
+    lines.append("    }")
+    return lines
+
+
+def main():
+    parser = argparse.ArgumentParser(description="python meta shader to c++ transpiler")
+    parser.add_argument("--output", required=True)
+    parser.add_argument("scripts", nargs="*")
+    options = parser.parse_args()
+
+    kernels = []
+    registry = []
+
+    for script in sorted(options.scripts):
+        file = os.path.basename(script)
+        name = os.path.splitext(file)[0]
+
+        with open(script, "rb") as stream:
+            data = stream.read()
+
+        try:
+            transpiler = Transpiler(file, ast.parse(data, file))
+            result = transpiler.run()
+        except (Unsupported, SyntaxError) as error:
+            print(f"py2cpp: {file} stays on the interpreter ({error})")
+            continue
+
+        function = "kernel_" + "".join(c if c.isalnum() else "_" for c in name)
+        kernels.append(f"    // {file}")
+        kernels.extend(kernel(function, transpiler, result))
+        kernels.append("")
+        registry.append(f"        shaders.push_back({{ \"{name}\", 0x{fnv1a(data):016X}ull, {function} }});")
+        print(f"py2cpp: {file} transpiled")
+
+    lines = []
+    lines.append("// generated by tools/py2cpp.py, do not edit")
+    lines.append("#include \"MetaShaderPyNative.hpp\"")
+    lines.append("")
+    lines.append("namespace pw {")
+    lines.extend(kernels)
+    lines.append("    void registerPyNativeShaders(std::vector<PyNativeShader>& shaders) {")
+    lines.extend(registry)
+    lines.append("    }")
+    lines.append("}")
+    lines.append("")
+    content = "\n".join(lines)
+
+    os.makedirs(os.path.dirname(os.path.abspath(options.output)), exist_ok=True)
+    with open(options.output, "w") as stream:
+        stream.write(content)
+
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())